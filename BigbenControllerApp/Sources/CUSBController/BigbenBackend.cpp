@@ -0,0 +1,80 @@
+// BigbenBackend.cpp - Per-model report parsers built from ProtocolTraits
+
+#include "BigbenBackend.h"
+#include "../../../Shared/ProtocolTraits.h"
+#include <string.h>
+
+namespace {
+
+struct BackendEntry {
+    uint16_t productID;
+    BigbenBackend backend;
+
+    template <class Traits>
+    static bool parseReport(const unsigned char* data, int length, BigbenInputReport* report)
+    {
+        if (length < (int)Traits::kMinReportSize || !Traits::accepts(data, (size_t)length)) {
+            return false;
+        }
+
+        if constexpr (Traits::kFormat == kProtocolFormatXInput) {
+            // Already the public layout; copy the input fields as they are
+            memcpy(report, data, Traits::kMinReportSize);
+        } else {
+            ProtocolPadState state;
+            Traits::parse(data, &state);
+
+            uint16_t buttons = ProtocolHatToDPadBits(state.hat);
+            buttons |= (state.buttons & kProtocolButtonStart) ? BTN_START : 0;
+            buttons |= (state.buttons & kProtocolButtonBack) ? BTN_BACK : 0;
+            buttons |= (state.buttons & kProtocolButtonLStick) ? BTN_LEFT_THUMB : 0;
+            buttons |= (state.buttons & kProtocolButtonRStick) ? BTN_RIGHT_THUMB : 0;
+            buttons |= (state.buttons & kProtocolButtonLB) ? BTN_LEFT_BUMPER : 0;
+            buttons |= (state.buttons & kProtocolButtonRB) ? BTN_RIGHT_BUMPER : 0;
+            buttons |= (state.buttons & kProtocolButtonHome) ? BTN_GUIDE : 0;
+            buttons |= (state.buttons & kProtocolButtonA) ? BTN_A : 0;
+            buttons |= (state.buttons & kProtocolButtonB) ? BTN_B : 0;
+            buttons |= (state.buttons & kProtocolButtonX) ? BTN_X : 0;
+            buttons |= (state.buttons & kProtocolButtonY) ? BTN_Y : 0;
+
+            report->report_id = 0x00;
+            report->report_size = sizeof(BigbenInputReport);
+            report->buttons = buttons;
+            report->left_trigger = state.leftTrigger;
+            report->right_trigger = state.rightTrigger;
+            report->left_stick_x = state.leftX;
+            report->left_stick_y = (int16_t)~state.leftY;      // XInput Y is positive up
+            report->right_stick_x = state.rightX;
+            report->right_stick_y = (int16_t)~state.rightY;
+        }
+        return true;
+    }
+
+    template <class Traits>
+    static const unsigned char* viewReport(const unsigned char* data, int length, unsigned char* scratch)
+    {
+        if constexpr (Traits::kFormat == kProtocolFormatXInput) {
+            if (length < (int)Traits::kMinReportSize || !Traits::accepts(data, (size_t)length)) {
+                return nullptr;
+            }
+            return data;
+        } else {
+            // The public report is packed, so any byte buffer can hold it
+            return parseReport<Traits>(data, length, (BigbenInputReport*)scratch) ? scratch : nullptr;
+        }
+    }
+
+    template <class Traits>
+    static constexpr BackendEntry forModel()
+    {
+        return { Traits::kProductID,
+                 { Traits::kProductID, Traits::kName, &parseReport<Traits>, &viewReport<Traits> } };
+    }
+};
+
+} // namespace
+
+extern "C" const BigbenBackend* bigben_backend_for_product(uint16_t product_id) {
+    const BackendEntry* entry = ProtocolSelect<BackendEntry>(product_id);
+    return entry ? &entry->backend : nullptr;
+}
@@ -0,0 +1,39 @@
+// BigbenBackend.h - Per-model report parsers for the C library (internal)
+//
+// Built in C++ from Shared/ProtocolTraits.h, one parser per model, and
+// looked up once when a device is opened. Every parser produces the XInput
+// shaped BigbenInputReport of the public API.
+
+#ifndef BIGBEN_BACKEND_H
+#define BIGBEN_BACKEND_H
+
+#include "include/BigbenUSB.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Returns false if the packet is not an input report of this model
+typedef bool (*BigbenReportParser)(const unsigned char* data, int length, BigbenInputReport* report);
+
+// Returns the packet itself if it is already in the public layout, otherwise
+// converts it into `scratch` (sizeof(BigbenInputReport) bytes) and returns
+// that; NULL if it is not an input report of this model
+typedef const unsigned char* (*BigbenReportViewer)(const unsigned char* data, int length,
+                                                   unsigned char* scratch);
+
+typedef struct {
+    uint16_t product_id;
+    const char* name;
+    BigbenReportParser parse;
+    BigbenReportViewer view;
+} BigbenBackend;
+
+// Backend for a Bigben product ID, or NULL if the model is not supported
+const BigbenBackend* bigben_backend_for_product(uint16_t product_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIGBEN_BACKEND_H
@@ -0,0 +1,138 @@
+// BigbenBorrow.c - Engine-owned packet buffers lent to the consumer
+
+#include "BigbenBorrow.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// The packet comes first, so a transfer's buffer pointer is its PoolBuffer
+typedef struct {
+    unsigned char packet[BIGBEN_POOL_PACKET_SIZE];
+    unsigned char scratch[sizeof(BigbenInputReport)];
+    const unsigned char* report;    // Into packet or scratch, set on publish
+    uint64_t timestamp;
+} PoolBuffer;
+
+struct BigbenBorrowPool {
+    PoolBuffer* buffers;
+    uint32_t count;
+
+    // One bit per buffer that is free; taken by transfers, set again on release
+    _Atomic uint64_t free_mask;
+
+    // Buffers queued for the consumer. Each buffer is queued at most once,
+    // so the ring can never hold more than `count` entries.
+    uint8_t ready[BIGBEN_POOL_MAX_BUFFERS];
+    _Atomic uint64_t head;          // Producer
+    uint64_t tail;                  // Consumer only
+
+    _Atomic bool notify_pending;
+    _Atomic uint64_t dropped;
+};
+
+BigbenBorrowPool* bigben_pool_create(uint32_t buffers) {
+    if (buffers == 0 || buffers > BIGBEN_POOL_MAX_BUFFERS) {
+        return NULL;
+    }
+
+    BigbenBorrowPool* pool = calloc(1, sizeof(BigbenBorrowPool));
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->buffers = calloc(buffers, sizeof(PoolBuffer));
+    if (!pool->buffers) {
+        free(pool);
+        return NULL;
+    }
+
+    pool->count = buffers;
+    atomic_init(&pool->free_mask, buffers == 64 ? ~0ull : (1ull << buffers) - 1);
+    atomic_init(&pool->head, 0);
+    atomic_init(&pool->notify_pending, false);
+    atomic_init(&pool->dropped, 0);
+    return pool;
+}
+
+void bigben_pool_destroy(BigbenBorrowPool* pool) {
+    if (!pool) return;
+    free(pool->buffers);
+    free(pool);
+}
+
+static uint32_t buffer_index(BigbenBorrowPool* pool, const unsigned char* buffer) {
+    return (uint32_t)((const PoolBuffer*)buffer - pool->buffers);
+}
+
+unsigned char* bigben_pool_take(BigbenBorrowPool* pool) {
+    uint64_t mask = atomic_load_explicit(&pool->free_mask, memory_order_acquire);
+    while (mask != 0) {
+        uint64_t bit = mask & (~mask + 1);
+        if (atomic_compare_exchange_weak_explicit(&pool->free_mask, &mask, mask & ~bit,
+                                                  memory_order_acq_rel, memory_order_acquire)) {
+            return pool->buffers[__builtin_ctzll(bit)].packet;
+        }
+    }
+    return NULL;
+}
+
+void bigben_pool_put_back(BigbenBorrowPool* pool, unsigned char* buffer) {
+    atomic_fetch_or_explicit(&pool->free_mask, 1ull << buffer_index(pool, buffer), memory_order_release);
+}
+
+unsigned char* bigben_pool_scratch(BigbenBorrowPool* pool, unsigned char* buffer) {
+    return pool->buffers[buffer_index(pool, buffer)].scratch;
+}
+
+bool bigben_pool_publish(BigbenBorrowPool* pool, unsigned char* buffer,
+                         const unsigned char* report, uint64_t timestamp) {
+    uint32_t index = buffer_index(pool, buffer);
+    pool->buffers[index].report = report;
+    pool->buffers[index].timestamp = timestamp;
+
+    uint64_t head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+    pool->ready[head % BIGBEN_POOL_MAX_BUFFERS] = (uint8_t)index;
+    atomic_store_explicit(&pool->head, head + 1, memory_order_release);
+
+    // Only the first publish after a borrow needs to wake the consumer
+    return !atomic_exchange_explicit(&pool->notify_pending, true, memory_order_acq_rel);
+}
+
+void bigben_pool_count_drop(BigbenBorrowPool* pool) {
+    atomic_fetch_add_explicit(&pool->dropped, 1, memory_order_relaxed);
+}
+
+size_t bigben_pool_borrow(BigbenBorrowPool* pool, BigbenReportView* views, size_t max) {
+    if (max == 0) {
+        return 0;
+    }
+
+    // Clear before reading head so a publish racing with this borrow still notifies
+    atomic_store_explicit(&pool->notify_pending, false, memory_order_seq_cst);
+
+    uint64_t head = atomic_load_explicit(&pool->head, memory_order_acquire);
+    size_t count = 0;
+    while (pool->tail != head && count < max) {
+        uint32_t index = pool->ready[pool->tail % BIGBEN_POOL_MAX_BUFFERS];
+        const PoolBuffer* buffer = &pool->buffers[index];
+        views[count].bytes = buffer->report;
+        views[count].timestamp = buffer->timestamp;
+        views[count].buffer = index;
+        count++;
+        pool->tail++;
+    }
+    return count;
+}
+
+void bigben_pool_release(BigbenBorrowPool* pool, const BigbenReportView* views, size_t count) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < count; i++) {
+        bits |= 1ull << views[i].buffer;
+    }
+    if (bits) {
+        atomic_fetch_or_explicit(&pool->free_mask, bits, memory_order_release);
+    }
+}
+
+uint64_t bigben_pool_dropped(BigbenBorrowPool* pool) {
+    return atomic_load_explicit(&pool->dropped, memory_order_relaxed);
+}
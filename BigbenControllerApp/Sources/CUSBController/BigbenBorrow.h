@@ -0,0 +1,53 @@
+// BigbenBorrow.h - Engine-owned packet buffers lent to the consumer (internal)
+//
+// Every buffer is in exactly one place: free, under a transfer, queued for
+// the consumer, or borrowed by it. The USB thread swaps a completed
+// transfer's buffer for a free one and queues the completed one; the
+// consumer reads reports in place and hands the buffers back. Nothing is
+// copied and neither side waits for the other.
+
+#ifndef BIGBEN_BORROW_H
+#define BIGBEN_BORROW_H
+
+#include "include/BigbenUSB.h"
+
+#define BIGBEN_POOL_PACKET_SIZE 64
+#define BIGBEN_POOL_MAX_BUFFERS 64
+
+typedef struct BigbenBorrowPool BigbenBorrowPool;
+
+// Create a pool of `buffers` packet buffers (1-BIGBEN_POOL_MAX_BUFFERS)
+// Returns NULL on failure
+BigbenBorrowPool* bigben_pool_create(uint32_t buffers);
+
+// Destroy a pool; no buffer may be under a transfer or borrowed
+void bigben_pool_destroy(BigbenBorrowPool* pool);
+
+// Take a free buffer of BIGBEN_POOL_PACKET_SIZE bytes, or NULL if every
+// buffer is in use. Any thread.
+unsigned char* bigben_pool_take(BigbenBorrowPool* pool);
+
+// Return a buffer that is not carrying a report, e.g. from a retired transfer
+void bigben_pool_put_back(BigbenBorrowPool* pool, unsigned char* buffer);
+
+// Conversion area that belongs to `buffer`, for models whose packets are not
+// already in the public report layout
+unsigned char* bigben_pool_scratch(BigbenBorrowPool* pool, unsigned char* buffer);
+
+// Producer: queue `buffer` for the consumer; `report` points into it or its
+// scratch area. Returns true if the consumer should be notified.
+bool bigben_pool_publish(BigbenBorrowPool* pool, unsigned char* buffer,
+                         const unsigned char* report, uint64_t timestamp);
+
+// Producer: a report was lost because no free buffer was left
+void bigben_pool_count_drop(BigbenBorrowPool* pool);
+
+// Consumer: lend up to `max` queued reports, oldest first
+size_t bigben_pool_borrow(BigbenBorrowPool* pool, BigbenReportView* views, size_t max);
+
+// Consumer: give borrowed reports back; the views are invalid afterwards
+void bigben_pool_release(BigbenBorrowPool* pool, const BigbenReportView* views, size_t count);
+
+uint64_t bigben_pool_dropped(BigbenBorrowPool* pool);
+
+#endif // BIGBEN_BORROW_H
@@ -0,0 +1,105 @@
+// BigbenDelta.c - Lock-free mouse delta hand-off between threads
+
+#include "include/BigbenUSB.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// Deltas are 24.8 fixed point; x and y share one 64-bit word so a take
+// always sees a consistent pair
+#define DELTA_FRACTION_BITS 8
+#define DELTA_SCALE ((double)(1 << DELTA_FRACTION_BITS))
+
+struct BigbenMouseDelta {
+    _Atomic uint64_t packed;        // x in the high half, y in the low half
+    _Atomic uint64_t timestamp;     // Oldest report behind the pending delta
+    _Atomic uint32_t buttons;       // Mouse buttons held, for drag events
+};
+
+static inline uint64_t pack_delta(int32_t x, int32_t y) {
+    return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+}
+
+static inline void unpack_delta(uint64_t packed, int32_t* x, int32_t* y) {
+    *x = (int32_t)(uint32_t)(packed >> 32);
+    *y = (int32_t)(uint32_t)packed;
+}
+
+static inline int32_t to_fixed(double value) {
+    double scaled = round(value * DELTA_SCALE);
+    if (scaled > INT32_MAX / 2) return INT32_MAX / 2;
+    if (scaled < INT32_MIN / 2) return INT32_MIN / 2;
+    return (int32_t)scaled;
+}
+
+BigbenMouseDelta* bigben_delta_create(void) {
+    return calloc(1, sizeof(BigbenMouseDelta));
+}
+
+void bigben_delta_destroy(BigbenMouseDelta* delta) {
+    free(delta);
+}
+
+void bigben_delta_add(BigbenMouseDelta* delta, double dx, double dy, uint64_t timestamp) {
+    if (!delta) return;
+
+    int32_t add_x = to_fixed(dx);
+    int32_t add_y = to_fixed(dy);
+    if (add_x == 0 && add_y == 0) {
+        return;
+    }
+
+    uint64_t old = atomic_load_explicit(&delta->packed, memory_order_relaxed);
+    uint64_t next;
+    do {
+        int32_t x, y;
+        unpack_delta(old, &x, &y);
+        // Saturate rather than wrap if the consumer stalls
+        int64_t sum_x = (int64_t)x + add_x;
+        int64_t sum_y = (int64_t)y + add_y;
+        if (sum_x > INT32_MAX / 2) sum_x = INT32_MAX / 2;
+        if (sum_x < INT32_MIN / 2) sum_x = INT32_MIN / 2;
+        if (sum_y > INT32_MAX / 2) sum_y = INT32_MAX / 2;
+        if (sum_y < INT32_MIN / 2) sum_y = INT32_MIN / 2;
+        next = pack_delta((int32_t)sum_x, (int32_t)sum_y);
+    } while (!atomic_compare_exchange_weak_explicit(&delta->packed, &old, next,
+                                                    memory_order_release, memory_order_relaxed));
+
+    // Keep the first timestamp since the last take. Starting a new delta
+    // re-arms it outright, so a timestamp left over from a take that raced
+    // an add never outlives that delta.
+    if (old == 0) {
+        atomic_store_explicit(&delta->timestamp, timestamp, memory_order_relaxed);
+    } else {
+        uint64_t none = 0;
+        atomic_compare_exchange_strong_explicit(&delta->timestamp, &none, timestamp,
+                                                memory_order_relaxed, memory_order_relaxed);
+    }
+}
+
+bool bigben_delta_take(BigbenMouseDelta* delta, double* dx, double* dy, uint64_t* timestamp) {
+    if (!delta) return false;
+
+    // Timestamp first: an add landing in between is taken with this delta
+    // and leaves only its timestamp behind, which the next add re-arms
+    uint64_t first = atomic_exchange_explicit(&delta->timestamp, 0, memory_order_relaxed);
+    uint64_t packed = atomic_exchange_explicit(&delta->packed, 0, memory_order_acquire);
+
+    int32_t x, y;
+    unpack_delta(packed, &x, &y);
+    if (dx) *dx = x / DELTA_SCALE;
+    if (dy) *dy = y / DELTA_SCALE;
+    if (timestamp) *timestamp = first;
+
+    return packed != 0;
+}
+
+void bigben_delta_set_buttons(BigbenMouseDelta* delta, uint32_t buttons) {
+    if (!delta) return;
+    atomic_store_explicit(&delta->buttons, buttons, memory_order_relaxed);
+}
+
+uint32_t bigben_delta_buttons(BigbenMouseDelta* delta) {
+    if (!delta) return 0;
+    return atomic_load_explicit(&delta->buttons, memory_order_relaxed);
+}
@@ -0,0 +1,77 @@
+// BigbenLatency.c - Per-stage latency histograms for the mapper pipeline
+
+#include "include/BigbenUSB.h"
+#include "../../../Shared/LatencyHistogram.h"
+#include <mach/mach_time.h>
+#include <stdatomic.h>
+
+static BigbenLatencyHistogram stage_histograms[BIGBEN_STAGE_COUNT];
+static atomic_bool stats_enabled = false;
+static mach_timebase_info_data_t timebase = { 0, 0 };
+
+static const char* stage_names[BIGBEN_STAGE_COUNT] = {
+    "parse",
+    "enqueue",
+    "drain",
+    "translate",
+    "process",
+    "post"
+};
+
+void bigben_latency_enable(bool enabled) {
+    if (enabled && timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    atomic_store_explicit(&stats_enabled, enabled, memory_order_release);
+}
+
+bool bigben_latency_enabled(void) {
+    return atomic_load_explicit(&stats_enabled, memory_order_acquire);
+}
+
+uint64_t bigben_timestamp(void) {
+    return mach_absolute_time();
+}
+
+uint64_t bigben_ticks_to_ns(uint64_t ticks) {
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    return ticks * timebase.numer / timebase.denom;
+}
+
+void bigben_latency_record(BigbenLatencyStage stage, uint64_t since) {
+    if (!bigben_latency_enabled() || stage >= BIGBEN_STAGE_COUNT || since == 0) {
+        return;
+    }
+
+    uint64_t now = mach_absolute_time();
+    uint64_t ticks = now > since ? now - since : 0;
+    BigbenLatencyRecord(&stage_histograms[stage], ticks * timebase.numer / timebase.denom);
+}
+
+void bigben_latency_summary(BigbenLatencyStage stage, BigbenLatencyStats* stats) {
+    if (!stats) return;
+
+    BigbenLatencySummary summary = { 0, 0, 0, 0, 0, 0 };
+    if (stage < BIGBEN_STAGE_COUNT) {
+        BigbenLatencySummarize(&stage_histograms[stage], &summary);
+    }
+
+    stats->count = summary.count;
+    stats->mean_ns = summary.meanNs;
+    stats->p50_ns = summary.p50Ns;
+    stats->p99_ns = summary.p99Ns;
+    stats->p999_ns = summary.p999Ns;
+    stats->max_ns = summary.maxNs;
+}
+
+void bigben_latency_reset(void) {
+    for (int i = 0; i < BIGBEN_STAGE_COUNT; i++) {
+        BigbenLatencyReset(&stage_histograms[i]);
+    }
+}
+
+const char* bigben_latency_stage_name(BigbenLatencyStage stage) {
+    return stage < BIGBEN_STAGE_COUNT ? stage_names[stage] : "unknown";
+}
@@ -0,0 +1,53 @@
+// BigbenPublish.c - Lock-free publication of immutable objects to one reader
+//
+// A single-reader hazard pointer: the reader stores the object it is about
+// to use in `in_use` and checks it is still current, so a writer that
+// swapped it out either sees the mark and keeps the object alive, or the
+// reader sees the swap and moves on to the new one.
+
+#include "include/BigbenUSB.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+
+struct BigbenPublished {
+    _Atomic(const void*) current;   // Newest object
+    _Atomic(const void*) in_use;    // Object the reader holds, NULL before the first acquire
+};
+
+BigbenPublished* bigben_published_create(void) {
+    return calloc(1, sizeof(BigbenPublished));
+}
+
+void bigben_published_destroy(BigbenPublished* published) {
+    free(published);
+}
+
+const void* bigben_published_swap(BigbenPublished* published, const void* object) {
+    if (!published) return NULL;
+    return atomic_exchange_explicit(&published->current, object, memory_order_seq_cst);
+}
+
+const void* bigben_published_acquire(BigbenPublished* published) {
+    if (!published) return NULL;
+
+    const void* current = atomic_load_explicit(&published->current, memory_order_acquire);
+
+    // Still holding the current one: it was protected when it was taken
+    if (current == atomic_load_explicit(&published->in_use, memory_order_relaxed)) {
+        return current;
+    }
+
+    for (;;) {
+        atomic_store_explicit(&published->in_use, current, memory_order_seq_cst);
+        const void* check = atomic_load_explicit(&published->current, memory_order_seq_cst);
+        if (check == current) {
+            return current;
+        }
+        current = check;
+    }
+}
+
+bool bigben_published_in_use(BigbenPublished* published, const void* object) {
+    if (!published) return false;
+    return atomic_load_explicit(&published->in_use, memory_order_seq_cst) == object;
+}
@@ -0,0 +1,329 @@
+// BigbenRecord.c - Input session recording and deterministic replay
+
+#include "include/BigbenUSB.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <mach/mach_time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Frames per half of the double buffer (32 KB each); a full half is handed
+// to the writer thread while the reader thread fills the other one
+#define RECORD_BUFFER_FRAMES 1024
+
+_Static_assert(sizeof(BigbenRecordHeader) == 32, "record header layout");
+_Static_assert(sizeof(BigbenRecordFrame) == BIGBEN_RECORD_FRAME_SIZE, "record frame layout");
+
+// MARK: - Recording
+
+typedef struct {
+    BigbenRecordFrame frames[RECORD_BUFFER_FRAMES];
+    size_t count;
+    atomic_bool pending;            // Full and waiting for the writer
+} RecordBuffer;
+
+struct BigbenRecorder {
+    FILE* file;
+    BigbenRecordHeader header;
+
+    RecordBuffer buffers[2];
+    int active;                     // Buffer the producer fills
+
+    atomic_uint_fast64_t frames_written;
+    atomic_uint_fast64_t frames_dropped;
+
+    pthread_t writer;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool stopping;
+    bool write_failed;
+};
+
+static void write_buffer(BigbenRecorder* recorder, RecordBuffer* buffer) {
+    if (buffer->count > 0 && !recorder->write_failed) {
+        size_t written = fwrite(buffer->frames, sizeof(BigbenRecordFrame), buffer->count, recorder->file);
+        if (written != buffer->count) {
+            fprintf(stderr, "bigben_recorder: write failed: %s\n", strerror(errno));
+            recorder->write_failed = true;
+        }
+        atomic_fetch_add_explicit(&recorder->frames_written, written, memory_order_relaxed);
+    }
+    buffer->count = 0;
+    atomic_store_explicit(&buffer->pending, false, memory_order_release);
+}
+
+static void* writer_thread_func(void* arg) {
+    BigbenRecorder* recorder = (BigbenRecorder*)arg;
+
+    pthread_mutex_lock(&recorder->lock);
+    for (;;) {
+        bool any = false;
+        for (int i = 0; i < 2; i++) {
+            RecordBuffer* buffer = &recorder->buffers[i];
+            if (atomic_load_explicit(&buffer->pending, memory_order_acquire)) {
+                pthread_mutex_unlock(&recorder->lock);
+                write_buffer(recorder, buffer);
+                pthread_mutex_lock(&recorder->lock);
+                any = true;
+            }
+        }
+        if (any) {
+            continue;
+        }
+        if (recorder->stopping) {
+            break;
+        }
+        pthread_cond_wait(&recorder->cond, &recorder->lock);
+    }
+    pthread_mutex_unlock(&recorder->lock);
+
+    return NULL;
+}
+
+static bool write_header(BigbenRecorder* recorder) {
+    return fseek(recorder->file, 0, SEEK_SET) == 0 &&
+           fwrite(&recorder->header, sizeof(recorder->header), 1, recorder->file) == 1;
+}
+
+BigbenRecorder* bigben_recorder_create(const char* path) {
+    if (!path) return NULL;
+
+    BigbenRecorder* recorder = calloc(1, sizeof(BigbenRecorder));
+    if (!recorder) return NULL;
+
+    recorder->file = fopen(path, "wb");
+    if (!recorder->file) {
+        fprintf(stderr, "bigben_recorder_create: %s: %s\n", path, strerror(errno));
+        free(recorder);
+        return NULL;
+    }
+
+    recorder->header.magic = BIGBEN_RECORD_MAGIC;
+    recorder->header.version = BIGBEN_RECORD_VERSION;
+    recorder->header.frame_size = BIGBEN_RECORD_FRAME_SIZE;
+
+    // Written again with the final frame count on close
+    if (!write_header(recorder)) {
+        fprintf(stderr, "bigben_recorder_create: %s: header write failed\n", path);
+        fclose(recorder->file);
+        free(recorder);
+        return NULL;
+    }
+
+    pthread_mutex_init(&recorder->lock, NULL);
+    pthread_cond_init(&recorder->cond, NULL);
+    if (pthread_create(&recorder->writer, NULL, writer_thread_func, recorder) != 0) {
+        fprintf(stderr, "bigben_recorder_create: failed to start writer thread\n");
+        pthread_cond_destroy(&recorder->cond);
+        pthread_mutex_destroy(&recorder->lock);
+        fclose(recorder->file);
+        free(recorder);
+        return NULL;
+    }
+
+    return recorder;
+}
+
+void bigben_recorder_set_device(BigbenRecorder* recorder, uint16_t vendor_id, uint16_t product_id) {
+    if (!recorder) return;
+    recorder->header.vendor_id = vendor_id;
+    recorder->header.product_id = product_id;
+}
+
+bool bigben_recorder_write(BigbenRecorder* recorder, const BigbenInputReport* report, uint64_t timestamp) {
+    if (!recorder || !report) return false;
+
+    RecordBuffer* buffer = &recorder->buffers[recorder->active];
+    if (atomic_load_explicit(&buffer->pending, memory_order_acquire)) {
+        // The writer is behind on both halves; never wait for it
+        atomic_fetch_add_explicit(&recorder->frames_dropped, 1, memory_order_relaxed);
+        return false;
+    }
+
+    uint64_t ns = bigben_ticks_to_ns(timestamp);
+    if (recorder->header.start_ns == 0) {
+        recorder->header.start_ns = ns;
+    }
+
+    BigbenRecordFrame* frame = &buffer->frames[buffer->count++];
+    frame->timestamp_ns = ns;
+    frame->report = *report;
+    memset(frame->reserved, 0, sizeof(frame->reserved));
+
+    if (buffer->count == RECORD_BUFFER_FRAMES) {
+        atomic_store_explicit(&buffer->pending, true, memory_order_release);
+        recorder->active ^= 1;
+
+        // Once per buffer, not per report
+        pthread_mutex_lock(&recorder->lock);
+        pthread_cond_signal(&recorder->cond);
+        pthread_mutex_unlock(&recorder->lock);
+    }
+    return true;
+}
+
+uint64_t bigben_recorder_frames(BigbenRecorder* recorder) {
+    if (!recorder) return 0;
+    return atomic_load_explicit(&recorder->frames_written, memory_order_relaxed);
+}
+
+uint64_t bigben_recorder_dropped(BigbenRecorder* recorder) {
+    if (!recorder) return 0;
+    return atomic_load_explicit(&recorder->frames_dropped, memory_order_relaxed);
+}
+
+int bigben_recorder_close(BigbenRecorder* recorder, uint64_t* frames) {
+    if (!recorder) return -1;
+
+    // The partially filled half goes out last
+    RecordBuffer* tail = &recorder->buffers[recorder->active];
+    if (tail->count > 0) {
+        atomic_store_explicit(&tail->pending, true, memory_order_release);
+    }
+
+    pthread_mutex_lock(&recorder->lock);
+    recorder->stopping = true;
+    pthread_cond_signal(&recorder->cond);
+    pthread_mutex_unlock(&recorder->lock);
+    pthread_join(recorder->writer, NULL);
+
+    recorder->header.frame_count = atomic_load_explicit(&recorder->frames_written, memory_order_relaxed);
+    if (frames) {
+        *frames = recorder->header.frame_count;
+    }
+    int result = (!recorder->write_failed && write_header(recorder)) ? 0 : -1;
+    if (fclose(recorder->file) != 0) {
+        result = -1;
+    }
+
+    pthread_cond_destroy(&recorder->cond);
+    pthread_mutex_destroy(&recorder->lock);
+    free(recorder);
+    return result;
+}
+
+// MARK: - Replay
+
+struct BigbenReplay {
+    const uint8_t* map;
+    size_t map_size;
+    const BigbenRecordHeader* header;
+    const BigbenRecordFrame* frames;
+    size_t frame_count;
+    atomic_bool cancelled;
+};
+
+BigbenReplay* bigben_replay_open(const char* path) {
+    if (!path) return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "bigben_replay_open: %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(BigbenRecordHeader)) {
+        fprintf(stderr, "bigben_replay_open: %s: not a recording\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "bigben_replay_open: %s: mmap failed: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    const BigbenRecordHeader* header = (const BigbenRecordHeader*)map;
+    if (header->magic != BIGBEN_RECORD_MAGIC || header->version != BIGBEN_RECORD_VERSION ||
+        header->frame_size != BIGBEN_RECORD_FRAME_SIZE) {
+        fprintf(stderr, "bigben_replay_open: %s: unsupported recording (magic 0x%08x, version %u)\n",
+                path, header->magic, header->version);
+        munmap(map, (size_t)st.st_size);
+        return NULL;
+    }
+
+    BigbenReplay* replay = calloc(1, sizeof(BigbenReplay));
+    if (!replay) {
+        munmap(map, (size_t)st.st_size);
+        return NULL;
+    }
+
+    replay->map = map;
+    replay->map_size = (size_t)st.st_size;
+    replay->header = header;
+    replay->frames = (const BigbenRecordFrame*)(replay->map + sizeof(BigbenRecordHeader));
+
+    // Trust the file size over the header, so a recording that was never
+    // closed still replays up to its last complete frame
+    replay->frame_count = (replay->map_size - sizeof(BigbenRecordHeader)) / sizeof(BigbenRecordFrame);
+    return replay;
+}
+
+void bigben_replay_close(BigbenReplay* replay) {
+    if (!replay) return;
+    munmap((void*)replay->map, replay->map_size);
+    free(replay);
+}
+
+const BigbenRecordHeader* bigben_replay_header(BigbenReplay* replay) {
+    return replay ? replay->header : NULL;
+}
+
+const BigbenRecordFrame* bigben_replay_frames(BigbenReplay* replay) {
+    return replay ? replay->frames : NULL;
+}
+
+size_t bigben_replay_frame_count(BigbenReplay* replay) {
+    return replay ? replay->frame_count : 0;
+}
+
+void bigben_replay_cancel(BigbenReplay* replay) {
+    if (!replay) return;
+    atomic_store_explicit(&replay->cancelled, true, memory_order_relaxed);
+}
+
+size_t bigben_replay_run(BigbenReplay* replay, BigbenReplayPacing pacing,
+                         BigbenReplayCallback callback, void* context, uint64_t* elapsed_ns) {
+    if (!replay || !callback) return 0;
+
+    atomic_store_explicit(&replay->cancelled, false, memory_order_relaxed);
+
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+
+    uint64_t start = mach_absolute_time();
+    uint64_t first_ns = replay->frame_count > 0 ? replay->frames[0].timestamp_ns : 0;
+    size_t delivered = 0;
+
+    for (size_t i = 0; i < replay->frame_count; i++) {
+        if (atomic_load_explicit(&replay->cancelled, memory_order_relaxed)) {
+            break;
+        }
+
+        const BigbenRecordFrame* frame = &replay->frames[i];
+        if (pacing == BIGBEN_REPLAY_ORIGINAL_TIMING && frame->timestamp_ns > first_ns) {
+            uint64_t offset_ns = frame->timestamp_ns - first_ns;
+            mach_wait_until(start + offset_ns * timebase.denom / timebase.numer);
+        }
+
+        // Replayed reports are stamped as completing now, so the latency
+        // stages measure this run rather than the recording
+        BigbenInputReport report = frame->report;
+        callback(&report, mach_absolute_time(), context);
+        delivered++;
+    }
+
+    if (elapsed_ns) {
+        *elapsed_ns = bigben_ticks_to_ns(mach_absolute_time() - start);
+    }
+    return delivered;
+}
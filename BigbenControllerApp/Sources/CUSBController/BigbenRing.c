@@ -0,0 +1,143 @@
+// BigbenRing.c - Single-producer/single-consumer report ring
+
+#include "BigbenRing.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RING_MAX_CAPACITY 4096
+
+typedef struct {
+    // 2*i+1 while write i is in progress, 2*i+2 once it is complete
+    _Atomic uint64_t seq;
+    uint64_t timestamp;
+    BigbenInputReport report;
+} RingSlot;
+
+struct BigbenRing {
+    RingSlot* slots;
+    uint32_t mask;
+    BigbenOverflowPolicy policy;
+
+    // Producer side: index of the next write
+    _Atomic uint64_t head;
+    // Consumer side: index of the next read (consumer only)
+    uint64_t tail;
+
+    // Set by the producer when it asks for a wakeup, cleared by the consumer
+    _Atomic bool notify_pending;
+    _Atomic uint64_t dropped;
+};
+
+BigbenRing* bigben_ring_create(uint32_t capacity, BigbenOverflowPolicy policy) {
+    if (capacity == 0 || capacity > RING_MAX_CAPACITY) {
+        return NULL;
+    }
+
+    uint32_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    BigbenRing* ring = calloc(1, sizeof(BigbenRing));
+    if (!ring) {
+        return NULL;
+    }
+
+    ring->slots = calloc(size, sizeof(RingSlot));
+    if (!ring->slots) {
+        free(ring);
+        return NULL;
+    }
+
+    ring->mask = size - 1;
+    ring->policy = policy;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->notify_pending, false);
+    atomic_init(&ring->dropped, 0);
+    for (uint32_t i = 0; i < size; i++) {
+        atomic_init(&ring->slots[i].seq, 0);
+    }
+
+    return ring;
+}
+
+void bigben_ring_destroy(BigbenRing* ring) {
+    if (!ring) return;
+    free(ring->slots);
+    free(ring);
+}
+
+bool bigben_ring_push(BigbenRing* ring, const BigbenInputReport* report, uint64_t timestamp) {
+    uint64_t i = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    RingSlot* slot = &ring->slots[i & ring->mask];
+
+    // Seqlock write: odd sequence, payload, even sequence
+    atomic_store_explicit(&slot->seq, 2 * i + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->timestamp = timestamp;
+    memcpy(&slot->report, report, sizeof(BigbenInputReport));
+    atomic_store_explicit(&slot->seq, 2 * i + 2, memory_order_release);
+
+    atomic_store_explicit(&ring->head, i + 1, memory_order_release);
+
+    // Only the first push after a drain needs to wake the consumer
+    return !atomic_exchange_explicit(&ring->notify_pending, true, memory_order_acq_rel);
+}
+
+size_t bigben_ring_drain(BigbenRing* ring, BigbenInputReport* out, uint64_t* timestamps, size_t max) {
+    if (max == 0) {
+        return 0;
+    }
+
+    // Clear before reading head so a push racing with this drain still notifies
+    atomic_store_explicit(&ring->notify_pending, false, memory_order_seq_cst);
+
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint64_t tail = ring->tail;
+    uint64_t capacity = (uint64_t)ring->mask + 1;
+    uint64_t skipped = 0;
+
+    // Everything older than the ring (or than the newest report) is gone
+    uint64_t keep = (ring->policy == BIGBEN_OVERFLOW_KEEP_LATEST) ? 1 : capacity;
+    if (head - tail > keep) {
+        skipped += head - keep - tail;
+        tail = head - keep;
+    }
+
+    size_t count = 0;
+    while (tail != head && count < max) {
+        RingSlot* slot = &ring->slots[tail & ring->mask];
+        uint64_t expected = 2 * tail + 2;
+
+        uint64_t s1 = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (s1 == expected) {
+            memcpy(&out[count], &slot->report, sizeof(BigbenInputReport));
+            uint64_t timestamp = slot->timestamp;
+            atomic_thread_fence(memory_order_acquire);
+            uint64_t s2 = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+            if (s2 == expected) {
+                if (timestamps) {
+                    timestamps[count] = timestamp;
+                }
+                count++;
+            } else {
+                skipped++;  // Overwritten while copying
+            }
+        } else {
+            skipped++;      // Producer lapped us on this slot
+        }
+        tail++;
+    }
+
+    ring->tail = tail;
+    if (skipped) {
+        atomic_fetch_add_explicit(&ring->dropped, skipped, memory_order_relaxed);
+    }
+
+    return count;
+}
+
+uint64_t bigben_ring_dropped(BigbenRing* ring) {
+    return atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+}
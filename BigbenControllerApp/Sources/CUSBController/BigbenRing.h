@@ -0,0 +1,35 @@
+// BigbenRing.h - Single-producer/single-consumer report ring (internal)
+//
+// The producer is the libusb event thread, the consumer is whichever queue
+// drains the controller. Neither side ever blocks or retries: the producer
+// always overwrites the oldest slot, and the consumer uses a per-slot
+// sequence number to detect reports that were overwritten under it.
+
+#ifndef BIGBEN_RING_H
+#define BIGBEN_RING_H
+
+#include "include/BigbenUSB.h"
+#include <stddef.h>
+
+typedef struct BigbenRing BigbenRing;
+
+// Create a ring holding at least `capacity` reports (rounded up to a power of two)
+// Returns NULL on failure
+BigbenRing* bigben_ring_create(uint32_t capacity, BigbenOverflowPolicy policy);
+
+// Destroy a ring; neither side may be using it
+void bigben_ring_destroy(BigbenRing* ring);
+
+// Producer: publish one report with its completion timestamp
+// Returns true if the consumer has drained since the last wakeup and should be notified
+bool bigben_ring_push(BigbenRing* ring, const BigbenInputReport* report, uint64_t timestamp);
+
+// Consumer: copy up to `max` reports, oldest first, into `out`
+// `timestamps` may be NULL; otherwise it receives `max` entries as well
+// Returns the number of reports copied
+size_t bigben_ring_drain(BigbenRing* ring, BigbenInputReport* out, uint64_t* timestamps, size_t max);
+
+// Number of reports overwritten or skipped before the consumer saw them
+uint64_t bigben_ring_dropped(BigbenRing* ring);
+
+#endif // BIGBEN_RING_H
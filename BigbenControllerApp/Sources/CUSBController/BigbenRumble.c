@@ -0,0 +1,377 @@
+// BigbenRumble.c - Rumble effect compilation and playback
+
+#include "BigbenRumble.h"
+#include <mach/mach_time.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RUMBLE_WRITE_TIMEOUT_MS 100
+#define RUMBLE_MAX_TICKS (BIGBEN_RUMBLE_MAX_DURATION_MS / BIGBEN_RUMBLE_TICK_MS)
+
+// Motor levels packed as weak | strong << 8
+#define RUMBLE_LEVELS(weak, strong) ((uint16_t)((weak) | ((strong) << 8)))
+
+typedef struct {
+    uint16_t* levels;               // One entry per tick, NULL if the slot is free
+    uint32_t tick_count;
+} CompiledEffect;
+
+struct BigbenRumbleEngine {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;            // Wakes the thread for a new command, and detach for a finished write
+    pthread_t thread;
+    bool thread_started;
+    bool stopping;
+
+    libusb_device_handle* handle;   // NULL while detached
+    unsigned char endpoint;
+    bool writing;                   // A write is in flight outside the lock
+
+    CompiledEffect effects[BIGBEN_RUMBLE_MAX_EFFECTS];
+
+    // Playback state; `playing` is an effect ID or -1 for the manual levels
+    int playing;
+    uint32_t loops_left;            // 0 = until stopped
+    uint64_t play_start;            // mach time of tick 0 of the current loop
+    uint16_t manual;
+
+    uint16_t sent;                  // Levels the device was last given
+    bool sent_valid;
+    bool dirty;                     // A command arrived that has not been written yet
+    uint64_t last_write;            // mach time, for the one-write-per-tick bound
+    uint64_t tick_ticks;            // BIGBEN_RUMBLE_TICK_MS in mach ticks
+
+    uint64_t writes;
+    uint64_t coalesced;
+};
+
+// MARK: - Compilation
+
+// Envelope at time t, 0-256
+static uint32_t envelope_at(const BigbenRumbleEffect* effect, uint32_t t) {
+    uint32_t attack = effect->attack_ms;
+    uint32_t sustain_end = attack + effect->sustain_ms;
+    uint32_t total = sustain_end + effect->decay_ms;
+
+    if (t < attack) {
+        return t * 256 / attack;
+    }
+    if (t < sustain_end) {
+        return 256;
+    }
+    return (total - t) * 256 / effect->decay_ms;
+}
+
+// Waveform at time t, 0-256
+static uint32_t waveform_at(const BigbenRumbleEffect* effect, uint32_t t) {
+    uint32_t period = effect->period_ms;
+    uint32_t half = period / 2;
+    uint32_t phase = period ? t % period : 0;
+
+    switch (effect->waveform) {
+        case BIGBEN_RUMBLE_SQUARE:
+            return phase < half ? 256 : 0;
+        case BIGBEN_RUMBLE_TRIANGLE:
+            return phase < half ? phase * 256 / half : (period - phase) * 256 / (period - half);
+        case BIGBEN_RUMBLE_CONSTANT:
+        default:
+            return 256;
+    }
+}
+
+static uint16_t* compile_effect(const BigbenRumbleEffect* effect, uint32_t* tick_count) {
+    uint32_t total = (uint32_t)effect->attack_ms + effect->sustain_ms + effect->decay_ms;
+    if (total == 0 || total > BIGBEN_RUMBLE_MAX_DURATION_MS) {
+        return NULL;
+    }
+    if (effect->waveform != BIGBEN_RUMBLE_CONSTANT &&
+        (effect->waveform > BIGBEN_RUMBLE_TRIANGLE || effect->period_ms < 2 * BIGBEN_RUMBLE_TICK_MS)) {
+        return NULL;
+    }
+
+    uint32_t count = (total + BIGBEN_RUMBLE_TICK_MS - 1) / BIGBEN_RUMBLE_TICK_MS;
+    uint16_t* levels = malloc(count * sizeof(uint16_t));
+    if (!levels) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t t = i * BIGBEN_RUMBLE_TICK_MS;
+        uint32_t scale = envelope_at(effect, t) * waveform_at(effect, t);   // 0-65536
+        uint32_t weak = (effect->weak_level * scale) >> 16;
+        uint32_t strong = (effect->strong_level * scale) >> 16;
+        levels[i] = RUMBLE_LEVELS(weak, strong);
+    }
+
+    *tick_count = count;
+    return levels;
+}
+
+// MARK: - Playback Thread
+
+static int write_levels(libusb_device_handle* handle, unsigned char endpoint, uint16_t levels) {
+    // XInput rumble report format
+    unsigned char data[8] = {
+        0x00,                       // Report ID
+        0x08,                       // Report size
+        0x00,                       // Reserved
+        (unsigned char)levels,      // Weak motor intensity
+        (unsigned char)(levels >> 8), // Strong motor intensity
+        0x00, 0x00, 0x00
+    };
+
+    int transferred;
+    return libusb_interrupt_transfer(handle, endpoint, data, sizeof(data), &transferred,
+                                     RUMBLE_WRITE_TIMEOUT_MS);
+}
+
+// Levels the device should have now; *deadline receives the start of the
+// next tick while an effect is playing, 0 otherwise. Called with the lock held.
+static uint16_t current_levels(BigbenRumbleEngine* engine, uint64_t now, uint64_t* deadline) {
+    *deadline = 0;
+
+    while (engine->playing >= 0) {
+        const CompiledEffect* effect = &engine->effects[engine->playing];
+        uint64_t tick = (now - engine->play_start) / engine->tick_ticks;
+
+        if (tick < effect->tick_count) {
+            *deadline = engine->play_start + (tick + 1) * engine->tick_ticks;
+            return effect->levels[tick];
+        }
+
+        // Past the end: start the next loop on the tick the last one ended
+        if (engine->loops_left == 1) {
+            engine->playing = -1;
+            break;
+        }
+        if (engine->loops_left > 1) {
+            engine->loops_left--;
+        }
+        engine->play_start += (uint64_t)effect->tick_count * engine->tick_ticks;
+    }
+
+    return engine->manual;
+}
+
+static void* rumble_thread_func(void* arg) {
+    BigbenRumbleEngine* engine = (BigbenRumbleEngine*)arg;
+
+    pthread_mutex_lock(&engine->lock);
+    while (!engine->stopping) {
+        uint64_t now = mach_absolute_time();
+        uint64_t deadline;
+        uint16_t levels = current_levels(engine, now, &deadline);
+
+        if (engine->handle && (!engine->sent_valid || levels != engine->sent)) {
+            // Never more than one write per tick; anything arriving meanwhile
+            // is folded into the write at the end of it
+            uint64_t earliest = engine->last_write + engine->tick_ticks;
+            if (engine->last_write != 0 && now < earliest) {
+                pthread_mutex_unlock(&engine->lock);
+                mach_wait_until(earliest);
+                pthread_mutex_lock(&engine->lock);
+                continue;
+            }
+
+            libusb_device_handle* handle = engine->handle;
+            engine->writing = true;
+            engine->dirty = false;
+            pthread_mutex_unlock(&engine->lock);
+
+            int r = write_levels(handle, engine->endpoint, levels);
+
+            pthread_mutex_lock(&engine->lock);
+            engine->writing = false;
+            engine->last_write = mach_absolute_time();
+            // A failed write is not retried until the levels change again,
+            // so an unplugged device does not keep the thread spinning
+            engine->sent = levels;
+            engine->sent_valid = true;
+            if (r < 0) {
+                fprintf(stderr, "bigben_rumble: Write error: %s\n", libusb_strerror(r));
+            } else {
+                engine->writes++;
+            }
+            pthread_cond_broadcast(&engine->cond);
+            continue;
+        }
+
+        engine->dirty = false;
+        if (deadline) {
+            pthread_mutex_unlock(&engine->lock);
+            mach_wait_until(deadline);
+            pthread_mutex_lock(&engine->lock);
+        } else {
+            pthread_cond_wait(&engine->cond, &engine->lock);
+        }
+    }
+    pthread_mutex_unlock(&engine->lock);
+
+    return NULL;
+}
+
+// Record a new command and wake the thread. Called with the lock held.
+static int submit_command(BigbenRumbleEngine* engine) {
+    if (engine->dirty) {
+        engine->coalesced++;
+    }
+    engine->dirty = true;
+
+    if (!engine->thread_started) {
+        if (pthread_create(&engine->thread, NULL, rumble_thread_func, engine) != 0) {
+            fprintf(stderr, "bigben_rumble: Failed to start rumble thread\n");
+            return -1;
+        }
+        engine->thread_started = true;
+    }
+    pthread_cond_broadcast(&engine->cond);
+    return 0;
+}
+
+// MARK: - Engine
+
+BigbenRumbleEngine* bigben_rumble_engine_create(unsigned char endpoint) {
+    BigbenRumbleEngine* engine = calloc(1, sizeof(BigbenRumbleEngine));
+    if (!engine) {
+        return NULL;
+    }
+
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    engine->tick_ticks = (uint64_t)BIGBEN_RUMBLE_TICK_MS * 1000000 * timebase.denom / timebase.numer;
+
+    engine->endpoint = endpoint;
+    engine->playing = -1;
+    pthread_mutex_init(&engine->lock, NULL);
+    pthread_cond_init(&engine->cond, NULL);
+    return engine;
+}
+
+void bigben_rumble_engine_destroy(BigbenRumbleEngine* engine) {
+    if (!engine) return;
+
+    pthread_mutex_lock(&engine->lock);
+    engine->stopping = true;
+    pthread_cond_broadcast(&engine->cond);
+    pthread_mutex_unlock(&engine->lock);
+
+    if (engine->thread_started) {
+        pthread_join(engine->thread, NULL);
+    }
+
+    for (int i = 0; i < BIGBEN_RUMBLE_MAX_EFFECTS; i++) {
+        free(engine->effects[i].levels);
+    }
+    pthread_cond_destroy(&engine->cond);
+    pthread_mutex_destroy(&engine->lock);
+    free(engine);
+}
+
+void bigben_rumble_engine_attach(BigbenRumbleEngine* engine, libusb_device_handle* handle) {
+    pthread_mutex_lock(&engine->lock);
+    engine->handle = handle;
+    engine->sent = 0;
+    engine->sent_valid = false;
+    engine->last_write = 0;
+    pthread_mutex_unlock(&engine->lock);
+}
+
+void bigben_rumble_engine_detach(BigbenRumbleEngine* engine) {
+    pthread_mutex_lock(&engine->lock);
+    engine->playing = -1;
+    engine->manual = 0;
+    engine->dirty = false;
+    while (engine->writing) {
+        pthread_cond_wait(&engine->cond, &engine->lock);
+    }
+
+    libusb_device_handle* handle = engine->handle;
+    bool running = engine->sent_valid && engine->sent != 0;
+    engine->handle = NULL;
+    pthread_mutex_unlock(&engine->lock);
+
+    // The motors keep their last level after the handle closes
+    if (handle && running) {
+        write_levels(handle, engine->endpoint, 0);
+    }
+}
+
+int bigben_rumble_engine_upload(BigbenRumbleEngine* engine, const BigbenRumbleEffect* effect) {
+    if (!effect) return -1;
+
+    uint32_t tick_count;
+    uint16_t* levels = compile_effect(effect, &tick_count);
+    if (!levels) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&engine->lock);
+    for (int i = 0; i < BIGBEN_RUMBLE_MAX_EFFECTS; i++) {
+        if (!engine->effects[i].levels) {
+            engine->effects[i].levels = levels;
+            engine->effects[i].tick_count = tick_count;
+            pthread_mutex_unlock(&engine->lock);
+            return i;
+        }
+    }
+    pthread_mutex_unlock(&engine->lock);
+
+    free(levels);
+    return -1;
+}
+
+void bigben_rumble_engine_erase(BigbenRumbleEngine* engine, int effect_id) {
+    if (effect_id < 0 || effect_id >= BIGBEN_RUMBLE_MAX_EFFECTS) return;
+
+    pthread_mutex_lock(&engine->lock);
+    if (engine->playing == effect_id) {
+        engine->playing = -1;
+        engine->manual = 0;
+        submit_command(engine);
+    }
+    free(engine->effects[effect_id].levels);
+    engine->effects[effect_id].levels = NULL;
+    engine->effects[effect_id].tick_count = 0;
+    pthread_mutex_unlock(&engine->lock);
+}
+
+int bigben_rumble_engine_play(BigbenRumbleEngine* engine, int effect_id, uint32_t loops) {
+    if (effect_id < 0 || effect_id >= BIGBEN_RUMBLE_MAX_EFFECTS) return -1;
+
+    pthread_mutex_lock(&engine->lock);
+    if (!engine->handle || !engine->effects[effect_id].levels) {
+        pthread_mutex_unlock(&engine->lock);
+        return -1;
+    }
+
+    engine->playing = effect_id;
+    engine->loops_left = loops;
+    engine->play_start = mach_absolute_time();
+    engine->manual = 0;
+    int result = submit_command(engine);
+    pthread_mutex_unlock(&engine->lock);
+    return result;
+}
+
+int bigben_rumble_engine_set(BigbenRumbleEngine* engine, uint8_t weak_motor, uint8_t strong_motor) {
+    pthread_mutex_lock(&engine->lock);
+    if (!engine->handle) {
+        pthread_mutex_unlock(&engine->lock);
+        return -1;
+    }
+
+    engine->playing = -1;
+    engine->manual = RUMBLE_LEVELS(weak_motor, strong_motor);
+    int result = submit_command(engine);
+    pthread_mutex_unlock(&engine->lock);
+    return result;
+}
+
+void bigben_rumble_engine_counters(BigbenRumbleEngine* engine, uint64_t* writes, uint64_t* coalesced) {
+    pthread_mutex_lock(&engine->lock);
+    if (writes) *writes = engine->writes;
+    if (coalesced) *coalesced = engine->coalesced;
+    pthread_mutex_unlock(&engine->lock);
+}
@@ -0,0 +1,36 @@
+// BigbenRumble.h - Rumble effect engine (internal)
+//
+// One engine per controller. Commands only update the engine's state under
+// its lock; a dedicated thread turns that state into motor writes on its own
+// clock, so a slow or missing device never stalls the caller.
+
+#ifndef BIGBEN_RUMBLE_H
+#define BIGBEN_RUMBLE_H
+
+#include "include/BigbenUSB.h"
+#include <libusb-1.0/libusb.h>
+
+typedef struct BigbenRumbleEngine BigbenRumbleEngine;
+
+// Create an engine writing to `endpoint`; the thread starts on first use
+// Returns NULL on failure
+BigbenRumbleEngine* bigben_rumble_engine_create(unsigned char endpoint);
+
+// Stop the thread and free the engine; it must be detached
+void bigben_rumble_engine_destroy(BigbenRumbleEngine* engine);
+
+// Start writing to an opened device
+void bigben_rumble_engine_attach(BigbenRumbleEngine* engine, libusb_device_handle* handle);
+
+// Stop playback, turn the motors off if they were running, and wait for any
+// write in progress; the handle may be closed once this returns
+void bigben_rumble_engine_detach(BigbenRumbleEngine* engine);
+
+// Back the public bigben_rumble_* calls and bigben_set_rumble
+int bigben_rumble_engine_upload(BigbenRumbleEngine* engine, const BigbenRumbleEffect* effect);
+void bigben_rumble_engine_erase(BigbenRumbleEngine* engine, int effect_id);
+int bigben_rumble_engine_play(BigbenRumbleEngine* engine, int effect_id, uint32_t loops);
+int bigben_rumble_engine_set(BigbenRumbleEngine* engine, uint8_t weak_motor, uint8_t strong_motor);
+void bigben_rumble_engine_counters(BigbenRumbleEngine* engine, uint64_t* writes, uint64_t* coalesced);
+
+#endif // BIGBEN_RUMBLE_H
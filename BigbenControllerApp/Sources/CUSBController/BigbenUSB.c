@@ -1,33 +1,109 @@
 // BigbenUSB.c - Bigben controller USB communication implementation
 
 #include "include/BigbenUSB.h"
+#include "BigbenBackend.h"
+#include "BigbenBorrow.h"
+#include "BigbenRing.h"
+#include "BigbenRumble.h"
 #include <libusb-1.0/libusb.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/time.h>
 #include <unistd.h>
 
 #define ENDPOINT_IN  0x81
 #define ENDPOINT_OUT 0x02
 #define INTERFACE_NUM 0
 #define READ_TIMEOUT_MS 100
+#define INPUT_PACKET_SIZE 64
+#define NUM_INPUT_TRANSFERS 4   // Interrupt IN transfers kept submitted at once
+#define MAX_INPUT_ERRORS 8      // Consecutive failed transfers before the device counts as lost
+#define MAX_HOTPLUG_CALLBACKS 4
+#define MIN_BORROW_BUFFERS 8    // Transfers plus a few reports in the consumer's hands
+
+_Static_assert(INPUT_PACKET_SIZE == BIGBEN_POOL_PACKET_SIZE, "borrowed buffers hold one packet");
 
 struct BigbenController {
     libusb_device_handle* handle;
-    pthread_t read_thread;
+    BigbenDeviceInfo info;          // Valid while handle is open
+    const BigbenBackend* backend;   // Report parser for info.product_id, chosen at open
+    bool loopback;                  // No device; reports come from bigben_loopback_inject
     volatile bool running;
     volatile bool connected;
 
+    // Async input engine (completed on the shared event thread while running)
+    struct libusb_transfer* transfers[NUM_INPUT_TRANSFERS];
+    unsigned char transfer_buffers[NUM_INPUT_TRANSFERS][INPUT_PACKET_SIZE];
+    int transfers_in_flight;        // Atomic; waited on under shared_lock
+    int input_errors;               // Consecutive failed transfers; event thread only
+
+    // Link in the list of open controllers
+    struct BigbenController* next_open;
+
+    // Startup timing (mach ticks); first_report_time is set by the event thread
+    uint64_t open_start_time;
+    uint64_t open_end_time;
+    uint64_t first_report_time;
+    bool opened_from_hint;
+
     BigbenInputCallback input_callback;
     void* input_context;
     BigbenConnectionCallback connection_callback;
     void* connection_context;
+
+    // Optional session recorder, fed on the event thread
+    BigbenRecorder* recorder;
+
+    // Rumble output, written from its own thread; attached while handle is open
+    BigbenRumbleEngine* rumble;
+
+    // Optional report queue (replaces input_callback when set)
+    BigbenRing* queue;
+    BigbenQueueNotify queue_notify;
+    void* queue_context;
+
+    // Optional buffer pool for borrowed reports (replaces queue and callback);
+    // transfers read straight into its buffers. Shares queue_notify.
+    BigbenBorrowPool* pool;
 };
 
 static libusb_context* usb_ctx = NULL;
 static int init_count = 0;
 
+// One event thread services the transfers of every reading controller; it
+// runs while at least one controller is reading
+static pthread_mutex_t shared_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t transfers_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t event_thread;
+static int event_thread_users = 0;
+static volatile bool event_thread_running = false;
+
+// Controllers with an open handle, so each open claims a different device
+static BigbenController* open_controllers = NULL;
+
+// Where a controller was last opened; tried before a full descriptor scan
+static BigbenDeviceInfo device_hint;
+static bool have_device_hint = false;
+
+// Hotplug registrations; busy is set while the callback runs so that
+// deregistering can wait for it. A retiring slot stays reserved until libusb
+// has dropped its callback, whose user_data is the slot index, so the index
+// cannot be handed out again while that callback can still fire.
+// Guarded by shared_lock.
+typedef struct {
+    bool used;
+    bool retiring;
+    bool busy;
+    BigbenHotplugCallback callback;
+    void* context;
+    libusb_hotplug_callback_handle handle;
+} HotplugSlot;
+
+static HotplugSlot hotplug_slots[MAX_HOTPLUG_CALLBACKS];
+static pthread_cond_t hotplug_cond = PTHREAD_COND_INITIALIZER;
+
 int bigben_init(void) {
     if (init_count++ > 0) {
         return 0; // Already initialized
@@ -60,6 +136,31 @@ BigbenController* bigben_create(void) {
     if (!controller) {
         return NULL;
     }
+
+    controller->rumble = bigben_rumble_engine_create(ENDPOINT_OUT);
+    if (!controller->rumble) {
+        free(controller);
+        return NULL;
+    }
+    return controller;
+}
+
+BigbenController* bigben_create_loopback(uint16_t product_id) {
+    const BigbenBackend* backend = bigben_backend_for_product(product_id);
+    if (!backend) {
+        fprintf(stderr, "bigben_create_loopback: Unsupported product 0x%04x\n", product_id);
+        return NULL;
+    }
+
+    BigbenController* controller = bigben_create();
+    if (!controller) {
+        return NULL;
+    }
+
+    controller->loopback = true;
+    controller->backend = backend;
+    controller->info.vendor_id = BIGBEN_VID;
+    controller->info.product_id = product_id;
     return controller;
 }
 
@@ -68,6 +169,9 @@ void bigben_destroy(BigbenController* controller) {
 
     bigben_stop_reading(controller);
     bigben_close(controller);
+    bigben_ring_destroy(controller->queue);
+    bigben_pool_destroy(controller->pool);
+    bigben_rumble_engine_destroy(controller->rumble);
     free(controller);
 }
 
@@ -83,7 +187,190 @@ void bigben_set_connection_callback(BigbenController* controller, BigbenConnecti
     controller->connection_context = context;
 }
 
-static libusb_device* find_bigben_device(void) {
+void bigben_set_recorder(BigbenController* controller, BigbenRecorder* recorder) {
+    if (!controller || controller->running) return;
+    controller->recorder = recorder;
+    if (recorder && controller->handle) {
+        bigben_recorder_set_device(recorder, controller->info.vendor_id, controller->info.product_id);
+    }
+}
+
+int bigben_enable_queue(BigbenController* controller, uint32_t capacity,
+                        BigbenOverflowPolicy policy, BigbenQueueNotify notify, void* context) {
+    if (!controller || controller->running) {
+        return -1;
+    }
+
+    BigbenRing* ring = bigben_ring_create(capacity, policy);
+    if (!ring) {
+        fprintf(stderr, "bigben_enable_queue: Invalid capacity %u\n", capacity);
+        return -1;
+    }
+
+    bigben_ring_destroy(controller->queue);
+    bigben_pool_destroy(controller->pool);
+    controller->pool = NULL;
+    controller->queue = ring;
+    controller->queue_notify = notify;
+    controller->queue_context = context;
+    return 0;
+}
+
+size_t bigben_drain(BigbenController* controller, BigbenInputReport* reports,
+                    uint64_t* timestamps, size_t max) {
+    if (!controller || !controller->queue || !reports) {
+        return 0;
+    }
+    return bigben_ring_drain(controller->queue, reports, timestamps, max);
+}
+
+uint64_t bigben_queue_dropped(BigbenController* controller) {
+    if (!controller || !controller->queue) {
+        return 0;
+    }
+    return bigben_ring_dropped(controller->queue);
+}
+
+int bigben_enable_borrowing(BigbenController* controller, uint32_t buffers,
+                            BigbenQueueNotify notify, void* context) {
+    if (!controller || controller->running) {
+        return -1;
+    }
+
+    BigbenBorrowPool* pool = buffers >= MIN_BORROW_BUFFERS ? bigben_pool_create(buffers) : NULL;
+    if (!pool) {
+        fprintf(stderr, "bigben_enable_borrowing: Invalid buffer count %u\n", buffers);
+        return -1;
+    }
+
+    bigben_ring_destroy(controller->queue);
+    bigben_pool_destroy(controller->pool);
+    controller->queue = NULL;
+    controller->pool = pool;
+    controller->queue_notify = notify;
+    controller->queue_context = context;
+    return 0;
+}
+
+size_t bigben_borrow(BigbenController* controller, BigbenReportView* views, size_t max) {
+    if (!controller || !controller->pool || !views) {
+        return 0;
+    }
+    return bigben_pool_borrow(controller->pool, views, max);
+}
+
+void bigben_release(BigbenController* controller, const BigbenReportView* views, size_t count) {
+    if (!controller || !controller->pool || !views) {
+        return;
+    }
+    bigben_pool_release(controller->pool, views, count);
+}
+
+uint64_t bigben_borrow_dropped(BigbenController* controller) {
+    if (!controller || !controller->pool) {
+        return 0;
+    }
+    return bigben_pool_dropped(controller->pool);
+}
+
+static bool is_bigben_device(const struct libusb_device_descriptor* desc) {
+    return desc->idVendor == BIGBEN_VID && bigben_backend_for_product(desc->idProduct) != NULL;
+}
+
+// Bus and port path only; unlike the descriptor this never touches the device
+static void fill_device_location(libusb_device* dev, BigbenDeviceInfo* info) {
+    memset(info, 0, sizeof(*info));
+    info->bus = libusb_get_bus_number(dev);
+    info->address = libusb_get_device_address(dev);
+
+    int depth = libusb_get_port_numbers(dev, info->ports, BIGBEN_MAX_PORT_DEPTH);
+    info->port_depth = depth > 0 ? (uint8_t)depth : 0;
+}
+
+static void fill_device_info(libusb_device* dev, const struct libusb_device_descriptor* desc,
+                             BigbenDeviceInfo* info) {
+    fill_device_location(dev, info);
+    info->vendor_id = desc->idVendor;
+    info->product_id = desc->idProduct;
+}
+
+// Same physical connection; the port path survives a replug, the address does not
+static bool same_device(const BigbenDeviceInfo* a, const BigbenDeviceInfo* b) {
+    if (a->bus != b->bus) {
+        return false;
+    }
+    if (a->port_depth > 0 && b->port_depth > 0) {
+        return a->port_depth == b->port_depth &&
+               memcmp(a->ports, b->ports, a->port_depth) == 0;
+    }
+    return a->address == b->address;
+}
+
+// Caller holds shared_lock
+static bool is_claimed(const BigbenDeviceInfo* info) {
+    for (BigbenController* c = open_controllers; c; c = c->next_open) {
+        if (c->info.bus == info->bus && c->info.address == info->address) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t bigben_enumerate(BigbenDeviceInfo* devices, size_t max) {
+    if (!usb_ctx) {
+        return 0;
+    }
+
+    libusb_device** devs;
+    ssize_t cnt = libusb_get_device_list(usb_ctx, &devs);
+    if (cnt < 0) {
+        return 0;
+    }
+
+    size_t found = 0;
+    for (ssize_t i = 0; i < cnt; i++) {
+        struct libusb_device_descriptor desc;
+        if (libusb_get_device_descriptor(devs[i], &desc) == 0 && is_bigben_device(&desc)) {
+            if (devices && found < max) {
+                fill_device_info(devs[i], &desc, &devices[found]);
+            }
+            found++;
+        }
+    }
+
+    libusb_free_device_list(devs, 1);
+    return found;
+}
+
+// Find the unclaimed Bigben device at a known location without reading the
+// descriptors of anything else on the bus
+// Caller holds shared_lock
+static libusb_device* find_device_at(libusb_device** devs, ssize_t cnt,
+                                     const BigbenDeviceInfo* location, BigbenDeviceInfo* info) {
+    for (ssize_t i = 0; i < cnt; i++) {
+        BigbenDeviceInfo candidate;
+        fill_device_location(devs[i], &candidate);
+        if (!same_device(location, &candidate)) {
+            continue;
+        }
+
+        struct libusb_device_descriptor desc;
+        if (libusb_get_device_descriptor(devs[i], &desc) != 0 || !is_bigben_device(&desc)) {
+            return NULL;
+        }
+
+        fill_device_info(devs[i], &desc, info);
+        return is_claimed(info) ? NULL : devs[i];
+    }
+    return NULL;
+}
+
+// Find a device that no other controller has open
+// wanted (optional) restricts the search to one physical device; otherwise
+// the device hint is tried before scanning every descriptor on the bus
+// Caller holds shared_lock
+static libusb_device* find_bigben_device(const BigbenDeviceInfo* wanted, BigbenDeviceInfo* info,
+                                         bool* from_hint) {
     libusb_device** devs;
     ssize_t cnt = libusb_get_device_list(usb_ctx, &devs);
     if (cnt < 0) {
@@ -91,22 +378,100 @@ static libusb_device* find_bigben_device(void) {
     }
 
     libusb_device* found = NULL;
-    for (ssize_t i = 0; i < cnt && !found; i++) {
+    *from_hint = false;
+
+    if (wanted) {
+        found = find_device_at(devs, cnt, wanted, info);
+    } else if (have_device_hint) {
+        found = find_device_at(devs, cnt, &device_hint, info);
+        *from_hint = found != NULL;
+    }
+
+    for (ssize_t i = 0; i < cnt && !found && !wanted; i++) {
         struct libusb_device_descriptor desc;
-        if (libusb_get_device_descriptor(devs[i], &desc) == 0) {
-            if (desc.idVendor == BIGBEN_VID &&
-                (desc.idProduct == BIGBEN_PID_PC || desc.idProduct == BIGBEN_PID_PS4)) {
-                found = devs[i];
-                libusb_ref_device(found);
-            }
+        if (libusb_get_device_descriptor(devs[i], &desc) != 0 || !is_bigben_device(&desc)) {
+            continue;
+        }
+
+        fill_device_info(devs[i], &desc, info);
+        if (!is_claimed(info)) {
+            found = devs[i];
         }
     }
 
+    if (found) {
+        libusb_ref_device(found);
+    }
+
     libusb_free_device_list(devs, 1);
     return found;
 }
 
+void bigben_set_device_hint(const BigbenDeviceInfo* device) {
+    pthread_mutex_lock(&shared_lock);
+    have_device_hint = device != NULL;
+    if (device) {
+        device_hint = *device;
+    }
+    pthread_mutex_unlock(&shared_lock);
+}
+
+bool bigben_get_device_hint(BigbenDeviceInfo* device) {
+    if (!device) return false;
+
+    pthread_mutex_lock(&shared_lock);
+    bool have = have_device_hint;
+    if (have) {
+        *device = device_hint;
+    }
+    pthread_mutex_unlock(&shared_lock);
+    return have;
+}
+
+static void unregister_open(BigbenController* controller) {
+    pthread_mutex_lock(&shared_lock);
+    for (BigbenController** link = &open_controllers; *link; link = &(*link)->next_open) {
+        if (*link == controller) {
+            *link = controller->next_open;
+            break;
+        }
+    }
+    controller->next_open = NULL;
+    pthread_mutex_unlock(&shared_lock);
+}
+
+// Connects without a device; everything after the USB open behaves as usual
+static int open_loopback(BigbenController* controller) {
+    if (controller->connected) {
+        return 0;
+    }
+
+    controller->open_start_time = bigben_timestamp();
+    __atomic_store_n(&controller->first_report_time, 0, __ATOMIC_RELAXED);
+    controller->opened_from_hint = false;
+    controller->connected = true;
+    controller->open_end_time = bigben_timestamp();
+
+    if (controller->recorder) {
+        bigben_recorder_set_device(controller->recorder, controller->info.vendor_id, controller->info.product_id);
+    }
+
+    if (controller->connection_callback) {
+        controller->connection_callback(true, controller->connection_context);
+    }
+
+    return 0;
+}
+
 int bigben_open(BigbenController* controller) {
+    return bigben_open_device(controller, NULL);
+}
+
+int bigben_open_device(BigbenController* controller, const BigbenDeviceInfo* device) {
+    if (controller && controller->loopback) {
+        return open_loopback(controller);
+    }
+
     if (!controller || !usb_ctx) {
         return -1;
     }
@@ -115,8 +480,16 @@ int bigben_open(BigbenController* controller) {
         return 0; // Already open
     }
 
-    libusb_device* dev = find_bigben_device();
+    controller->open_start_time = bigben_timestamp();
+    controller->open_end_time = 0;
+    __atomic_store_n(&controller->first_report_time, 0, __ATOMIC_RELAXED);
+
+    // Held until the controller is registered so two opens never pick the same pad
+    pthread_mutex_lock(&shared_lock);
+
+    libusb_device* dev = find_bigben_device(device, &controller->info, &controller->opened_from_hint);
     if (!dev) {
+        pthread_mutex_unlock(&shared_lock);
         fprintf(stderr, "bigben_open: Controller not found\n");
         return -1;
     }
@@ -125,10 +498,18 @@ int bigben_open(BigbenController* controller) {
     libusb_unref_device(dev);
 
     if (r < 0) {
+        pthread_mutex_unlock(&shared_lock);
         fprintf(stderr, "bigben_open: Failed to open device: %s\n", libusb_strerror(r));
+        controller->handle = NULL;
         return r;
     }
 
+    controller->next_open = open_controllers;
+    open_controllers = controller;
+    device_hint = controller->info;
+    have_device_hint = true;
+    pthread_mutex_unlock(&shared_lock);
+
     // Detach kernel driver if needed
     if (libusb_kernel_driver_active(controller->handle, INTERFACE_NUM) == 1) {
         r = libusb_detach_kernel_driver(controller->handle, INTERFACE_NUM);
@@ -141,12 +522,20 @@ int bigben_open(BigbenController* controller) {
     r = libusb_claim_interface(controller->handle, INTERFACE_NUM);
     if (r < 0) {
         fprintf(stderr, "bigben_open: Failed to claim interface: %s\n", libusb_strerror(r));
+        unregister_open(controller);
         libusb_close(controller->handle);
         controller->handle = NULL;
         return r;
     }
 
+    controller->backend = bigben_backend_for_product(controller->info.product_id);
     controller->connected = true;
+    controller->open_end_time = bigben_timestamp();
+    bigben_rumble_engine_attach(controller->rumble, controller->handle);
+
+    if (controller->recorder) {
+        bigben_recorder_set_device(controller->recorder, controller->info.vendor_id, controller->info.product_id);
+    }
 
     if (controller->connection_callback) {
         controller->connection_callback(true, controller->connection_context);
@@ -161,6 +550,8 @@ void bigben_close(BigbenController* controller) {
     bigben_stop_reading(controller);
 
     if (controller->handle) {
+        bigben_rumble_engine_detach(controller->rumble);
+        unregister_open(controller);
         libusb_release_interface(controller->handle, INTERFACE_NUM);
         libusb_close(controller->handle);
         controller->handle = NULL;
@@ -178,12 +569,33 @@ bool bigben_is_connected(BigbenController* controller) {
     return controller && controller->connected;
 }
 
+int bigben_get_startup_stats(BigbenController* controller, BigbenStartupStats* stats) {
+    if (!controller || !controller->open_end_time || !stats) {
+        return -1;
+    }
+
+    uint64_t first_report = __atomic_load_n(&controller->first_report_time, __ATOMIC_RELAXED);
+    stats->open_ns = bigben_ticks_to_ns(controller->open_end_time - controller->open_start_time);
+    stats->first_report_ns = first_report > controller->open_start_time
+        ? bigben_ticks_to_ns(first_report - controller->open_start_time) : 0;
+    stats->used_hint = controller->opened_from_hint;
+    return 0;
+}
+
+int bigben_get_device_info(BigbenController* controller, BigbenDeviceInfo* info) {
+    if (!controller || !(controller->handle || (controller->loopback && controller->connected)) || !info) {
+        return -1;
+    }
+    *info = controller->info;
+    return 0;
+}
+
 int bigben_poll(BigbenController* controller, BigbenInputReport* report, int timeout_ms) {
     if (!controller || !controller->handle || !report) {
         return -1;
     }
 
-    unsigned char data[64];
+    unsigned char data[INPUT_PACKET_SIZE];
     int transferred;
 
     int r = libusb_interrupt_transfer(controller->handle, ENDPOINT_IN,
@@ -198,49 +610,278 @@ int bigben_poll(BigbenController* controller, BigbenInputReport* report, int tim
         return r;
     }
 
-    // Parse the data into the report structure
-    // XInput format: bytes 0-1 are header, 2-3 buttons, 4-5 triggers, 6-13 sticks
-    if (transferred >= 14) {
-        report->report_id = data[0];
-        report->report_size = data[1];
-        report->buttons = data[2] | (data[3] << 8);
-        report->left_trigger = data[4];
-        report->right_trigger = data[5];
-        report->left_stick_x = (int16_t)(data[6] | (data[7] << 8));
-        report->left_stick_y = (int16_t)(data[8] | (data[9] << 8));
-        report->right_stick_x = (int16_t)(data[10] | (data[11] << 8));
-        report->right_stick_y = (int16_t)(data[12] | (data[13] << 8));
+    if (!controller->backend->parse(data, transferred, report)) {
+        return -1;
     }
 
     return 0;
 }
 
-static void* read_thread_func(void* arg) {
-    BigbenController* controller = (BigbenController*)arg;
-    BigbenInputReport report;
+// Called on the event thread when the device goes away
+static void handle_device_lost(BigbenController* controller) {
+    if (!controller->connected) {
+        return; // Already reported by another transfer
+    }
+
+    controller->connected = false;
+    if (controller->connection_callback) {
+        controller->connection_callback(false, controller->connection_context);
+    }
+}
+
+// A transfer has left the host controller for good
+static void transfer_retired(BigbenController* controller) {
+    __atomic_fetch_sub(&controller->transfers_in_flight, 1, __ATOMIC_RELEASE);
+    pthread_mutex_lock(&shared_lock);
+    pthread_cond_broadcast(&transfers_cond);
+    pthread_mutex_unlock(&shared_lock);
+}
+
+// A packet has landed in *buffer: parse it and hand it to the consumer.
+// In borrowing mode *buffer is lent out and replaced with a free one.
+// Returns false if the packet was rejected or dropped.
+static bool deliver_input_packet(BigbenController* controller, unsigned char** buffer, int length,
+                                 uint64_t timestamp) {
+    BigbenBorrowPool* pool = controller->pool;
+    const BigbenInputReport* report;
+    BigbenInputReport copy;
+    if (pool) {
+        // Read where the packet landed; only other layouts are converted
+        report = (const BigbenInputReport*)controller->backend->view(
+            *buffer, length, bigben_pool_scratch(pool, *buffer));
+    } else {
+        memset(&copy, 0, sizeof(copy));
+        report = controller->backend->parse(*buffer, length, &copy) ? &copy : NULL;
+    }
+    if (!report) {
+        return false;
+    }
+    bigben_latency_record(BIGBEN_STAGE_PARSE, timestamp);
+
+    if (__atomic_load_n(&controller->first_report_time, __ATOMIC_RELAXED) == 0) {
+        __atomic_store_n(&controller->first_report_time, timestamp, __ATOMIC_RELAXED);
+    }
+
+    if (controller->recorder) {
+        bigben_recorder_write(controller->recorder, report, timestamp);
+    }
+
+    if (pool) {
+        // Lend this buffer and read the next report into a free one;
+        // with none free, the report is dropped and the buffer reused
+        unsigned char* fresh = bigben_pool_take(pool);
+        if (!fresh) {
+            bigben_pool_count_drop(pool);
+            return false;
+        }
+        bool wake = bigben_pool_publish(pool, *buffer, (const unsigned char*)report, timestamp);
+        *buffer = fresh;
+        bigben_latency_record(BIGBEN_STAGE_ENQUEUE, timestamp);
+        if (wake && controller->queue_notify) {
+            controller->queue_notify(controller->queue_context);
+        }
+    } else if (controller->queue) {
+        // Copy and go back to the endpoint; the consumer does the rest
+        bool wake = bigben_ring_push(controller->queue, report, timestamp);
+        bigben_latency_record(BIGBEN_STAGE_ENQUEUE, timestamp);
+        if (wake && controller->queue_notify) {
+            controller->queue_notify(controller->queue_context);
+        }
+    } else if (controller->input_callback) {
+        controller->input_callback(report, controller->input_context);
+    }
+    return true;
+}
+
+static void LIBUSB_CALL input_transfer_cb(struct libusb_transfer* transfer) {
+    BigbenController* controller = (BigbenController*)transfer->user_data;
+
+    switch (transfer->status) {
+        case LIBUSB_TRANSFER_COMPLETED:
+            controller->input_errors = 0;
+            deliver_input_packet(controller, &transfer->buffer, transfer->actual_length, bigben_timestamp());
+            break;
+
+        case LIBUSB_TRANSFER_TIMED_OUT:
+            break;
+
+        case LIBUSB_TRANSFER_CANCELLED:
+            transfer_retired(controller);
+            return;
+
+        case LIBUSB_TRANSFER_NO_DEVICE:
+            transfer_retired(controller);
+            handle_device_lost(controller);
+            return;
 
-    while (controller->running) {
-        int r = bigben_poll(controller, &report, READ_TIMEOUT_MS);
+        case LIBUSB_TRANSFER_STALL:
+            // The endpoint stays halted until it is cleared; still counts as a failure
+            libusb_clear_halt(controller->handle, ENDPOINT_IN);
+            // fall through
 
-        if (r == LIBUSB_ERROR_NO_DEVICE || r == LIBUSB_ERROR_IO) {
-            // Device disconnected
-            controller->connected = false;
-            if (controller->connection_callback) {
-                controller->connection_callback(false, controller->connection_context);
+        default:
+            // A failing device or hub would otherwise spin the shared event thread
+            if (++controller->input_errors >= MAX_INPUT_ERRORS) {
+                if (controller->input_errors == MAX_INPUT_ERRORS) {
+                    fprintf(stderr, "input_transfer_cb: %d transfers failed in a row (status %d)\n",
+                            MAX_INPUT_ERRORS, transfer->status);
+                }
+                transfer_retired(controller);
+                handle_device_lost(controller);
+                return;
             }
             break;
+    }
+
+    if (!controller->running) {
+        transfer_retired(controller);
+        return;
+    }
+
+    // Hand the buffer straight back to the host controller
+    int r = libusb_submit_transfer(transfer);
+    if (r < 0) {
+        transfer_retired(controller);
+        if (r == LIBUSB_ERROR_NO_DEVICE) {
+            handle_device_lost(controller);
+        } else {
+            fprintf(stderr, "input_transfer_cb: Resubmit failed: %s\n", libusb_strerror(r));
         }
+    }
+}
 
-        if (r == 0 && controller->input_callback) {
-            controller->input_callback(&report, controller->input_context);
+// Only called once no transfer is in flight
+static void free_input_transfers(BigbenController* controller) {
+    for (int i = 0; i < NUM_INPUT_TRANSFERS; i++) {
+        if (controller->transfers[i]) {
+            if (controller->pool) {
+                bigben_pool_put_back(controller->pool, controller->transfers[i]->buffer);
+            }
+            libusb_free_transfer(controller->transfers[i]);
+            controller->transfers[i] = NULL;
+        }
+    }
+}
+
+static void cancel_input_transfers(BigbenController* controller) {
+    for (int i = 0; i < NUM_INPUT_TRANSFERS; i++) {
+        if (controller->transfers[i]) {
+            libusb_cancel_transfer(controller->transfers[i]);
+        }
+    }
+}
+
+// Block until the event thread has retired every transfer of the controller
+static void wait_for_transfers(BigbenController* controller) {
+    pthread_mutex_lock(&shared_lock);
+    while (__atomic_load_n(&controller->transfers_in_flight, __ATOMIC_ACQUIRE) > 0) {
+        pthread_cond_wait(&transfers_cond, &shared_lock);
+    }
+    pthread_mutex_unlock(&shared_lock);
+}
+
+// Allocate and submit the input transfers
+// Returns 0 if at least one transfer is in flight
+static int submit_input_transfers(BigbenController* controller) {
+    controller->transfers_in_flight = 0;
+    controller->input_errors = 0;
+
+    for (int i = 0; i < NUM_INPUT_TRANSFERS; i++) {
+        // Borrowed reports may still hold buffers from before a restart
+        unsigned char* buffer = controller->pool ? bigben_pool_take(controller->pool)
+                                                 : controller->transfer_buffers[i];
+        if (!buffer) {
+            break;
+        }
+
+        struct libusb_transfer* transfer = libusb_alloc_transfer(0);
+        if (!transfer) {
+            if (controller->pool) {
+                bigben_pool_put_back(controller->pool, buffer);
+            }
+            break;
+        }
+
+        // No timeout: a transfer only completes when the controller sends a report
+        libusb_fill_interrupt_transfer(transfer, controller->handle, ENDPOINT_IN,
+                                       buffer, INPUT_PACKET_SIZE,
+                                       input_transfer_cb, controller, 0);
+        controller->transfers[i] = transfer;
+
+        // Counted first: the event thread may complete it before submit returns
+        __atomic_fetch_add(&controller->transfers_in_flight, 1, __ATOMIC_RELAXED);
+        int r = libusb_submit_transfer(transfer);
+        if (r < 0) {
+            __atomic_fetch_sub(&controller->transfers_in_flight, 1, __ATOMIC_RELAXED);
+            fprintf(stderr, "bigben_start_reading: Failed to submit transfer: %s\n", libusb_strerror(r));
+            break;
+        }
+    }
+
+    if (__atomic_load_n(&controller->transfers_in_flight, __ATOMIC_ACQUIRE) == 0) {
+        free_input_transfers(controller);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void* event_thread_func(void* arg) {
+    (void)arg;
+
+    // Completions for every controller are delivered from inside
+    // libusb_handle_events; the loop runs until the last reader stops
+    while (event_thread_running) {
+        struct timeval tv = { 0, READ_TIMEOUT_MS * 1000 };
+        int r = libusb_handle_events_timeout_completed(usb_ctx, &tv, NULL);
+        if (r < 0 && r != LIBUSB_ERROR_INTERRUPTED) {
+            // Keep going: stopping readers wait on this thread to retire transfers
+            fprintf(stderr, "event_thread_func: Event handling failed: %s\n", libusb_strerror(r));
+            usleep(READ_TIMEOUT_MS * 1000);
         }
     }
 
     return NULL;
 }
 
+// Start the shared event thread for the first reader
+static int event_thread_acquire(void) {
+    int result = 0;
+
+    pthread_mutex_lock(&shared_lock);
+    if (event_thread_users == 0) {
+        event_thread_running = true;
+        if (pthread_create(&event_thread, NULL, event_thread_func, NULL) != 0) {
+            fprintf(stderr, "bigben_start_reading: Failed to create event thread\n");
+            event_thread_running = false;
+            result = -1;
+        }
+    }
+    if (result == 0) {
+        event_thread_users++;
+    }
+    pthread_mutex_unlock(&shared_lock);
+
+    return result;
+}
+
+// Stop the shared event thread after the last reader
+static void event_thread_release(void) {
+    pthread_mutex_lock(&shared_lock);
+    bool last = --event_thread_users == 0;
+    if (last) {
+        event_thread_running = false;
+    }
+    pthread_mutex_unlock(&shared_lock);
+
+    if (last) {
+        libusb_interrupt_event_handler(usb_ctx);
+        pthread_join(event_thread, NULL);
+    }
+}
+
 int bigben_start_reading(BigbenController* controller) {
-    if (!controller || !controller->handle) {
+    if (!controller || !(controller->handle || (controller->loopback && controller->connected))) {
         return -1;
     }
 
@@ -248,12 +889,21 @@ int bigben_start_reading(BigbenController* controller) {
         return 0; // Already running
     }
 
+    // Nothing to submit: the injecting thread stands in for the event thread
+    if (controller->loopback) {
+        controller->running = true;
+        return 0;
+    }
+
+    if (event_thread_acquire() != 0) {
+        return -1;
+    }
+
     controller->running = true;
 
-    int r = pthread_create(&controller->read_thread, NULL, read_thread_func, controller);
-    if (r != 0) {
-        fprintf(stderr, "bigben_start_reading: Failed to create thread\n");
+    if (submit_input_transfers(controller) != 0) {
         controller->running = false;
+        event_thread_release();
         return -1;
     }
 
@@ -266,32 +916,198 @@ void bigben_stop_reading(BigbenController* controller) {
     }
 
     controller->running = false;
-    pthread_join(controller->read_thread, NULL);
+    if (controller->loopback) {
+        return;
+    }
+
+    // Cancelled transfers complete on the event thread; other controllers
+    // keep reading while this one drains
+    cancel_input_transfers(controller);
+    wait_for_transfers(controller);
+    free_input_transfers(controller);
+
+    event_thread_release();
 }
 
-int bigben_set_rumble(BigbenController* controller, uint8_t weak_motor, uint8_t strong_motor) {
-    if (!controller || !controller->handle) {
+int bigben_loopback_inject(BigbenController* controller, const uint8_t* packet, int length,
+                           uint64_t timestamp) {
+    if (!controller || !controller->loopback || !controller->running ||
+        !packet || length <= 0 || length > INPUT_PACKET_SIZE) {
+        return -1;
+    }
+
+    // Same buffer handling as a transfer: borrowing mode lends the buffer
+    // the packet was written to and leaves a free one in its place
+    BigbenBorrowPool* pool = controller->pool;
+    unsigned char local[INPUT_PACKET_SIZE];
+    unsigned char* buffer = pool ? bigben_pool_take(pool) : local;
+    if (!buffer) {
+        bigben_pool_count_drop(pool);
         return -1;
     }
 
-    // XInput rumble report format
-    unsigned char data[8] = {
-        0x00,         // Report ID
-        0x08,         // Report size
-        0x00,         // Reserved
-        weak_motor,   // Weak motor intensity
-        strong_motor, // Strong motor intensity
-        0x00, 0x00, 0x00
-    };
+    memcpy(buffer, packet, (size_t)length);
+    bool delivered = deliver_input_packet(controller, &buffer, length,
+                                          timestamp ? timestamp : bigben_timestamp());
+    if (pool) {
+        bigben_pool_put_back(pool, buffer);
+    }
+    return delivered ? 0 : -1;
+}
 
-    int transferred;
-    int r = libusb_interrupt_transfer(controller->handle, ENDPOINT_OUT,
-                                       data, sizeof(data), &transferred, 100);
+bool bigben_hotplug_supported(void) {
+    return libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG) != 0;
+}
+
+static int LIBUSB_CALL hotplug_cb(libusb_context* ctx, libusb_device* dev,
+                                  libusb_hotplug_event event, void* user_data) {
+    (void)ctx;
+    HotplugSlot* slot = &hotplug_slots[(intptr_t)user_data];
+
+    struct libusb_device_descriptor desc;
+    if (libusb_get_device_descriptor(dev, &desc) != 0 || !is_bigben_device(&desc)) {
+        return 0;
+    }
+
+    BigbenDeviceInfo info;
+    fill_device_info(dev, &desc, &info);
+
+    pthread_mutex_lock(&shared_lock);
+    if (!slot->used || slot->retiring) {
+        pthread_mutex_unlock(&shared_lock);
+        return 0; // Deregistered while libusb was dispatching
+    }
+    slot->busy = true;
+    BigbenHotplugCallback callback = slot->callback;
+    void* context = slot->context;
+    pthread_mutex_unlock(&shared_lock);
+
+    callback(&info, event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED, context);
+
+    pthread_mutex_lock(&shared_lock);
+    slot->busy = false;
+    pthread_cond_broadcast(&hotplug_cond);
+    pthread_mutex_unlock(&shared_lock);
+
+    return 0; // Stay registered
+}
+
+int bigben_hotplug_register(BigbenHotplugCallback callback, void* context) {
+    if (!callback || !usb_ctx) {
+        return -1;
+    }
+
+    if (!bigben_hotplug_supported()) {
+        return LIBUSB_ERROR_NOT_SUPPORTED;
+    }
 
+    pthread_mutex_lock(&shared_lock);
+    intptr_t index = -1;
+    for (intptr_t i = 0; i < MAX_HOTPLUG_CALLBACKS; i++) {
+        if (!hotplug_slots[i].used) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        pthread_mutex_unlock(&shared_lock);
+        fprintf(stderr, "bigben_hotplug_register: Too many callbacks\n");
+        return -1;
+    }
+    HotplugSlot* slot = &hotplug_slots[index];
+    slot->used = true;
+    slot->retiring = false;
+    slot->busy = false;
+    slot->callback = callback;
+    slot->context = context;
+    pthread_mutex_unlock(&shared_lock);
+
+    // Events are delivered from libusb_handle_events, so keep the
+    // event thread running for as long as the registration exists
+    if (event_thread_acquire() != 0) {
+        pthread_mutex_lock(&shared_lock);
+        slot->used = false;
+        pthread_mutex_unlock(&shared_lock);
+        return -1;
+    }
+
+    // Product IDs are filtered in hotplug_cb
+    int r = libusb_hotplug_register_callback(usb_ctx,
+                                             LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+                                             LIBUSB_HOTPLUG_NO_FLAGS, BIGBEN_VID,
+                                             LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY,
+                                             hotplug_cb, (void*)index, &slot->handle);
     if (r < 0) {
-        fprintf(stderr, "bigben_set_rumble: Write error: %s\n", libusb_strerror(r));
+        fprintf(stderr, "bigben_hotplug_register: Failed to register: %s\n", libusb_strerror(r));
+        pthread_mutex_lock(&shared_lock);
+        slot->used = false;
+        pthread_mutex_unlock(&shared_lock);
+        event_thread_release();
         return r;
     }
 
-    return 0;
+    return (int)index;
+}
+
+void bigben_hotplug_deregister(int handle) {
+    if (handle < 0 || handle >= MAX_HOTPLUG_CALLBACKS) {
+        return;
+    }
+
+    HotplugSlot* slot = &hotplug_slots[handle];
+
+    pthread_mutex_lock(&shared_lock);
+    if (!slot->used || slot->retiring) {
+        pthread_mutex_unlock(&shared_lock);
+        return;
+    }
+    slot->retiring = true;
+    while (slot->busy) {
+        pthread_cond_wait(&hotplug_cond, &shared_lock);
+    }
+    libusb_hotplug_callback_handle libusb_handle = slot->handle;
+    pthread_mutex_unlock(&shared_lock);
+
+    libusb_hotplug_deregister_callback(usb_ctx, libusb_handle);
+
+    pthread_mutex_lock(&shared_lock);
+    slot->used = false;
+    slot->retiring = false;
+    pthread_mutex_unlock(&shared_lock);
+
+    event_thread_release();
+}
+
+int bigben_set_rumble(BigbenController* controller, uint8_t weak_motor, uint8_t strong_motor) {
+    if (!controller || !controller->handle) {
+        return -1;
+    }
+    return bigben_rumble_engine_set(controller->rumble, weak_motor, strong_motor);
+}
+
+int bigben_rumble_upload(BigbenController* controller, const BigbenRumbleEffect* effect) {
+    if (!controller) return -1;
+    return bigben_rumble_engine_upload(controller->rumble, effect);
+}
+
+void bigben_rumble_erase(BigbenController* controller, int effect_id) {
+    if (!controller) return;
+    bigben_rumble_engine_erase(controller->rumble, effect_id);
+}
+
+int bigben_rumble_play(BigbenController* controller, int effect_id, uint32_t loops) {
+    if (!controller || !controller->handle) {
+        return -1;
+    }
+    return bigben_rumble_engine_play(controller->rumble, effect_id, loops);
+}
+
+void bigben_rumble_stop(BigbenController* controller) {
+    if (!controller || !controller->handle) return;
+    bigben_rumble_engine_set(controller->rumble, 0, 0);
+}
+
+void bigben_rumble_counters(BigbenController* controller, uint64_t* writes, uint64_t* coalesced) {
+    if (!controller) return;
+    bigben_rumble_engine_counters(controller->rumble, writes, coalesced);
 }
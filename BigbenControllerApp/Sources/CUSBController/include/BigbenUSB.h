@@ -5,6 +5,9 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+
+#include "../../../../Shared/StickShaping.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,6 +17,10 @@ extern "C" {
 #define BIGBEN_VID 0x146b
 #define BIGBEN_PID_PC 0x0603
 #define BIGBEN_PID_PS4 0x0d05
+#define BIGBEN_PID_PS3 0x0902
+
+// Every model's reports are delivered in this layout, whatever its wire
+// format (see Shared/ProtocolTraits.h)
 
 // XInput report structure (20 bytes)
 typedef struct {
@@ -50,9 +57,32 @@ typedef struct {
 typedef void (*BigbenInputCallback)(const BigbenInputReport* report, void* context);
 typedef void (*BigbenConnectionCallback)(bool connected, void* context);
 
+// Overflow policy for the input queue
+typedef enum {
+    BIGBEN_OVERFLOW_DROP_OLDEST = 0,  // Keep the most recent reports, oldest are overwritten
+    BIGBEN_OVERFLOW_KEEP_LATEST = 1   // Only the newest report is ever drained
+} BigbenOverflowPolicy;
+
+// Called on the USB thread when the queue goes from drained to non-empty
+typedef void (*BigbenQueueNotify)(void* context);
+
 // Controller context (opaque)
 typedef struct BigbenController BigbenController;
 
+// Where a controller is attached
+// The port path identifies the physical port across replugs; the address
+// changes every time the device is enumerated
+#define BIGBEN_MAX_PORT_DEPTH 7
+
+typedef struct {
+    uint16_t vendor_id;
+    uint16_t product_id;
+    uint8_t bus;
+    uint8_t address;
+    uint8_t port_depth;                     // Valid entries in ports (0 if unknown)
+    uint8_t ports[BIGBEN_MAX_PORT_DEPTH];   // Hub port path from the root hub
+} BigbenDeviceInfo;
+
 // Initialize the USB library
 // Returns 0 on success, negative on error
 int bigben_init(void);
@@ -71,32 +101,404 @@ void bigben_destroy(BigbenController* controller);
 void bigben_set_input_callback(BigbenController* controller, BigbenInputCallback callback, void* context);
 void bigben_set_connection_callback(BigbenController* controller, BigbenConnectionCallback callback, void* context);
 
-// Open connection to the controller
+// List attached Bigben controllers
+// Fills up to max entries of devices (may be NULL to just count)
+// Returns the number of controllers found
+size_t bigben_enumerate(BigbenDeviceInfo* devices, size_t max);
+
+// Open connection to the first controller not already open in this process
 // Returns 0 on success, negative on error
 int bigben_open(BigbenController* controller);
 
+// Open connection to a specific controller from bigben_enumerate
+// device: matched by bus and port path; NULL behaves like bigben_open
+// Returns 0 on success, negative on error
+int bigben_open_device(BigbenController* controller, const BigbenDeviceInfo* device);
+
+// Attachment of an open controller
+// Returns 0 on success, negative if not open
+int bigben_get_device_info(BigbenController* controller, BigbenDeviceInfo* info);
+
+// Where to look first in bigben_open
+// Each successful open updates the hint. If the hinted port holds an
+// unclaimed Bigben controller it is opened without reading any other
+// device's descriptor; otherwise the whole bus is scanned. Persist the hint
+// from bigben_get_device_hint to speed up the next launch. NULL clears it.
+void bigben_set_device_hint(const BigbenDeviceInfo* device);
+
+// Returns false if there is no hint yet
+bool bigben_get_device_hint(BigbenDeviceInfo* device);
+
+// Timing of the most recent bigben_open, measured from the start of the call
+typedef struct {
+    uint64_t open_ns;           // Until the interface was claimed
+    uint64_t first_report_ns;   // Until the first input report completed (0 if none yet)
+    bool used_hint;             // Found through the device hint, no full scan
+} BigbenStartupStats;
+
+// Returns 0 on success, negative if the controller was never opened
+int bigben_get_startup_stats(BigbenController* controller, BigbenStartupStats* stats);
+
+// Called on the USB event thread when a Bigben controller is plugged in
+// (arrived = true) or removed. Must not call bigben_open or
+// bigben_hotplug_deregister; hand the event to another thread instead.
+typedef void (*BigbenHotplugCallback)(const BigbenDeviceInfo* device, bool arrived, void* context);
+
+// True if libusb supports hotplug events on this platform
+bool bigben_hotplug_supported(void);
+
+// Register for arrival and removal events
+// Only changes after registration are reported; use bigben_enumerate for the
+// devices already attached. Keeps the USB event thread running until
+// deregistered, with no bus scanning while idle.
+// Returns a handle (>= 0) on success, negative on error or if unsupported
+int bigben_hotplug_register(BigbenHotplugCallback callback, void* context);
+
+// Remove a registration; waits for a callback already in progress
+// After it returns the callback will not be called again
+void bigben_hotplug_deregister(int handle);
+
 // Close connection
 void bigben_close(BigbenController* controller);
 
 // Check if connected
 bool bigben_is_connected(BigbenController* controller);
 
-// Start reading input in a background thread
+// Start reading input on the shared USB event thread
+// Several interrupt transfers are kept submitted and completed by libusb's
+// event loop; each report is delivered through this controller's input
+// callback as soon as it arrives. If the device is unplugged, the connection
+// callback fires with false on the same thread. A single thread serves every
+// reading controller, and exits when the last one stops.
 // Returns 0 on success, negative on error
 int bigben_start_reading(BigbenController* controller);
 
 // Stop reading input
+// Must not be called from the input or connection callback
 void bigben_stop_reading(BigbenController* controller);
 
+// Loopback controller (benchmarks)
+// A controller with no USB device behind it. Open, start and stop work as
+// usual, and each injected packet takes the same parse, recorder, queue or
+// borrow and latency path as one from the interrupt endpoint. Rumble output
+// goes nowhere.
+// Returns NULL if product_id has no report backend
+BigbenController* bigben_create_loopback(uint16_t product_id);
+
+// Deliver one raw input packet (at most 64 bytes) as if its transfer had
+// completed at `timestamp` (mach ticks, 0 = now). Call from one thread
+// while reading, never concurrently with bigben_stop_reading.
+// Returns 0 if delivered, -1 if the parser rejected it or it was dropped
+int bigben_loopback_inject(BigbenController* controller, const uint8_t* packet, int length,
+                           uint64_t timestamp);
+
+// Deliver reports through a lock-free queue instead of the input callback
+// The USB thread only copies each report into the queue; the consumer calls
+// bigben_drain from its own thread. `notify` (optional) fires once per batch,
+// the first time a report is queued after a drain.
+// Must be called before bigben_start_reading. capacity: 1-4096 reports.
+// Returns 0 on success, negative on error
+int bigben_enable_queue(BigbenController* controller, uint32_t capacity,
+                        BigbenOverflowPolicy policy, BigbenQueueNotify notify, void* context);
+
+// Copy up to max queued reports, oldest first, into reports
+// timestamps (optional) receives each report's USB completion time in mach ticks.
+// Call again while it returns max to empty the queue.
+// Returns the number of reports copied
+size_t bigben_drain(BigbenController* controller, BigbenInputReport* reports,
+                    uint64_t* timestamps, size_t max);
+
+// Number of queued reports dropped by the overflow policy
+uint64_t bigben_queue_dropped(BigbenController* controller);
+
+// Borrowed reports (zero-copy alternative to the queue)
+// The engine owns a pool of packet buffers and reads straight into them.
+// A completed buffer is swapped out of its transfer and lent to the consumer
+// as a view of the packed report, which stays valid until it is released.
+// Read views through the accessors below; they are byte-wise and do not
+// depend on alignment or host byte order.
+typedef struct {
+    const uint8_t* bytes;   // Packed BigbenInputReport, little endian
+    uint64_t timestamp;     // USB completion time in mach ticks
+    uint32_t buffer;        // Engine buffer, for bigben_release
+} BigbenReportView;
+
+// Replaces the queue and the input callback while reading. `buffers`
+// (8-64) bounds how many reports can be queued or borrowed at once; reports
+// arriving while none is free are dropped. `notify` (optional) fires like
+// the queue's, once per batch. Must be called before bigben_start_reading.
+// Returns 0 on success, negative on error
+int bigben_enable_borrowing(BigbenController* controller, uint32_t buffers,
+                            BigbenQueueNotify notify, void* context);
+
+// Lend up to max pending reports, oldest first
+// Returns the number of views filled
+size_t bigben_borrow(BigbenController* controller, BigbenReportView* views, size_t max);
+
+// Give views back once they have been read; call from the borrowing thread
+void bigben_release(BigbenController* controller, const BigbenReportView* views, size_t count);
+
+// Reports dropped because every buffer was queued or borrowed
+uint64_t bigben_borrow_dropped(BigbenController* controller);
+
+static inline uint16_t bigben_view_u16(const BigbenReportView* view, size_t offset) {
+    return (uint16_t)(view->bytes[offset] | (view->bytes[offset + 1] << 8));
+}
+
+static inline uint16_t bigben_view_buttons(const BigbenReportView* view) {
+    return bigben_view_u16(view, offsetof(BigbenInputReport, buttons));
+}
+
+static inline uint8_t bigben_view_left_trigger(const BigbenReportView* view) {
+    return view->bytes[offsetof(BigbenInputReport, left_trigger)];
+}
+
+static inline uint8_t bigben_view_right_trigger(const BigbenReportView* view) {
+    return view->bytes[offsetof(BigbenInputReport, right_trigger)];
+}
+
+static inline int16_t bigben_view_left_stick_x(const BigbenReportView* view) {
+    return (int16_t)bigben_view_u16(view, offsetof(BigbenInputReport, left_stick_x));
+}
+
+static inline int16_t bigben_view_left_stick_y(const BigbenReportView* view) {
+    return (int16_t)bigben_view_u16(view, offsetof(BigbenInputReport, left_stick_y));
+}
+
+static inline int16_t bigben_view_right_stick_x(const BigbenReportView* view) {
+    return (int16_t)bigben_view_u16(view, offsetof(BigbenInputReport, right_stick_x));
+}
+
+static inline int16_t bigben_view_right_stick_y(const BigbenReportView* view) {
+    return (int16_t)bigben_view_u16(view, offsetof(BigbenInputReport, right_stick_y));
+}
+
 // Send rumble command
 // weak_motor: 0-255 intensity for weak motor
 // strong_motor: 0-255 intensity for strong motor
+// Never blocks: the levels are handed to the rumble thread, which writes the
+// latest ones at most once per BIGBEN_RUMBLE_TICK_MS. Stops a playing effect.
+// Returns 0 on success, negative if the controller is not open
 int bigben_set_rumble(BigbenController* controller, uint8_t weak_motor, uint8_t strong_motor);
 
+// Rumble effects
+// An effect is uploaded once and compiled into a table of motor levels, one
+// entry per tick. Playback runs on the controller's rumble thread, which only
+// writes the motors when the level changes, so the caller never waits on USB
+// and the device never sees more than one update per tick.
+#define BIGBEN_RUMBLE_TICK_MS 8             // 125 Hz upper bound on motor updates
+#define BIGBEN_RUMBLE_MAX_EFFECTS 8
+#define BIGBEN_RUMBLE_MAX_DURATION_MS 30000 // attack + sustain + decay
+
+typedef enum {
+    BIGBEN_RUMBLE_CONSTANT = 0,     // Envelope only
+    BIGBEN_RUMBLE_SQUARE = 1,       // Envelope for the first half of each period, off for the second
+    BIGBEN_RUMBLE_TRIANGLE = 2      // Ramps from 0 to the envelope and back each period
+} BigbenRumbleWaveform;
+
+typedef struct {
+    uint8_t weak_level;             // Sustain levels, 0-255
+    uint8_t strong_level;
+    uint16_t attack_ms;             // Ramp from 0 up to the sustain levels
+    uint16_t sustain_ms;
+    uint16_t decay_ms;              // Ramp from the sustain levels down to 0
+    uint16_t period_ms;             // Waveform period, at least 2 ticks; ignored for BIGBEN_RUMBLE_CONSTANT
+    BigbenRumbleWaveform waveform;
+} BigbenRumbleEffect;
+
+// Compile an effect into a free slot; effects survive reconnects
+// Returns an effect ID (>= 0), or negative if the effect is invalid or every slot is used
+int bigben_rumble_upload(BigbenController* controller, const BigbenRumbleEffect* effect);
+
+// Free an effect's slot, stopping it if it is playing
+void bigben_rumble_erase(BigbenController* controller, int effect_id);
+
+// Start an effect from its beginning, replacing whatever is playing
+// loops: times to play it back to back, 0 to repeat until stopped
+// Returns 0 on success, negative if the ID is unknown or the controller is not open
+int bigben_rumble_play(BigbenController* controller, int effect_id, uint32_t loops);
+
+// Stop the playing effect and turn both motors off
+void bigben_rumble_stop(BigbenController* controller);
+
+// Motor writes actually issued, and commands superseded by a newer one
+// before the rumble thread got to write them
+void bigben_rumble_counters(BigbenController* controller, uint64_t* writes, uint64_t* coalesced);
+
 // Poll for input once (blocking with timeout)
+// Do not mix with bigben_start_reading on the same controller
 // Returns 0 on success, negative on error or timeout
 int bigben_poll(BigbenController* controller, BigbenInputReport* report, int timeout_ms);
 
+// Input recording
+// A recording is a 32-byte header followed by fixed-size frames, so it can
+// be memory-mapped and indexed directly. Timestamps are the USB completion
+// times in nanoseconds.
+#define BIGBEN_RECORD_MAGIC 0x43524242  // "BBRC"
+#define BIGBEN_RECORD_VERSION 1
+#define BIGBEN_RECORD_FRAME_SIZE 32
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t frame_size;
+    uint16_t vendor_id;
+    uint16_t product_id;
+    uint32_t reserved;
+    uint64_t frame_count;   // 0 if the recorder was never closed
+    uint64_t start_ns;      // Timestamp of the first frame
+} BigbenRecordHeader;
+
+typedef struct {
+    uint64_t timestamp_ns;
+    BigbenInputReport report;
+    uint8_t reserved[4];
+} BigbenRecordFrame;
+
+typedef struct BigbenRecorder BigbenRecorder;
+
+// Create or truncate a recording; frames are written by a background thread
+BigbenRecorder* bigben_recorder_create(const char* path);
+
+// Device written into the header on close
+void bigben_recorder_set_device(BigbenRecorder* recorder, uint16_t vendor_id, uint16_t product_id);
+
+// Append a report from the reader thread (single producer); timestamp is in
+// mach ticks. Copies into a double buffer and never blocks on the file.
+// Returns false if the frame was dropped because the writer fell behind
+bool bigben_recorder_write(BigbenRecorder* recorder, const BigbenInputReport* report, uint64_t timestamp);
+
+// Frames on disk so far; the last partial buffer is only written by close
+uint64_t bigben_recorder_frames(BigbenRecorder* recorder);
+uint64_t bigben_recorder_dropped(BigbenRecorder* recorder);
+
+// Flush, finalize the header and free the recorder
+// frames (optional) receives the final frame count, as stored in the header
+// Returns 0 on success, negative if any write failed
+int bigben_recorder_close(BigbenRecorder* recorder, uint64_t* frames);
+
+// Record every report the controller reads, on the USB thread, before it is
+// queued. Attach and detach (NULL) only while the controller is not reading.
+void bigben_set_recorder(BigbenController* controller, BigbenRecorder* recorder);
+
+// Input replay
+typedef struct BigbenReplay BigbenReplay;
+
+typedef enum {
+    BIGBEN_REPLAY_ORIGINAL_TIMING = 0,  // Deliver frames at their recorded spacing
+    BIGBEN_REPLAY_AS_FAST_AS_POSSIBLE = 1
+} BigbenReplayPacing;
+
+// timestamp is the mach time the frame was delivered at
+typedef void (*BigbenReplayCallback)(const BigbenInputReport* report, uint64_t timestamp, void* context);
+
+// Map a recording read-only; NULL if it is missing or not a recording
+BigbenReplay* bigben_replay_open(const char* path);
+void bigben_replay_close(BigbenReplay* replay);
+
+const BigbenRecordHeader* bigben_replay_header(BigbenReplay* replay);
+const BigbenRecordFrame* bigben_replay_frames(BigbenReplay* replay);
+size_t bigben_replay_frame_count(BigbenReplay* replay);
+
+// Deliver every frame to callback on the calling thread
+// elapsed_ns (optional) receives the wall time of the run.
+// Returns the number of frames delivered
+size_t bigben_replay_run(BigbenReplay* replay, BigbenReplayPacing pacing,
+                         BigbenReplayCallback callback, void* context, uint64_t* elapsed_ns);
+
+// Stop a run in progress after the current frame; safe from any thread
+void bigben_replay_cancel(BigbenReplay* replay);
+
+// Mouse delta hand-off
+// Accumulates pixel deltas from the input thread for an output thread to
+// collect on its own clock, without locks. Precision is 1/256 pixel.
+typedef struct BigbenMouseDelta BigbenMouseDelta;
+
+BigbenMouseDelta* bigben_delta_create(void);
+void bigben_delta_destroy(BigbenMouseDelta* delta);
+
+// Add a delta; timestamp (mach ticks) is the report it came from
+void bigben_delta_add(BigbenMouseDelta* delta, double dx, double dy, uint64_t timestamp);
+
+// Take and clear the accumulated delta
+// timestamp receives the oldest report behind it (0 if none)
+// Returns false if nothing was pending
+bool bigben_delta_take(BigbenMouseDelta* delta, double* dx, double* dy, uint64_t* timestamp);
+
+// Mouse buttons currently held, published for the output thread
+void bigben_delta_set_buttons(BigbenMouseDelta* delta, uint32_t buttons);
+uint32_t bigben_delta_buttons(BigbenMouseDelta* delta);
+
+// Published object hand-off (RCU-style)
+// A writer replaces an immutable object with one atomic swap; the single
+// reader picks the newest up with two loads and marks it as the one it is
+// using, so the writer knows when a replaced object can be freed. The
+// reader never locks, waits or allocates. Objects are opaque pointers.
+typedef struct BigbenPublished BigbenPublished;
+
+BigbenPublished* bigben_published_create(void);
+void bigben_published_destroy(BigbenPublished* published);
+
+// Writer: make `object` current; returns the object it replaced (or NULL)
+// Writers must be serialized among themselves.
+const void* bigben_published_swap(BigbenPublished* published, const void* object);
+
+// Reader: the current object, which stays valid until the next call
+const void* bigben_published_acquire(BigbenPublished* published);
+
+// Writer: true while the reader may still be using a replaced object
+bool bigben_published_in_use(BigbenPublished* published, const void* object);
+
+// Stick shaping
+// The fixed-point radial deadzone and curve engine from Shared/, the same
+// code the dext runs: BigbenStickShapeInit() and BigbenStickApply() on raw
+// int16 stick values
+
+// Latency instrumentation
+// Each stage is measured from the moment the USB transfer completed, so the
+// last stage is the end-to-end latency. Recording is a no-op until enabled.
+typedef enum {
+    BIGBEN_STAGE_PARSE = 0,     // Raw packet parsed on the USB thread
+    BIGBEN_STAGE_ENQUEUE,       // Report published to the input queue
+    BIGBEN_STAGE_DRAIN,         // Report drained by the consumer
+    BIGBEN_STAGE_TRANSLATE,     // Report converted to controller state
+    BIGBEN_STAGE_PROCESS,       // Controller state fully processed
+    BIGBEN_STAGE_POST,          // Keyboard/mouse event posted
+    BIGBEN_STAGE_COUNT
+} BigbenLatencyStage;
+
+typedef struct {
+    uint64_t count;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+} BigbenLatencyStats;
+
+// Enable or disable recording (disabled by default)
+void bigben_latency_enable(bool enabled);
+bool bigben_latency_enabled(void);
+
+// Current time in mach absolute ticks, the unit of report timestamps
+uint64_t bigben_timestamp(void);
+
+// Convert a mach tick interval to nanoseconds
+uint64_t bigben_ticks_to_ns(uint64_t ticks);
+
+// Record the time elapsed since `since` (mach ticks) for a stage
+// Ignored when recording is disabled or since is 0
+void bigben_latency_record(BigbenLatencyStage stage, uint64_t since);
+
+// Read the percentiles collected so far for a stage
+void bigben_latency_summary(BigbenLatencyStage stage, BigbenLatencyStats* stats);
+
+// Clear all stage histograms
+void bigben_latency_reset(void);
+
+// Short name for a stage, for printing
+const char* bigben_latency_stage_name(BigbenLatencyStage stage);
+
 #ifdef __cplusplus
 }
 #endif
@@ -71,8 +71,13 @@ class USBControllerReader: ObservableObject {
     private var controller: OpaquePointer?
     private var readTimer: DispatchSourceTimer?
     private var isRunning = false
+    private var hotplugHandle: Int32 = -1
     private let pollQueue = DispatchQueue(label: "com.gamepad.poll", qos: .userInteractive)
 
+    // A freshly attached device can take a few milliseconds to become openable
+    private static let arrivalRetryCount = 5
+    private static let arrivalRetryDelay: DispatchTimeInterval = .milliseconds(10)
+
     init() {
         let result = bigben_init()
         if result != 0 {
@@ -93,11 +98,28 @@ class USBControllerReader: ObservableObject {
             statusMessage = "Failed to create controller"
             return
         }
+
+        // Reconnect on arrival events instead of rescanning every second
+        if bigben_hotplug_supported() {
+            let context = Unmanaged.passUnretained(self).toOpaque()
+            hotplugHandle = bigben_hotplug_register({ _, arrived, context in
+                guard arrived, let context = context else { return }
+                let reader = Unmanaged<USBControllerReader>.fromOpaque(context).takeUnretainedValue()
+                DispatchQueue.main.async {
+                    reader.connectAfterArrival(attempt: 0)
+                }
+            }, context)
+        }
+
         tryConnect()
     }
 
     func stop() {
         isRunning = false
+        if hotplugHandle >= 0 {
+            bigben_hotplug_deregister(hotplugHandle)
+            hotplugHandle = -1
+        }
         readTimer?.cancel()
         readTimer = nil
         if let ctrl = controller {
@@ -109,23 +131,35 @@ class USBControllerReader: ObservableObject {
     }
 
     private func tryConnect() {
-        guard let ctrl = controller else { return }
+        guard isRunning, let ctrl = controller, !bigben_is_connected(ctrl) else { return }
 
-        let result = bigben_open(ctrl)
-        if result == 0 {
-            DispatchQueue.main.async { [weak self] in
-                self?.isConnected = true
-                self?.statusMessage = "Controller connected"
-            }
-            startReading()
-        } else {
-            DispatchQueue.main.asyncAfter(deadline: .now() + 1.0) { [weak self] in
-                guard let self = self, self.isRunning else { return }
-                self.tryConnect()
+        if !open(ctrl) {
+            scheduleReconnect()
+        }
+    }
+
+    // The arrival event is the only trigger with hotplug, so retry briefly
+    private func connectAfterArrival(attempt: Int) {
+        guard isRunning, let ctrl = controller, !bigben_is_connected(ctrl) else { return }
+
+        if !open(ctrl) && attempt < USBControllerReader.arrivalRetryCount {
+            DispatchQueue.main.asyncAfter(deadline: .now() + USBControllerReader.arrivalRetryDelay) { [weak self] in
+                self?.connectAfterArrival(attempt: attempt + 1)
             }
         }
     }
 
+    private func open(_ ctrl: OpaquePointer) -> Bool {
+        guard bigben_open(ctrl) == 0 else { return false }
+
+        DispatchQueue.main.async { [weak self] in
+            self?.isConnected = true
+            self?.statusMessage = "Controller connected"
+        }
+        startReading()
+        return true
+    }
+
     private func startReading() {
         readTimer?.cancel()
         let timer = DispatchSource.makeTimerSource(queue: pollQueue)
@@ -162,10 +196,17 @@ class USBControllerReader: ObservableObject {
                 bigben_close(ctrl)
             }
 
-            DispatchQueue.main.asyncAfter(deadline: .now() + 1.0) { [weak self] in
-                guard let self = self, self.isRunning else { return }
-                self.tryConnect()
-            }
+            scheduleReconnect()
+        }
+    }
+
+    // Without hotplug support, rescan until the controller shows up
+    private func scheduleReconnect() {
+        guard hotplugHandle < 0 else { return }
+
+        DispatchQueue.main.asyncAfter(deadline: .now() + 1.0) { [weak self] in
+            guard let self = self, self.isRunning else { return }
+            self.tryConnect()
         }
     }
 }
@@ -0,0 +1,213 @@
+//
+//  InputBenchmark.swift
+//  BigbenController
+//
+//  End-to-end input benchmark: timestamped reports are injected into a
+//  loopback controller at a fixed rate or in bursts and travel the real
+//  path (engine, USBControllerReader, pipeline thread, KeyboardEmulator)
+//  with event posting stubbed, so a regression in any stage shows up
+//
+
+import Foundation
+import Darwin
+import CUSBController
+
+// MARK: - Input Benchmark
+
+final class InputBenchmark {
+
+    /// How fast reports are injected
+    struct Load: CustomStringConvertible {
+        /// Injection ticks per second
+        var hz: Double
+        /// Reports injected back to back on each tick
+        var burst: Int = 1
+
+        var description: String {
+            burst > 1 ? "\(burst) x \(Int(hz)) Hz burst" : "\(Int(hz)) Hz"
+        }
+
+        /// Common controller polling rates, plus bursts at the lowest one
+        static let standard = [Load(hz: 125), Load(hz: 500), Load(hz: 1000), Load(hz: 125, burst: 8)]
+    }
+
+    struct Result {
+        var load: Load
+        var injected = 0
+        /// Reports that reached the pipeline thread
+        var drained: UInt64 = 0
+        var dropped: UInt64 = 0
+        /// From the first injection until the pipeline had drained the last report
+        var elapsedNs: UInt64 = 0
+        /// User and system time of the whole process over the run
+        var cpuNs: UInt64 = 0
+        var stages: [(name: String, stats: BigbenLatencyStats)] = []
+
+        var reportsPerSecond: Double {
+            elapsedNs > 0 ? Double(drained) * 1_000_000_000 / Double(elapsedNs) : 0
+        }
+
+        var cpuNsPerReport: Double {
+            drained > 0 ? Double(cpuNs) / Double(drained) : 0
+        }
+    }
+
+    /// Where the injected reports come from
+    let source: String
+
+    private let reader = USBControllerReader(loopbackProductID: UInt16(BIGBEN_PID_PC))
+    private let emulator: KeyboardEmulator
+
+    // XInput packets back to back; recordings store that layout for every model
+    private let packets: [UInt8]
+    private let packetCount: Int
+    private var cursor = 0
+    private static let packetSize = MemoryLayout<BigbenInputReport>.size
+    private static let syntheticCount = 1024
+    private static let drainTimeoutNs: UInt64 = 1_000_000_000
+
+    /// - Parameters:
+    ///   - emulator: Receives every state change; set `postsEvents` to false
+    ///     to keep the benchmark from driving the real cursor and keyboard
+    ///   - recordingPath: Session recording (see InputReplayer) whose
+    ///     reports are injected in order; nil injects a synthetic sweep
+    init?(emulator: KeyboardEmulator, recordingPath: String? = nil) {
+        self.emulator = emulator
+
+        if let path = recordingPath {
+            guard let replay = bigben_replay_open(path) else { return nil }
+            defer { bigben_replay_close(replay) }
+
+            let count = bigben_replay_frame_count(replay)
+            guard count > 0, let frames = bigben_replay_frames(replay) else { return nil }
+
+            var bytes = [UInt8]()
+            bytes.reserveCapacity(count * InputBenchmark.packetSize)
+            for i in 0..<count {
+                withUnsafeBytes(of: frames[i].report) { bytes.append(contentsOf: $0) }
+            }
+            packets = bytes
+            packetCount = count
+            source = "\(count) recorded reports"
+        } else {
+            packets = InputBenchmark.syntheticPackets(count: InputBenchmark.syntheticCount)
+            packetCount = InputBenchmark.syntheticCount
+            source = "synthetic stick sweep"
+        }
+
+        reader.onStateChanged = { [unowned self] state in
+            self.emulator.processState(state, timestamp: self.reader.currentReportTimestamp)
+        }
+    }
+
+    /// Connect the loopback controller and wait until the pipeline is up
+    func start() -> Bool {
+        let connected = DispatchSemaphore(value: 0)
+        reader.onConnected = {
+            connected.signal()
+        }
+        reader.start()
+        return connected.wait(timeout: .now() + 1) == .success
+    }
+
+    func stop() {
+        reader.stop()
+    }
+
+    /// Inject reports at `load` for `seconds` on the calling thread, which
+    /// should run with the real-time policy, then wait for the pipeline to
+    /// catch up. Latency statistics are reset first, so enable recording
+    /// with bigben_latency_enable beforehand.
+    func run(_ load: Load, seconds: Double) -> Result {
+        var result = Result(load: load)
+
+        var timebase = mach_timebase_info_data_t()
+        mach_timebase_info(&timebase)
+        let intervalTicks = UInt64(1_000_000_000 / max(1, load.hz)) * UInt64(timebase.denom) / UInt64(timebase.numer)
+        let ticks = Int(max(1, load.hz * seconds))
+
+        bigben_latency_reset()
+        let droppedBefore = reader.droppedReports
+        let cpuBefore = InputBenchmark.processCPUTimeNs()
+        let start = mach_absolute_time()
+
+        packets.withUnsafeBufferPointer { bytes in
+            guard let base = bytes.baseAddress else { return }
+            var deadline = start
+            for _ in 0..<ticks {
+                mach_wait_until(deadline)
+                for _ in 0..<max(1, load.burst) {
+                    reader.injectLoopbackPacket(base + cursor * InputBenchmark.packetSize,
+                                                length: InputBenchmark.packetSize)
+                    cursor = (cursor + 1) % packetCount
+                    result.injected += 1
+                }
+                deadline += intervalTicks
+            }
+        }
+
+        // Everything not dropped is on its way to the pipeline thread
+        result.dropped = reader.droppedReports - droppedBefore
+        let expected = UInt64(result.injected) - min(UInt64(result.injected), result.dropped)
+        let injectedAt = mach_absolute_time()
+        repeat {
+            result.drained = InputBenchmark.stageCount(BIGBEN_STAGE_DRAIN)
+            if result.drained >= expected {
+                break
+            }
+            usleep(1000)
+        } while bigben_ticks_to_ns(mach_absolute_time() - injectedAt) < InputBenchmark.drainTimeoutNs
+
+        result.elapsedNs = bigben_ticks_to_ns(mach_absolute_time() - start)
+        result.cpuNs = InputBenchmark.processCPUTimeNs() - cpuBefore
+
+        for rawStage in 0..<BIGBEN_STAGE_COUNT.rawValue {
+            let stage = BigbenLatencyStage(rawValue: rawStage)
+            var stats = BigbenLatencyStats()
+            bigben_latency_summary(stage, &stats)
+            guard stats.count > 0 else { continue }
+            result.stages.append((String(cString: bigben_latency_stage_name(stage)), stats))
+        }
+        return result
+    }
+
+    // MARK: - Report Sources
+
+    // Right stick circling at 60% while A toggles every 64 reports: every
+    // report changes the state, and the mouse path runs on each one
+    private static func syntheticPackets(count: Int) -> [UInt8] {
+        var bytes = [UInt8]()
+        bytes.reserveCapacity(count * packetSize)
+
+        for i in 0..<count {
+            let angle = Double(i) * 2 * Double.pi / Double(count)
+            let radius = 0.6 * Double(BIGBEN_STICK_ONE)
+
+            var report = BigbenInputReport()
+            report.report_size = UInt8(packetSize)
+            report.buttons = (i / 64) % 2 == 0 ? 0 : UInt16(BTN_A)
+            report.right_stick_x = Int16(radius * cos(angle))
+            report.right_stick_y = Int16(radius * sin(angle))
+            withUnsafeBytes(of: report) { bytes.append(contentsOf: $0) }
+        }
+        return bytes
+    }
+
+    // MARK: - Measurement
+
+    private static func stageCount(_ stage: BigbenLatencyStage) -> UInt64 {
+        var stats = BigbenLatencyStats()
+        bigben_latency_summary(stage, &stats)
+        return stats.count
+    }
+
+    private static func processCPUTimeNs() -> UInt64 {
+        var usage = rusage()
+        getrusage(RUSAGE_SELF, &usage)
+
+        func ns(_ time: timeval) -> UInt64 {
+            UInt64(time.tv_sec) * 1_000_000_000 + UInt64(time.tv_usec) * 1_000
+        }
+        return ns(usage.ru_utime) + ns(usage.ru_stime)
+    }
+}
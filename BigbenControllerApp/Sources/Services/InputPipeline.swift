@@ -0,0 +1,361 @@
+//
+//  InputPipeline.swift
+//  BigbenController
+//
+//  Dedicated real-time thread that runs the whole input path
+//  (drain, translation, key diffing and event posting) off the main thread
+//
+
+import Foundation
+import Darwin
+
+// MARK: - Input Pipeline Thread
+
+/// Runs `work` each time it is signalled, on a thread scheduled with the
+/// Mach time-constraint policy so GUI or status bar hitches on the main
+/// thread never delay input. Control operations (connect, disconnect,
+/// resets) are queued with `perform` and run on the same thread, so the
+/// pipeline state never needs a lock.
+final class InputPipelineThread {
+
+    /// Scheduling hints for the time-constraint policy
+    struct Timing {
+        /// Expected interval between wakeups (the controller's report rate)
+        var periodNs: UInt64 = 1_000_000
+        /// CPU time needed per wakeup
+        var computationNs: UInt64 = 150_000
+        /// Deadline for finishing the work after a wakeup
+        var constraintNs: UInt64 = 1_000_000
+
+        static let `default` = Timing()
+    }
+
+    private let name: String
+    private let timing: Timing
+    private let work: () -> Void
+
+    private var thread: Thread?
+    private let wakeup = DispatchSemaphore(value: 0)
+    private let exited = DispatchSemaphore(value: 0)
+    private var isCancelled = false
+
+    // Control blocks handed over from other threads
+    private let pendingLock = NSLock()
+    private var pendingBlocks: [() -> Void] = []
+
+    init(name: String, timing: Timing = .default, work: @escaping () -> Void) {
+        self.name = name
+        self.timing = timing
+        self.work = work
+    }
+
+    // MARK: - Lifecycle
+
+    func start() {
+        guard thread == nil else { return }
+
+        isCancelled = false
+        let thread = Thread { [unowned self] in
+            self.run()
+        }
+        thread.name = name
+        thread.qualityOfService = .userInteractive
+        self.thread = thread
+        thread.start()
+    }
+
+    /// Stop the thread and wait for the current iteration to finish
+    /// Blocks queued with `perform` before the call still run.
+    func stop() {
+        guard thread != nil else { return }
+
+        pendingLock.lock()
+        isCancelled = true
+        pendingLock.unlock()
+
+        wakeup.signal()
+        exited.wait()
+        thread = nil
+    }
+
+    /// Wake the thread to run `work`; safe from any thread, including
+    /// the USB event thread
+    func signal() {
+        wakeup.signal()
+    }
+
+    /// Run a block on the pipeline thread before the next `work` pass
+    func perform(_ block: @escaping () -> Void) {
+        pendingLock.lock()
+        pendingBlocks.append(block)
+        pendingLock.unlock()
+        wakeup.signal()
+    }
+
+    // MARK: - Thread Body
+
+    private func run() {
+        if !InputPipelineThread.setRealtimePolicy(timing) {
+            print("Warning: could not set real-time policy for \(name)")
+        }
+
+        while true {
+            wakeup.wait()
+
+            pendingLock.lock()
+            let blocks = pendingBlocks
+            pendingBlocks.removeAll(keepingCapacity: true)
+            let cancelled = isCancelled
+            pendingLock.unlock()
+
+            for block in blocks {
+                block()
+            }
+            if cancelled {
+                break
+            }
+
+            work()
+        }
+
+        exited.signal()
+    }
+
+    // MARK: - Scheduling
+
+    static func setRealtimePolicy(_ timing: Timing) -> Bool {
+        var timebase = mach_timebase_info_data_t()
+        mach_timebase_info(&timebase)
+
+        func ticks(_ ns: UInt64) -> UInt32 {
+            UInt32(clamping: ns * UInt64(timebase.denom) / UInt64(timebase.numer))
+        }
+
+        var policy = thread_time_constraint_policy_data_t(
+            period: ticks(timing.periodNs),
+            computation: ticks(timing.computationNs),
+            constraint: ticks(timing.constraintNs),
+            preemptible: 1
+        )
+
+        let count = mach_msg_type_number_t(
+            MemoryLayout<thread_time_constraint_policy_data_t>.size / MemoryLayout<integer_t>.size)
+        let result = withUnsafeMutablePointer(to: &policy) { pointer in
+            pointer.withMemoryRebound(to: integer_t.self, capacity: Int(count)) {
+                thread_policy_set(pthread_mach_thread_np(pthread_self()),
+                                  thread_policy_flavor_t(THREAD_TIME_CONSTRAINT_POLICY),
+                                  $0, count)
+            }
+        }
+        return result == KERN_SUCCESS
+    }
+}
+
+// MARK: - Idle Backoff
+
+/// Tells the output clocks when the pad has gone quiet, so they can back off
+/// instead of waking at full rate for input nobody is giving. The pipeline
+/// thread reports every state change with `noteActivity`; the clocks call
+/// `clockTick` on their own threads and slow down while it returns true.
+final class IdleBackoff {
+
+    struct Stats {
+        /// Output clock wakeups per second since the previous snapshot
+        var wakeupsPerSecond: Double = 0
+        /// Share of the time since the previous snapshot spent backed off (0-1)
+        var idleResidency: Double = 0
+    }
+
+    /// Time without a state change before the clocks back off; 0 never does
+    var idleAfterNs: UInt64 {
+        get { lock.lock(); defer { lock.unlock() }; return idleAfterTicks * timebaseNumer / timebaseDenom }
+        set { lock.lock(); idleAfterTicks = newValue * timebaseDenom / timebaseNumer; lock.unlock() }
+    }
+
+    /// Longest a backed-off fixed-rate clock sleeps between ticks
+    let idleIntervalNs: UInt64
+
+    private let lock = NSLock()
+    private let timebaseNumer: UInt64
+    private let timebaseDenom: UInt64
+    private var idleAfterTicks: UInt64 = 0
+    private var lastActivity: UInt64 = mach_absolute_time()
+    private var isIdle = false
+    private var idleSince: UInt64 = 0
+
+    // Accumulated since the last stats snapshot
+    private var wakeups: UInt64 = 0
+    private var idleTicks: UInt64 = 0
+    private var snapshotTime: UInt64 = mach_absolute_time()
+
+    init(idleAfterNs: UInt64, idleIntervalNs: UInt64) {
+        var timebase = mach_timebase_info_data_t()
+        mach_timebase_info(&timebase)
+        timebaseNumer = UInt64(timebase.numer)
+        timebaseDenom = UInt64(timebase.denom)
+        self.idleIntervalNs = idleIntervalNs
+        self.idleAfterNs = idleAfterNs
+    }
+
+    /// Pipeline thread, on every state change
+    /// - Returns: true if the clocks were backed off and must be woken
+    func noteActivity() -> Bool {
+        let now = mach_absolute_time()
+        lock.lock()
+        defer { lock.unlock() }
+
+        lastActivity = now
+        guard isIdle else { return false }
+        isIdle = false
+        idleTicks += now - idleSince
+        return true
+    }
+
+    /// Output clock, on every wakeup
+    /// - Returns: true while the clock should stay backed off
+    func clockTick() -> Bool {
+        let now = mach_absolute_time()
+        lock.lock()
+        defer { lock.unlock() }
+
+        wakeups += 1
+        if !isIdle && idleAfterTicks > 0 && now - lastActivity >= idleAfterTicks {
+            isIdle = true
+            idleSince = now
+        }
+        return isIdle
+    }
+
+    var isBackedOff: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return isIdle
+    }
+
+    /// Wakeup rate and idle residency since the previous call
+    func takeStats() -> Stats {
+        let now = mach_absolute_time()
+        lock.lock()
+        defer { lock.unlock() }
+
+        var idle = idleTicks
+        if isIdle {
+            idle += now - idleSince
+            idleSince = now
+        }
+        let elapsed = now - snapshotTime
+        var stats = Stats()
+        if elapsed > 0 {
+            let seconds = Double(elapsed * timebaseNumer / timebaseDenom) / 1_000_000_000
+            stats.wakeupsPerSecond = Double(wakeups) / seconds
+            stats.idleResidency = Double(idle) / Double(elapsed)
+        }
+
+        wakeups = 0
+        idleTicks = 0
+        snapshotTime = now
+        return stats
+    }
+}
+
+// MARK: - Fixed Rate Clock
+
+/// Calls `tick` at a fixed rate from a real-time thread, sleeping with
+/// mach_wait_until on absolute deadlines so the rate does not drift.
+/// Missed deadlines are skipped rather than bunched up. With an
+/// IdleBackoff, the clock sleeps up to its idle interval between ticks
+/// while input is quiet, until `wake()` brings it back to full rate.
+final class FixedRateClock {
+
+    private let name: String
+    private let intervalNs: UInt64
+    private let idle: IdleBackoff?
+    private let tick: () -> Void
+
+    private var thread: Thread?
+    private let exited = DispatchSemaphore(value: 0)
+    private let wakeup = DispatchSemaphore(value: 0)
+    private let stateLock = NSLock()
+    private var isCancelled = false
+
+    init(name: String, hz: Double, idle: IdleBackoff? = nil, tick: @escaping () -> Void) {
+        self.name = name
+        self.intervalNs = UInt64(1_000_000_000 / max(1, hz))
+        self.idle = idle
+        self.tick = tick
+    }
+
+    func start() {
+        guard thread == nil else { return }
+
+        isCancelled = false
+        let thread = Thread { [unowned self] in
+            self.run()
+        }
+        thread.name = name
+        thread.qualityOfService = .userInteractive
+        self.thread = thread
+        thread.start()
+    }
+
+    /// Stop the clock; waits for a tick in progress (at most one interval)
+    func stop() {
+        guard thread != nil else { return }
+
+        stateLock.lock()
+        isCancelled = true
+        stateLock.unlock()
+
+        wakeup.signal()
+        exited.wait()
+        thread = nil
+    }
+
+    /// Return to full rate right away after backing off; safe from any thread
+    func wake() {
+        wakeup.signal()
+    }
+
+    private func run() {
+        var timebase = mach_timebase_info_data_t()
+        mach_timebase_info(&timebase)
+        let intervalTicks = intervalNs * UInt64(timebase.denom) / UInt64(timebase.numer)
+
+        let timing = InputPipelineThread.Timing(periodNs: intervalNs,
+                                                computationNs: min(intervalNs / 4, 200_000),
+                                                constraintNs: intervalNs)
+        if !InputPipelineThread.setRealtimePolicy(timing) {
+            print("Warning: could not set real-time policy for \(name)")
+        }
+
+        var deadline = mach_absolute_time() + intervalTicks
+        while true {
+            mach_wait_until(deadline)
+
+            stateLock.lock()
+            let cancelled = isCancelled
+            stateLock.unlock()
+            if cancelled {
+                break
+            }
+
+            tick()
+
+            if let idle = idle, idle.clockTick() {
+                // Nothing is collected while input is quiet; sleep until the
+                // next state change, with the odd tick as a safety net
+                _ = wakeup.wait(timeout: .now() + .nanoseconds(Int(idle.idleIntervalNs)))
+                deadline = mach_absolute_time()
+                continue
+            }
+
+            deadline += intervalTicks
+            let now = mach_absolute_time()
+            if deadline <= now {
+                deadline = now + intervalTicks
+            }
+        }
+
+        exited.signal()
+    }
+}
@@ -0,0 +1,93 @@
+//
+//  InputReplay.swift
+//  BigbenController
+//
+//  Feeds a recorded input session (see USBControllerReader.recordingPath)
+//  through the same translation path as live reports, for reproducible
+//  benchmarks and bug reports without hardware
+//
+
+import Foundation
+import CUSBController
+
+// MARK: - Input Replayer
+
+final class InputReplayer {
+
+    enum Pacing {
+        /// Reproduce the recorded gaps between reports
+        case originalTiming
+        /// Deliver back to back, for throughput measurements
+        case asFastAsPossible
+    }
+
+    /// Called on the replay thread for each report that changes the state,
+    /// with the mach time the report was delivered
+    var onStateChanged: ((ControllerState, UInt64) -> Void)?
+
+    let vendorID: UInt16
+    let productID: UInt16
+    let frameCount: Int
+
+    /// Duration of the recording, from its first to its last report
+    var recordedDurationNs: UInt64 {
+        guard frameCount > 1, let frames = bigben_replay_frames(replay) else { return 0 }
+        return frames[frameCount - 1].timestamp_ns - frames[0].timestamp_ns
+    }
+
+    private let replay: OpaquePointer
+    private var currentState = ControllerState()
+
+    init?(path: String) {
+        guard let replay = bigben_replay_open(path) else { return nil }
+        self.replay = replay
+
+        let header = bigben_replay_header(replay)!.pointee
+        vendorID = header.vendor_id
+        productID = header.product_id
+        frameCount = bigben_replay_frame_count(replay)
+    }
+
+    deinit {
+        bigben_replay_close(replay)
+    }
+
+    /// Replay the whole recording on the calling thread
+    /// - Returns: Reports delivered and the wall time taken
+    @discardableResult
+    func run(pacing: Pacing) -> (frames: Int, elapsedNs: UInt64) {
+        currentState = ControllerState()
+
+        let context = Unmanaged.passUnretained(self).toOpaque()
+        let mode: BigbenReplayPacing = (pacing == .originalTiming)
+            ? BIGBEN_REPLAY_ORIGINAL_TIMING
+            : BIGBEN_REPLAY_AS_FAST_AS_POSSIBLE
+
+        var elapsed: UInt64 = 0
+        let delivered = bigben_replay_run(replay, mode, { report, timestamp, context in
+            guard let report = report, let context = context else { return }
+            let replayer = Unmanaged<InputReplayer>.fromOpaque(context).takeUnretainedValue()
+            replayer.handleReport(report.pointee, timestamp: timestamp)
+        }, context, &elapsed)
+
+        return (delivered, elapsed)
+    }
+
+    /// Stop a run in progress after the current report; safe from any thread
+    func cancel() {
+        bigben_replay_cancel(replay)
+    }
+
+    // Same stages as USBControllerReader.handleReport
+    private func handleReport(_ report: BigbenInputReport, timestamp: UInt64) {
+        bigben_latency_record(BIGBEN_STAGE_DRAIN, timestamp)
+
+        let newState = ControllerState.from(report: report)
+        bigben_latency_record(BIGBEN_STAGE_TRANSLATE, timestamp)
+
+        if newState != currentState {
+            currentState = newState
+            onStateChanged?(newState, timestamp)
+        }
+    }
+}
@@ -10,6 +10,7 @@ import Foundation
 import CoreGraphics
 import AppKit
 import CoreVideo
+import CUSBController
 
 // MARK: - Key Mapping Configuration
 
@@ -114,32 +115,457 @@ extension CGKeyCode {
     static let mouseMiddle: UInt16 = 0xF2
 }
 
+// MARK: - Compiled Key Mapping
+
+/// KeyMapping flattened for the report path: one slot per input bit, each
+/// holding up to two key codes (0 = unused). Bits 0-15 are the XInput
+/// `BTN_*` masks; the bits above them are inputs derived from analog values.
+struct CompiledKeyMapping {
+    static let leftTriggerBit: UInt32 = 1 << 16
+    static let rightTriggerBit: UInt32 = 1 << 17
+    static let moveForwardBit: UInt32 = 1 << 18
+    static let moveBackwardBit: UInt32 = 1 << 19
+    static let moveLeftBit: UInt32 = 1 << 20
+    static let moveRightBit: UInt32 = 1 << 21
+
+    static let inputCount = 22
+    static let keysPerInput = 2
+
+    private(set) var keys = [UInt16](repeating: 0, count: inputCount * keysPerInput)
+
+    init(_ mapping: KeyMapping) {
+        assign(UInt32(BTN_A), mapping.buttonA, CGKeyCode.returnKey)  // Cross also presses Enter (accept)
+        assign(UInt32(BTN_B), mapping.buttonB)
+        assign(UInt32(BTN_X), mapping.buttonX, CGKeyCode.keyF)       // Square also presses F (Action)
+        assign(UInt32(BTN_Y), mapping.buttonY)
+        assign(UInt32(BTN_LEFT_BUMPER), mapping.buttonLB)
+        assign(UInt32(BTN_RIGHT_BUMPER), mapping.buttonRB)
+        assign(UInt32(BTN_BACK), mapping.buttonBack)
+        assign(UInt32(BTN_START), mapping.buttonStart)
+        assign(UInt32(BTN_LEFT_THUMB), mapping.buttonL3)
+        assign(UInt32(BTN_RIGHT_THUMB), mapping.buttonR3)
+        assign(UInt32(BTN_GUIDE), mapping.buttonHome)
+
+        assign(UInt32(BTN_DPAD_UP), mapping.dpadUp)
+        assign(UInt32(BTN_DPAD_DOWN), mapping.dpadDown)
+        assign(UInt32(BTN_DPAD_LEFT), mapping.dpadLeft)
+        assign(UInt32(BTN_DPAD_RIGHT), mapping.dpadRight)
+
+        assign(CompiledKeyMapping.leftTriggerBit, mapping.buttonLT)
+        assign(CompiledKeyMapping.rightTriggerBit, mapping.buttonRT)
+
+        assign(CompiledKeyMapping.moveForwardBit, mapping.moveForward)
+        assign(CompiledKeyMapping.moveBackwardBit, mapping.moveBackward)
+        assign(CompiledKeyMapping.moveLeftBit, mapping.moveLeft)
+        assign(CompiledKeyMapping.moveRightBit, mapping.moveRight)
+    }
+
+    private mutating func assign(_ bit: UInt32, _ first: UInt16, _ second: UInt16 = 0) {
+        let slot = bit.trailingZeroBitCount * CompiledKeyMapping.keysPerInput
+        keys[slot] = first
+        keys[slot + 1] = second
+    }
+}
+
+// MARK: - Compiled Profile
+
+/// Everything the report path reads from a KeyMapping, computed once when
+/// the mapping is set and never changed afterwards, so the pipeline thread
+/// can use it while another thread publishes a replacement
+final class CompiledProfile {
+    let keys: CompiledKeyMapping
+
+    // Right stick: radial deadzones and response curve in raw int16 units,
+    // then pixels per Q15 unit of shaped deflection
+    let rightStickShape: BigbenStickShape
+    let mouseScale: Double
+    let smoothingFactor: Double
+
+    // Left stick deflection that counts as a movement key press
+    let moveThreshold: Int32
+
+    init(_ mapping: KeyMapping) {
+        let one = Double(BIGBEN_STICK_ONE)
+        let inner = Int32(max(0, min(1, mapping.mouseDeadzone)) * one)
+        let outer = Int32(max(0, min(1, mapping.mouseOuterDeadzone)) * one)
+
+        var shape = BigbenStickShape()
+        BigbenStickShapeInit(&shape, inner, outer, BIGBEN_DEADZONE_SCALED_RADIAL, BIGBEN_STICK_CURVE_MULTISTAGE)
+
+        keys = CompiledKeyMapping(mapping)
+        rightStickShape = shape
+        mouseScale = mapping.mouseSensitivity / one
+        smoothingFactor = 0.25  // Light smoothing to reduce jitter (0.0 = none, 0.3 = heavy)
+        moveThreshold = inner
+    }
+}
+
+// MARK: - Key Bitset
+
+/// Pressed state for key codes 0-255; codes outside that range are never
+/// tracked. Mouse buttons are kept in their own mask.
+struct KeyBitset {
+    private var words: (UInt64, UInt64, UInt64, UInt64) = (0, 0, 0, 0)
+
+    func contains(_ code: UInt16) -> Bool {
+        guard code < 256 else { return false }
+        let bit = UInt64(1) << UInt64(code & 63)
+        switch code >> 6 {
+        case 0: return words.0 & bit != 0
+        case 1: return words.1 & bit != 0
+        case 2: return words.2 & bit != 0
+        default: return words.3 & bit != 0
+        }
+    }
+
+    /// - Returns: false if the code was already set or is out of range
+    @discardableResult
+    mutating func insert(_ code: UInt16) -> Bool {
+        guard code < 256, !contains(code) else { return false }
+        let bit = UInt64(1) << UInt64(code & 63)
+        switch code >> 6 {
+        case 0: words.0 |= bit
+        case 1: words.1 |= bit
+        case 2: words.2 |= bit
+        default: words.3 |= bit
+        }
+        return true
+    }
+
+    /// - Returns: false if the code was not set
+    @discardableResult
+    mutating func remove(_ code: UInt16) -> Bool {
+        guard contains(code) else { return false }
+        let mask = ~(UInt64(1) << UInt64(code & 63))
+        switch code >> 6 {
+        case 0: words.0 &= mask
+        case 1: words.1 &= mask
+        case 2: words.2 &= mask
+        default: words.3 &= mask
+        }
+        return true
+    }
+
+    mutating func removeAll() {
+        words = (0, 0, 0, 0)
+    }
+
+    /// Calls `body` for each set code in ascending order
+    func forEach(_ body: (UInt16) -> Void) {
+        for (index, word) in [words.0, words.1, words.2, words.3].enumerated() {
+            var remaining = word
+            while remaining != 0 {
+                body(UInt16(index * 64 + remaining.trailingZeroBitCount))
+                remaining &= remaining - 1
+            }
+        }
+    }
+}
+
+// MARK: - Mouse Output Mode
+
+enum MouseOutputMode {
+    /// Warp to the read-back cursor position plus the delta each move
+    case absolute
+    /// Post moves carrying the delta fields from a locally tracked cursor;
+    /// sub-pixel remainders carry over to the next move
+    case relative
+}
+
+// MARK: - Mouse Output Clock
+
+enum MouseOutputClock: Equatable {
+    /// Post each move as soon as its report is processed (lowest latency)
+    case immediate
+    /// Collect moves and post once per display refresh (smoothest)
+    case vsync
+    /// Collect moves and post on a fixed-rate real-time timer
+    case fixedRate(hz: Double)
+}
+
+// MARK: - Display Reconfiguration
+
+// One function pointer for both registering and removing the callback
+private let displayReconfigurationCallback: CGDisplayReconfigurationCallBack = { _, flags, context in
+    guard let context = context, !flags.contains(.beginConfigurationFlag) else { return }
+    let emulator = Unmanaged<KeyboardEmulator>.fromOpaque(context).takeUnretainedValue()
+    emulator.refreshDisplayBounds()
+}
+
 // MARK: - Keyboard Emulator
 
 class KeyboardEmulator {
 
-    var mapping = KeyMapping.default
+    /// Compiled when set and swapped in for the next report; an app mapping
+    /// for the frontmost app takes precedence. Set mappings on the main
+    /// thread, where app activation is handled too.
+    var mapping = KeyMapping.default {
+        didSet {
+            baseProfile = CompiledProfile(mapping)
+            publishProfile(forApp: frontmostBundleID)
+        }
+    }
+
+    /// Mappings used while an app is frontmost, by bundle identifier.
+    /// Compiled when set, so switching on focus change is a pointer swap.
+    var appMappings: [String: KeyMapping] = [:] {
+        didSet {
+            appProfiles = appMappings.mapValues { CompiledProfile($0) }
+            observeFrontmostApp(!appMappings.isEmpty)
+            publishProfile(forApp: frontmostBundleID)
+        }
+    }
     var isEnabled = true
 
-    private var pressedKeys = Set<UInt16>()
-    private var mouseButtonsPressed = Set<UInt16>()
-    private var lastState = ControllerState()
+    /// When false every stage up to posting still runs, but no event reaches
+    /// the system; for benchmarking replays
+    var postsEvents = true
+    var mouseOutputMode = MouseOutputMode.relative
+
+    /// When mouse moves are posted. Set before input starts: in the
+    /// collecting modes the cursor state belongs to the output thread.
+    var mouseOutputClock = MouseOutputClock.immediate {
+        didSet {
+            if mouseOutputClock != oldValue {
+                applyOutputClock()
+            }
+        }
+    }
+
+    /// The vsync and fixed-rate output clocks back off after this long
+    /// without a state change and return to full rate on the next one
+    /// (0 keeps them at full rate)
+    var idleTimeout: TimeInterval = 2.0 {
+        didSet {
+            idleBackoff.idleAfterNs = UInt64(max(0, idleTimeout) * 1_000_000_000)
+        }
+    }
+
+    /// Output clock wakeups per second and idle residency since the last call
+    func takeOutputClockStats() -> IdleBackoff.Stats {
+        return idleBackoff.takeStats()
+    }
 
-    // VSync-aligned mouse movement via CVDisplayLink
+    // Profiles are published to the pipeline thread through `profiles`:
+    // `activeProfile` is the one it is using and is only touched there; the
+    // rest belongs to the main thread. Replaced profiles are kept alive
+    // until the pipeline thread has let go of them.
+    private let profiles = bigben_published_create()
+    private unowned(unsafe) var activeProfile: CompiledProfile
+    private var baseProfile: CompiledProfile
+    private var appProfiles: [String: CompiledProfile] = [:]
+    private var publishedProfile: CompiledProfile
+    private var retiredProfiles: [CompiledProfile] = []
+    private var frontmostBundleID: String?
+    private var activationObserver: NSObjectProtocol?
+
+    private var pressedKeys = KeyBitset()
+    private var mouseButtons: UInt32 = 0  // leftButtonBit etc.
+    private var lastInputs: UInt32 = 0    // Button word plus derived input bits
+
+    // USB completion time of the report being processed, for latency stats
+    private var stateTimestamp: UInt64 = 0
+
+    // Key and button transitions for the current report, posted in one pass
+    private struct QueuedEvent {
+        let code: UInt16
+        let isDown: Bool
+    }
+    private static let maxBatchedEvents = 32
+    private var eventBatch: [QueuedEvent] = {
+        var batch = [QueuedEvent]()
+        batch.reserveCapacity(KeyboardEmulator.maxBatchedEvents)
+        return batch
+    }()
+
+    // Every synthesized event comes from one source, and event objects are
+    // created once and re-stamped instead of allocated per transition.
+    // Key and button templates belong to the pipeline thread, move templates
+    // to whichever thread posts moves.
+    private let eventSource = CGEventSource(stateID: .hidSystemState)
+    private var keyEvents = [CGEvent?](repeating: nil, count: 256)        // key code * 2 + down
+    private var mouseButtonEvents = [CGEvent?](repeating: nil, count: 6)  // button * 2 + down
+    private var mouseMoveEvents: [CGEventType: CGEvent] = [:]
+    private var postedModifierFlags: CGEventFlags = []
+
+    // Collected mouse movement, handed to the output clock without locks
+    private let pendingDelta = bigben_delta_create()
     private var displayLink: CVDisplayLink?
-    private var pendingDeltaX: Double = 0
-    private var pendingDeltaY: Double = 0
-    private let mouseLock = NSLock()
+    private var fixedRateClock: FixedRateClock?
+
+    // A backed-off display link is stopped rather than left firing; starts
+    // and stops are serialized here so a late stop never wins over a wake
+    private let idleBackoff = IdleBackoff(idleAfterNs: 2_000_000_000, idleIntervalNs: 250_000_000)
+    private let displayLinkControl = DispatchQueue(label: "com.bigben.display-link", qos: .userInteractive)
+
+    // Display bounds in global (top-left origin) coordinates, refreshed on
+    // display reconfiguration so moves never query AppKit or the window server
+    private let displayLock: UnsafeMutablePointer<os_unfair_lock> = {
+        let lock = UnsafeMutablePointer<os_unfair_lock>.allocate(capacity: 1)
+        lock.initialize(to: os_unfair_lock())
+        return lock
+    }()
+    private var displayBounds: [CGRect] = []
+
+    // Relative mode: the cursor is tracked here and only read back after the
+    // stick has been idle, in case the real mouse moved it meanwhile
+    private var trackedCursor = CGPoint.zero
+    private var isCursorTracked = false
+    private var lastMouseMoveTime: UInt64 = 0
+    private var subpixelX: Double = 0
+    private var subpixelY: Double = 0
+    private static let cursorResyncIntervalNs: UInt64 = 100_000_000
 
-    // Light smoothing to reduce jitter (0.0 = none, 0.3 = heavy)
-    private let smoothingFactor: Double = 0.25
     private var smoothX: Double = 0
     private var smoothY: Double = 0
 
     // MARK: - Initialization
 
     init() {
-        setupDisplayLink()
+        let profile = CompiledProfile(KeyMapping.default)
+        baseProfile = profile
+        publishedProfile = profile
+        activeProfile = profile
+        bigben_published_swap(profiles, Unmanaged.passUnretained(profile).toOpaque())
+
+        // Move templates are made up front so the output thread never
+        // mutates the shared dictionary
+        for type in [CGEventType.mouseMoved, .leftMouseDragged, .rightMouseDragged, .otherMouseDragged] {
+            mouseMoveEvents[type] = CGEvent(mouseEventSource: eventSource, mouseType: type,
+                                            mouseCursorPosition: .zero, mouseButton: .left)
+        }
+
+        refreshDisplayBounds()
+        CGDisplayRegisterReconfigurationCallback(displayReconfigurationCallback, Unmanaged.passUnretained(self).toOpaque())
+
+        applyOutputClock()
+    }
+
+    // MARK: - Profiles
+
+    // Off the report path: swap in the profile for `bundleID` and drop the
+    // replaced ones the pipeline thread is no longer using
+    private func publishProfile(forApp bundleID: String?) {
+        let profile = bundleID.flatMap { appProfiles[$0] } ?? baseProfile
+        guard profile !== publishedProfile else { return }
+
+        retiredProfiles.append(publishedProfile)
+        publishedProfile = profile
+        bigben_published_swap(profiles, Unmanaged.passUnretained(profile).toOpaque())
+
+        retiredProfiles.removeAll { retired in
+            !bigben_published_in_use(profiles, Unmanaged.passUnretained(retired).toOpaque())
+        }
+    }
+
+    private func observeFrontmostApp(_ observe: Bool) {
+        if !observe {
+            if let observer = activationObserver {
+                NSWorkspace.shared.notificationCenter.removeObserver(observer)
+            }
+            activationObserver = nil
+            frontmostBundleID = nil
+            return
+        }
+
+        frontmostBundleID = NSWorkspace.shared.frontmostApplication?.bundleIdentifier
+        guard activationObserver == nil else { return }
+
+        activationObserver = NSWorkspace.shared.notificationCenter.addObserver(
+            forName: NSWorkspace.didActivateApplicationNotification, object: nil, queue: .main
+        ) { [unowned self] notification in
+            let app = notification.userInfo?[NSWorkspace.applicationUserInfoKey] as? NSRunningApplication
+            self.frontmostBundleID = app?.bundleIdentifier
+            self.publishProfile(forApp: self.frontmostBundleID)
+        }
+    }
+
+    // Pipeline thread, once per report: pick up a newly published profile.
+    // Held inputs are released under the old bindings and pressed again
+    // under the new ones, so no key stays down across a switch.
+    private func refreshActiveProfile() {
+        guard let raw = bigben_published_acquire(profiles) else { return }
+        let profile = Unmanaged<CompiledProfile>.fromOpaque(raw).takeUnretainedValue()
+        guard profile !== activeProfile else { return }
+
+        activeProfile = profile
+        queueReleaseOfHeldInputs()
+        lastInputs = 0
+    }
+
+    // MARK: - Screen Geometry
+
+    fileprivate func refreshDisplayBounds() {
+        var count: UInt32 = 0
+        CGGetActiveDisplayList(0, nil, &count)
+
+        var displays = [CGDirectDisplayID](repeating: 0, count: Int(count))
+        CGGetActiveDisplayList(count, &displays, &count)
+        let bounds = displays.prefix(Int(count)).map { CGDisplayBounds($0) }
+
+        os_unfair_lock_lock(displayLock)
+        displayBounds = bounds.isEmpty ? [CGDisplayBounds(CGMainDisplayID())] : bounds
+        os_unfair_lock_unlock(displayLock)
+    }
+
+    // Keep the cursor on screen: a point on any display is fine, otherwise
+    // clamp it to the display the cursor is leaving
+    private func clampToDisplays(_ point: CGPoint, from origin: CGPoint) -> CGPoint {
+        os_unfair_lock_lock(displayLock)
+        let bounds = displayBounds
+        os_unfair_lock_unlock(displayLock)
+
+        if bounds.contains(where: { $0.contains(point) }) {
+            return point
+        }
+
+        let display = bounds.first(where: { $0.contains(origin) }) ?? bounds.first ?? .zero
+        return CGPoint(x: max(display.minX, min(display.maxX - 1, point.x)),
+                       y: max(display.minY, min(display.maxY - 1, point.y)))
+    }
+
+    // Current cursor in global coordinates, without going through AppKit
+    private func cursorPosition() -> CGPoint {
+        return CGEvent(source: nil)?.location ?? .zero
+    }
+
+    // MARK: - Output Clock
+
+    private func applyOutputClock() {
+        stopOutputClock()
+
+        switch mouseOutputClock {
+        case .immediate:
+            break
+        case .vsync:
+            setupDisplayLink()
+            if displayLink == nil {
+                mouseOutputClock = .immediate
+            }
+        case .fixedRate(let hz):
+            let clock = FixedRateClock(name: "com.bigben.mouse-clock", hz: hz, idle: idleBackoff) { [unowned self] in
+                self.flushMouseMovement()
+            }
+            clock.start()
+            fixedRateClock = clock
+        }
+    }
+
+    private func stopOutputClock() {
+        // Taken away on the control queue, so no queued start revives it
+        let link: CVDisplayLink? = displayLinkControl.sync {
+            defer { displayLink = nil }
+            return displayLink
+        }
+        if let link = link {
+            CVDisplayLinkStop(link)
+        }
+
+        fixedRateClock?.stop()
+        fixedRateClock = nil
+
+        // Nothing collected under the old clock is lost
+        flushMouseMovement()
     }
 
     private func setupDisplayLink() {
@@ -158,6 +584,9 @@ class KeyboardEmulator {
             guard let context = context else { return kCVReturnSuccess }
             let emulator = Unmanaged<KeyboardEmulator>.fromOpaque(context).takeUnretainedValue()
             emulator.flushMouseMovement()
+            if emulator.idleBackoff.clockTick() {
+                emulator.parkDisplayLink()
+            }
             return kCVReturnSuccess
         }
 
@@ -166,335 +595,457 @@ class KeyboardEmulator {
         CVDisplayLinkStart(link)
     }
 
-    // Called at VSync rate to flush accumulated mouse movement
+    // Stopping the link from its own callback can deadlock, so it is done
+    // from the control queue, and only if no state change came in meanwhile
+    private func parkDisplayLink() {
+        displayLinkControl.async { [unowned self] in
+            guard let link = self.displayLink, CVDisplayLinkIsRunning(link),
+                  self.idleBackoff.isBackedOff else { return }
+            CVDisplayLinkStop(link)
+        }
+    }
+
+    // Back to full rate on the first state change after backing off
+    private func resumeOutputClock() {
+        fixedRateClock?.wake()
+        displayLinkControl.async { [unowned self] in
+            guard let link = self.displayLink, !CVDisplayLinkIsRunning(link) else { return }
+            CVDisplayLinkStart(link)
+        }
+    }
+
+    // Called on the output clock to flush accumulated mouse movement
     private func flushMouseMovement() {
-        mouseLock.lock()
-        let deltaX = pendingDeltaX
-        let deltaY = pendingDeltaY
-        pendingDeltaX = 0
-        pendingDeltaY = 0
-        mouseLock.unlock()
+        var deltaX: Double = 0
+        var deltaY: Double = 0
+        var timestamp: UInt64 = 0
+        guard bigben_delta_take(pendingDelta, &deltaX, &deltaY, &timestamp) else { return }
 
-        guard abs(deltaX) > 0.1 || abs(deltaY) > 0.1 else { return }
+        // Relative mode keeps fractions in its sub-pixel remainder instead
+        guard mouseOutputMode == .relative || abs(deltaX) > 0.1 || abs(deltaY) > 0.1 else { return }
 
         // Use delta-based mouse movement via CGEventPost for smooth, low-latency movement
-        postMouseMovement(deltaX: deltaX, deltaY: deltaY)
+        postMouseMovement(deltaX: deltaX, deltaY: deltaY, timestamp: timestamp)
+    }
+
+    // Post now or leave for the output clock
+    private func emitMouseMovement(deltaX: Double, deltaY: Double) {
+        if mouseOutputClock == .immediate {
+            postMouseMovement(deltaX: deltaX, deltaY: deltaY, timestamp: stateTimestamp)
+        } else {
+            bigben_delta_add(pendingDelta, deltaX, deltaY, stateTimestamp)
+        }
     }
 
     // Post mouse movement
-    private func postMouseMovement(deltaX: Double, deltaY: Double) {
-        let mouseLocation = NSEvent.mouseLocation
-        let screenHeight = NSScreen.main?.frame.height ?? 1080
-        let screenWidth = NSScreen.main?.frame.width ?? 1920
+    private func postMouseMovement(deltaX: Double, deltaY: Double, timestamp: UInt64) {
+        switch mouseOutputMode {
+        case .absolute:
+            postAbsoluteMouseMovement(deltaX: deltaX, deltaY: deltaY, timestamp: timestamp)
+        case .relative:
+            postRelativeMouseMovement(deltaX: deltaX, deltaY: deltaY, timestamp: timestamp)
+        }
+    }
+
+    private func postAbsoluteMouseMovement(deltaX: Double, deltaY: Double, timestamp: UInt64) {
+        let location = cursorPosition()
 
         // Calculate new position
-        let cgY = screenHeight - mouseLocation.y
-        let newX = max(0, min(screenWidth, mouseLocation.x + deltaX))
-        let newY = max(0, min(screenHeight, cgY + deltaY))
-        let newPoint = CGPoint(x: newX, y: newY)
+        let newPoint = clampToDisplays(CGPoint(x: location.x + deltaX, y: location.y + deltaY),
+                                       from: location)
 
         // Move cursor
-        CGWarpMouseCursorPosition(newPoint)
+        if postsEvents {
+            CGWarpMouseCursorPosition(newPoint)
+        }
 
         // Also post a mouse moved event so games see it
-        if let event = CGEvent(mouseEventSource: nil, mouseType: .mouseMoved, mouseCursorPosition: newPoint, mouseButton: .left) {
-            event.post(tap: .cghidEventTap)
+        if let event = mouseMoveEvents[.mouseMoved] {
+            event.location = newPoint
+            event.timestamp = KeyboardEmulator.eventTimestamp()
+            if postsEvents {
+                event.post(tap: .cghidEventTap)
+            }
+            bigben_latency_record(BIGBEN_STAGE_POST, timestamp)
         }
     }
 
-    // MARK: - Process Controller State
-
-    func processState(_ state: ControllerState) {
-        guard isEnabled else { return }
-
-        // Handle buttons
-        processButton(state.buttonA, lastState.buttonA, mapping.buttonA)
-        processButton(state.buttonA, lastState.buttonA, CGKeyCode.returnKey)  // Cross also presses Enter (accept)
-        processButton(state.buttonB, lastState.buttonB, mapping.buttonB)
-        processButton(state.buttonX, lastState.buttonX, mapping.buttonX)
-        processButton(state.buttonX, lastState.buttonX, CGKeyCode.keyF)       // Square also presses F (Action)
-        processButton(state.buttonY, lastState.buttonY, mapping.buttonY)
-        processButton(state.buttonLB, lastState.buttonLB, mapping.buttonLB)
-        processButton(state.buttonRB, lastState.buttonRB, mapping.buttonRB)
-        processButton(state.buttonLT, lastState.buttonLT, mapping.buttonLT)
-        processButton(state.buttonRT, lastState.buttonRT, mapping.buttonRT)
-        processButton(state.buttonBack, lastState.buttonBack, mapping.buttonBack)
-        processButton(state.buttonStart, lastState.buttonStart, mapping.buttonStart)
-        processButton(state.buttonL3, lastState.buttonL3, mapping.buttonL3)
-        processButton(state.buttonR3, lastState.buttonR3, mapping.buttonR3)
-        processButton(state.buttonHome, lastState.buttonHome, mapping.buttonHome)
-
-        // Handle D-pad
-        processButton(state.dpadUp, lastState.dpadUp, mapping.dpadUp)
-        processButton(state.dpadDown, lastState.dpadDown, mapping.dpadDown)
-        processButton(state.dpadLeft, lastState.dpadLeft, mapping.dpadLeft)
-        processButton(state.dpadRight, lastState.dpadRight, mapping.dpadRight)
-
-        // Handle left stick (WASD movement)
-        processLeftStick(state)
+    private func postRelativeMouseMovement(deltaX: Double, deltaY: Double, timestamp: UInt64) {
+        // Whole pixels go out now, the fraction waits for the next move
+        let totalX = deltaX + subpixelX
+        let totalY = deltaY + subpixelY
+        let stepX = totalX.rounded(.towardZero)
+        let stepY = totalY.rounded(.towardZero)
+        subpixelX = totalX - stepX
+        subpixelY = totalY - stepY
+        guard stepX != 0 || stepY != 0 else { return }
+
+        let origin = pointerLocation()
+        lastMouseMoveTime = mach_absolute_time()
+
+        // Games reading the delta fields still see the full motion when the
+        // cursor is pinned at a screen edge
+        let newPoint = clampToDisplays(CGPoint(x: origin.x + stepX, y: origin.y + stepY), from: origin)
+        trackedCursor = newPoint
+
+        if let event = mouseMoveEvents[mouseMoveType()] {
+            event.location = newPoint
+            event.timestamp = KeyboardEmulator.eventTimestamp()
+            event.setIntegerValueField(.mouseEventDeltaX, value: Int64(stepX))
+            event.setIntegerValueField(.mouseEventDeltaY, value: Int64(stepY))
+            if postsEvents {
+                event.post(tap: .cghidEventTap)
+            }
+            bigben_latency_record(BIGBEN_STAGE_POST, timestamp)
+        }
+    }
 
-        // Handle right stick (mouse look)
-        processRightStick(state)
+    // Cursor position for the next event: tracked in relative mode, re-read
+    // only after the stick has been idle for a while
+    private func pointerLocation() -> CGPoint {
+        guard mouseOutputMode == .relative else { return cursorPosition() }
 
-        lastState = state
+        let idle = bigben_ticks_to_ns(mach_absolute_time() &- lastMouseMoveTime)
+        if !isCursorTracked || idle > KeyboardEmulator.cursorResyncIntervalNs {
+            trackedCursor = cursorPosition()
+            isCursorTracked = true
+        }
+        return trackedCursor
     }
 
-    // MARK: - Button Processing
+    // Moves with a button held are drags
+    // Reads the published mask, since moves may be posted by the output clock
+    private func mouseMoveType() -> CGEventType {
+        let held = bigben_delta_buttons(pendingDelta)
+        if held & KeyboardEmulator.leftButtonBit != 0 {
+            return .leftMouseDragged
+        }
+        if held & KeyboardEmulator.rightButtonBit != 0 {
+            return .rightMouseDragged
+        }
+        if held & KeyboardEmulator.middleButtonBit != 0 {
+            return .otherMouseDragged
+        }
+        return .mouseMoved
+    }
 
-    private func processButton(_ current: Bool, _ previous: Bool, _ keyCode: UInt16) {
-        guard keyCode != 0 else { return }
+    private static let leftButtonBit: UInt32 = 1 << 0
+    private static let rightButtonBit: UInt32 = 1 << 1
+    private static let middleButtonBit: UInt32 = 1 << 2
 
-        if current && !previous {
-            pressKey(keyCode)
-        } else if !current && previous {
-            releaseKey(keyCode)
+    private static func mouseButtonBit(_ button: UInt16) -> UInt32 {
+        switch button {
+        case CGKeyCode.mouseLeft: return leftButtonBit
+        case CGKeyCode.mouseRight: return rightButtonBit
+        case CGKeyCode.mouseMiddle: return middleButtonBit
+        default: return 0
         }
     }
 
-    private func pressKey(_ keyCode: UInt16) {
-        // Handle mouse buttons separately
-        if keyCode >= CGKeyCode.mouseLeft {
-            pressMouseButton(keyCode)
-            return
-        }
+    private func publishMouseButtons() {
+        bigben_delta_set_buttons(pendingDelta, mouseButtons)
+    }
 
-        guard !pressedKeys.contains(keyCode) else { return }
-        pressedKeys.insert(keyCode)
+    // Where button events happen; the tracked cursor is only ours to read
+    // when moves are posted on this thread
+    private func buttonEventLocation() -> CGPoint {
+        return mouseOutputClock == .immediate ? pointerLocation() : cursorPosition()
+    }
 
-        if let event = CGEvent(keyboardEventSource: nil, virtualKey: keyCode, keyDown: true) {
-            event.post(tap: .cghidEventTap)
-        }
+    // Reused events keep their creation time unless re-stamped; CGEvent
+    // timestamps are nanoseconds since startup
+    private static func eventTimestamp() -> CGEventTimestamp {
+        return CGEventTimestamp(clock_gettime_nsec_np(CLOCK_UPTIME_RAW))
     }
 
-    private func releaseKey(_ keyCode: UInt16) {
-        // Handle mouse buttons separately
-        if keyCode >= CGKeyCode.mouseLeft {
-            releaseMouseButton(keyCode)
-            return
+    // MARK: - Event Batch
+
+    private func queueEvent(_ code: UInt16, isDown: Bool) {
+        if eventBatch.count == KeyboardEmulator.maxBatchedEvents {
+            postEventBatch()
         }
+        eventBatch.append(QueuedEvent(code: code, isDown: isDown))
+    }
 
-        guard pressedKeys.contains(keyCode) else { return }
-        pressedKeys.remove(keyCode)
+    // Post the transitions collected for this report in one pass
+    private func postEventBatch() {
+        guard !eventBatch.isEmpty else { return }
+
+        let now = KeyboardEmulator.eventTimestamp()
+        var buttonLocation: CGPoint?
+
+        for queued in eventBatch {
+            let event: CGEvent
+            if queued.code >= CGKeyCode.mouseLeft {
+                guard let buttonEvent = mouseButtonEvent(queued.code, isDown: queued.isDown) else { continue }
+                // One cursor lookup covers every click in the batch
+                let location = buttonLocation ?? buttonEventLocation()
+                buttonLocation = location
+                buttonEvent.location = location
+                event = buttonEvent
+            } else {
+                guard let keyEvent = keyEvent(queued.code, isDown: queued.isDown) else { continue }
+                updateModifierFlags(queued)
+                keyEvent.flags = postedModifierFlags
+                event = keyEvent
+            }
 
-        if let event = CGEvent(keyboardEventSource: nil, virtualKey: keyCode, keyDown: false) {
-            event.post(tap: .cghidEventTap)
+            event.timestamp = now
+            if postsEvents {
+                event.post(tap: .cghidEventTap)
+            }
+            bigben_latency_record(BIGBEN_STAGE_POST, stateTimestamp)
         }
-    }
 
-    // MARK: - Mouse Button Processing
+        eventBatch.removeAll(keepingCapacity: true)
+    }
 
-    private func pressMouseButton(_ button: UInt16) {
-        guard !mouseButtonsPressed.contains(button) else { return }
-        mouseButtonsPressed.insert(button)
+    private func keyEvent(_ keyCode: UInt16, isDown: Bool) -> CGEvent? {
+        let index = Int(keyCode) * 2 + (isDown ? 1 : 0)
+        guard index < keyEvents.count else {
+            return CGEvent(keyboardEventSource: eventSource, virtualKey: keyCode, keyDown: isDown)
+        }
 
-        let mouseLocation = NSEvent.mouseLocation
-        let screenHeight = NSScreen.main?.frame.height ?? 1080
-        let point = CGPoint(x: mouseLocation.x, y: screenHeight - mouseLocation.y)
+        if let event = keyEvents[index] {
+            return event
+        }
+        let event = CGEvent(keyboardEventSource: eventSource, virtualKey: keyCode, keyDown: isDown)
+        keyEvents[index] = event
+        return event
+    }
 
+    private func mouseButtonEvent(_ button: UInt16, isDown: Bool) -> CGEvent? {
         let buttonType: CGMouseButton
         let eventType: CGEventType
+        let slot: Int
 
         switch button {
         case CGKeyCode.mouseLeft:
             buttonType = .left
-            eventType = .leftMouseDown
+            eventType = isDown ? .leftMouseDown : .leftMouseUp
+            slot = 0
         case CGKeyCode.mouseRight:
             buttonType = .right
-            eventType = .rightMouseDown
+            eventType = isDown ? .rightMouseDown : .rightMouseUp
+            slot = 1
         case CGKeyCode.mouseMiddle:
             buttonType = .center
-            eventType = .otherMouseDown
+            eventType = isDown ? .otherMouseDown : .otherMouseUp
+            slot = 2
         default:
-            return
+            return nil
         }
 
-        if let event = CGEvent(mouseEventSource: nil, mouseType: eventType, mouseCursorPosition: point, mouseButton: buttonType) {
-            event.post(tap: .cghidEventTap)
+        let index = slot * 2 + (isDown ? 1 : 0)
+        if let event = mouseButtonEvents[index] {
+            return event
         }
+        let event = CGEvent(mouseEventSource: eventSource, mouseType: eventType,
+                            mouseCursorPosition: .zero, mouseButton: buttonType)
+        mouseButtonEvents[index] = event
+        return event
     }
 
-    private func releaseMouseButton(_ button: UInt16) {
-        guard mouseButtonsPressed.contains(button) else { return }
-        mouseButtonsPressed.remove(button)
+    // Key events carry the modifiers we hold, as a real keyboard's would
+    private func updateModifierFlags(_ queued: QueuedEvent) {
+        let flag: CGEventFlags
+        switch queued.code {
+        case CGKeyCode.leftShift: flag = .maskShift
+        case CGKeyCode.leftControl: flag = .maskControl
+        case CGKeyCode.leftAlt: flag = .maskAlternate
+        default: return
+        }
 
-        let mouseLocation = NSEvent.mouseLocation
-        let screenHeight = NSScreen.main?.frame.height ?? 1080
-        let point = CGPoint(x: mouseLocation.x, y: screenHeight - mouseLocation.y)
+        if queued.isDown {
+            postedModifierFlags.insert(flag)
+        } else {
+            postedModifierFlags.remove(flag)
+        }
+    }
 
-        let buttonType: CGMouseButton
-        let eventType: CGEventType
+    // MARK: - Process Controller State
 
-        switch button {
-        case CGKeyCode.mouseLeft:
-            buttonType = .left
-            eventType = .leftMouseUp
-        case CGKeyCode.mouseRight:
-            buttonType = .right
-            eventType = .rightMouseUp
-        case CGKeyCode.mouseMiddle:
-            buttonType = .center
-            eventType = .otherMouseUp
-        default:
+    /// - Parameter timestamp: USB completion time (mach ticks) of the report
+    ///   behind this state, or 0 if unknown
+    func processState(_ state: ControllerState, timestamp: UInt64 = 0) {
+        guard isEnabled else { return }
+        stateTimestamp = timestamp
+
+        // Only state changes get here, so this is the activity signal
+        if idleBackoff.noteActivity() {
+            resumeOutputClock()
+        }
+        refreshActiveProfile()
+
+        // Buttons, triggers and stick directions in one word; only the
+        // inputs that changed since the last report are visited
+        var inputs = UInt32(state.buttons)
+        if state.buttonLT { inputs |= CompiledKeyMapping.leftTriggerBit }
+        if state.buttonRT { inputs |= CompiledKeyMapping.rightTriggerBit }
+        inputs |= leftStickInputs(state)
+
+        var changed = inputs ^ lastInputs
+        lastInputs = inputs
+        while changed != 0 {
+            let index = changed.trailingZeroBitCount
+            changed &= changed - 1
+            processInput(index, isDown: inputs & (1 << UInt32(index)) != 0)
+        }
+
+        // Keys and clicks go out before this report's mouse movement
+        postEventBatch()
+
+        // Handle right stick (mouse look)
+        processRightStick(state)
+
+        bigben_latency_record(BIGBEN_STAGE_PROCESS, timestamp)
+    }
+
+    // MARK: - Button Processing
+
+    private func processInput(_ index: Int, isDown: Bool) {
+        let keys = activeProfile.keys.keys
+        let slot = index * CompiledKeyMapping.keysPerInput
+        guard slot < keys.count else { return }
+
+        for keyCode in keys[slot..<(slot + CompiledKeyMapping.keysPerInput)] where keyCode != 0 {
+            if isDown {
+                pressKey(keyCode)
+            } else {
+                releaseKey(keyCode)
+            }
+        }
+    }
+
+    private func pressKey(_ keyCode: UInt16) {
+        // Handle mouse buttons separately
+        if keyCode >= CGKeyCode.mouseLeft {
+            pressMouseButton(keyCode)
             return
         }
 
-        if let event = CGEvent(mouseEventSource: nil, mouseType: eventType, mouseCursorPosition: point, mouseButton: buttonType) {
-            event.post(tap: .cghidEventTap)
+        guard pressedKeys.insert(keyCode) else { return }
+        queueEvent(keyCode, isDown: true)
+    }
+
+    private func releaseKey(_ keyCode: UInt16) {
+        // Handle mouse buttons separately
+        if keyCode >= CGKeyCode.mouseLeft {
+            releaseMouseButton(keyCode)
+            return
         }
+
+        guard pressedKeys.remove(keyCode) else { return }
+        queueEvent(keyCode, isDown: false)
+    }
+
+    // MARK: - Mouse Button Processing
+
+    private func pressMouseButton(_ button: UInt16) {
+        let bit = KeyboardEmulator.mouseButtonBit(button)
+        guard bit != 0, mouseButtons & bit == 0 else { return }
+        mouseButtons |= bit
+        publishMouseButtons()
+        queueEvent(button, isDown: true)
+    }
+
+    private func releaseMouseButton(_ button: UInt16) {
+        let bit = KeyboardEmulator.mouseButtonBit(button)
+        guard mouseButtons & bit != 0 else { return }
+        mouseButtons &= ~bit
+        publishMouseButtons()
+        queueEvent(button, isDown: false)
     }
 
     // MARK: - Left Stick (Movement)
 
-    private func processLeftStick(_ state: ControllerState) {
-        let x = normalizeAxis(state.leftStickX)
-        let y = normalizeAxis(state.leftStickY)
+    // Stick directions as input bits, diffed with the buttons
+    private func leftStickInputs(_ state: ControllerState) -> UInt32 {
+        let x = Int32(state.leftStickX)
+        let y = Int32(state.leftStickY)
+        let moveThreshold = activeProfile.moveThreshold
+        var inputs: UInt32 = 0
 
         // Forward/backward (Y axis: positive = forward, negative = backward)
-        if y > mapping.mouseDeadzone {
-            pressKey(mapping.moveForward)
-        } else {
-            releaseKey(mapping.moveForward)
-        }
-
-        if y < -mapping.mouseDeadzone {
-            pressKey(mapping.moveBackward)
-        } else {
-            releaseKey(mapping.moveBackward)
-        }
+        if y > moveThreshold { inputs |= CompiledKeyMapping.moveForwardBit }
+        if y < -moveThreshold { inputs |= CompiledKeyMapping.moveBackwardBit }
 
         // Left/right
-        if x < -mapping.mouseDeadzone {
-            pressKey(mapping.moveLeft)
-        } else {
-            releaseKey(mapping.moveLeft)
-        }
+        if x < -moveThreshold { inputs |= CompiledKeyMapping.moveLeftBit }
+        if x > moveThreshold { inputs |= CompiledKeyMapping.moveRightBit }
 
-        if x > mapping.mouseDeadzone {
-            pressKey(mapping.moveRight)
-        } else {
-            releaseKey(mapping.moveRight)
-        }
+        return inputs
     }
 
     // MARK: - Right Stick (Mouse Look)
 
     private func processRightStick(_ state: ControllerState) {
-        let x = normalizeAxis(state.rightStickX)
-        let y = normalizeAxis(state.rightStickY)
-
-        // Apply dual deadzone (inner and outer)
-        let adjustedX = applyDualDeadzone(x, inner: mapping.mouseDeadzone, outer: mapping.mouseOuterDeadzone)
-        let adjustedY = applyDualDeadzone(y, inner: mapping.mouseDeadzone, outer: mapping.mouseOuterDeadzone)
-
-        // Apply multi-stage response curve for better control
-        let curvedX = applyMultiStageAcceleration(adjustedX)
-        let curvedY = applyMultiStageAcceleration(adjustedY)
+        // Radial dual deadzone and multi-stage response curve at full stick
+        // resolution, so fine aim near the center moves in small steps
+        let profile = activeProfile
+        var shapedX: Int32 = 0
+        var shapedY: Int32 = 0
+        withUnsafePointer(to: profile.rightStickShape) { shape in
+            BigbenStickApply(shape, Int32(state.rightStickX), Int32(state.rightStickY), &shapedX, &shapedY)
+        }
 
         // Calculate target mouse movement
-        let targetX = curvedX * mapping.mouseSensitivity
-        let targetY = curvedY * mapping.mouseSensitivity
+        let targetX = Double(shapedX) * profile.mouseScale
+        let targetY = Double(shapedY) * profile.mouseScale
 
         // Apply smoothing to reduce jitter
+        let smoothingFactor = profile.smoothingFactor
         smoothX = smoothX * smoothingFactor + targetX * (1.0 - smoothingFactor)
         smoothY = smoothY * smoothingFactor + targetY * (1.0 - smoothingFactor)
 
-        // Skip if no significant movement
-        guard abs(smoothX) > 0.5 || abs(smoothY) > 0.5 else {
+        // Skip if no significant movement. Relative mode accumulates slow aim
+        // below a pixel per report and only settles once the stick is released.
+        let isSettling = mouseOutputMode == .absolute || (targetX == 0 && targetY == 0)
+        guard !isSettling || abs(smoothX) > 0.5 || abs(smoothY) > 0.5 else {
             smoothX = 0
             smoothY = 0
             return
         }
 
         // Post mouse movement
-        postMouseMovement(deltaX: smoothX, deltaY: smoothY)
-    }
-
-    // Multi-stage response curve for natural joystick-to-mouse feel
-    // Zone 1 (0-40%): Precision - power 0.7 for fine aiming
-    // Zone 2 (40-80%): Linear - power 1.0 for consistent tracking
-    // Zone 3 (80-100%): Acceleration - power 1.3 for fast turns
-    private func applyMultiStageAcceleration(_ value: Double) -> Double {
-        let sign = value >= 0 ? 1.0 : -1.0
-        let magnitude = abs(value)
-
-        let result: Double
-        if magnitude <= 0.4 {
-            // Precision zone: power 0.7 for fine control
-            // Normalize to 0-1 within this zone, apply curve, scale back
-            let normalized = magnitude / 0.4
-            result = pow(normalized, 0.7) * 0.4
-        } else if magnitude <= 0.8 {
-            // Linear zone: power 1.0 (no curve)
-            // Start from where precision zone ended (0.4)
-            let normalized = (magnitude - 0.4) / 0.4
-            result = 0.4 + normalized * 0.4
-        } else {
-            // Acceleration zone: power 1.3 for fast turns
-            // Start from where linear zone ended (0.8)
-            let normalized = (magnitude - 0.8) / 0.2
-            result = 0.8 + pow(normalized, 1.3) * 0.2
-        }
-
-        return sign * result
-    }
-
-    // MARK: - Helpers
-
-    private func normalizeAxis(_ value: UInt8) -> Double {
-        return (Double(value) - 128.0) / 128.0
+        emitMouseMovement(deltaX: smoothX, deltaY: smoothY)
     }
 
-    // Dual deadzone: inner removes drift, outer prevents edge instability
-    private func applyDualDeadzone(_ value: Double, inner: Double, outer: Double) -> Double {
-        let magnitude = abs(value)
-
-        // Inner deadzone: eliminate stick drift
-        if magnitude < inner {
-            return 0
-        }
-
-        // Outer deadzone: clamp to max at threshold to prevent instability at edges
-        let clampedMagnitude = min(magnitude, outer)
-
-        // Scale to 0-1 range between inner and outer deadzone
-        let sign = value > 0 ? 1.0 : -1.0
-        let scaledMagnitude = (clampedMagnitude - inner) / (outer - inner)
+    // MARK: - Cleanup
 
-        return sign * scaledMagnitude
-    }
+    func releaseAllKeys() {
+        // Not tied to a report, so no latency samples
+        stateTimestamp = 0
 
-    // Legacy single deadzone for left stick (movement keys don't need precision)
-    private func applyDeadzone(_ value: Double, _ deadzone: Double) -> Double {
-        if abs(value) < deadzone {
-            return 0
-        }
-        let sign = value > 0 ? 1.0 : -1.0
-        return sign * (abs(value) - deadzone) / (1.0 - deadzone)
+        queueReleaseOfHeldInputs()
+        postEventBatch()
     }
 
-    // MARK: - Cleanup
+    private static let mouseButtonCodes = [CGKeyCode.mouseLeft, CGKeyCode.mouseRight, CGKeyCode.mouseMiddle]
 
-    func releaseAllKeys() {
-        for keyCode in pressedKeys {
-            if let event = CGEvent(keyboardEventSource: nil, virtualKey: keyCode, keyDown: false) {
-                event.post(tap: .cghidEventTap)
-            }
-        }
+    // Queue releases for every key and mouse button still down
+    private func queueReleaseOfHeldInputs() {
+        pressedKeys.forEach { queueEvent($0, isDown: false) }
         pressedKeys.removeAll()
 
-        for button in mouseButtonsPressed {
+        for button in KeyboardEmulator.mouseButtonCodes {
             releaseMouseButton(button)
         }
-        mouseButtonsPressed.removeAll()
     }
 
     deinit {
-        // Stop and release CVDisplayLink
-        if let link = displayLink {
-            CVDisplayLinkStop(link)
-        }
-        displayLink = nil
+        CGDisplayRemoveReconfigurationCallback(displayReconfigurationCallback, Unmanaged.passUnretained(self).toOpaque())
+
+        // Stop the display link or fixed-rate clock
+        stopOutputClock()
 
         releaseAllKeys()
+        bigben_delta_destroy(pendingDelta)
+
+        observeFrontmostApp(false)
+        bigben_published_destroy(profiles)
+
+        displayLock.deinitialize(count: 1)
+        displayLock.deallocate()
     }
 }
@@ -0,0 +1,97 @@
+//
+//  USBArrivalMonitor.swift
+//  BigbenController
+//
+//  IOKit first-match notifications for Bigben devices, matched the same way
+//  as ControllerMonitor, for readers created with the `.external` arrival
+//  mode. ControllerMonitor itself belongs to the app; this is the mapper's
+//  copy of its arrival half, without the published state.
+//
+
+import Foundation
+import IOKit
+import IOKit.usb
+import CUSBController
+
+// MARK: - USB Arrival Monitor
+
+final class USBArrivalMonitor {
+
+    private let onArrival: () -> Void
+    private let queue = DispatchQueue(label: "com.bigben.usb-arrival")
+    private var notificationPort: IONotificationPortRef?
+    private var addedIterator: io_iterator_t = 0
+
+    /// - Parameter onArrival: Called on a private queue for every Bigben
+    ///   device that appears, e.g. `USBControllerReader.deviceArrived`
+    /// - Returns: nil if the IOKit notification could not be set up
+    init?(onArrival: @escaping () -> Void) {
+        self.onArrival = onArrival
+
+        guard let matchingDict = IOServiceMatching(kIOUSBDeviceClassName) as? NSMutableDictionary else {
+            return nil
+        }
+        matchingDict["idVendor"] = Int(BIGBEN_VID)
+
+        guard let port = IONotificationPortCreate(kIOMainPortDefault) else {
+            return nil
+        }
+        notificationPort = port
+        IONotificationPortSetDispatchQueue(port, queue)
+
+        let selfPtr = Unmanaged.passUnretained(self).toOpaque()
+        let result = IOServiceAddMatchingNotification(
+            port,
+            kIOFirstMatchNotification,
+            matchingDict as CFDictionary,
+            usbArrivalCallback,
+            selfPtr,
+            &addedIterator
+        )
+        guard result == KERN_SUCCESS else {
+            IONotificationPortDestroy(port)
+            notificationPort = nil
+            return nil
+        }
+
+        // Arms the notification; devices already attached are the reader's to find
+        queue.sync {
+            _ = drainAddedDevices()
+        }
+    }
+
+    deinit {
+        // On the notification queue, so no callback is running meanwhile
+        queue.sync {
+            if addedIterator != 0 {
+                IOObjectRelease(addedIterator)
+            }
+            if let port = notificationPort {
+                IONotificationPortDestroy(port)
+            }
+        }
+    }
+
+    /// Release the new entries; returns whether there were any
+    fileprivate func drainAddedDevices() -> Bool {
+        var arrived = false
+        while case let device = IOIteratorNext(addedIterator), device != 0 {
+            arrived = true
+            IOObjectRelease(device)
+        }
+        return arrived
+    }
+
+    fileprivate func devicesAdded() {
+        if drainAddedDevices() {
+            onArrival()
+        }
+    }
+}
+
+// MARK: - IOKit Callback
+
+private func usbArrivalCallback(refCon: UnsafeMutableRawPointer?, iterator: io_iterator_t) {
+    guard let refCon = refCon else { return }
+    Unmanaged<USBArrivalMonitor>.fromOpaque(refCon).takeUnretainedValue().devicesAdded()
+}
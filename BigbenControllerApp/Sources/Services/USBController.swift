@@ -11,10 +11,11 @@ import CUSBController
 // MARK: - Controller State (matching KeyboardEmulator expectations)
 
 struct ControllerState: Equatable {
-    var leftStickX: UInt8 = 128
-    var leftStickY: UInt8 = 128
-    var rightStickX: UInt8 = 128
-    var rightStickY: UInt8 = 128
+    // Sticks at full XInput resolution, 0 = center
+    var leftStickX: Int16 = 0
+    var leftStickY: Int16 = 0
+    var rightStickX: Int16 = 0
+    var rightStickY: Int16 = 0
     var leftTrigger: UInt8 = 0
     var rightTrigger: UInt8 = 0
     var dpad: UInt8 = 8  // Neutral (no direction)
@@ -45,22 +46,44 @@ struct ControllerState: Equatable {
     static func from(report: BigbenInputReport) -> ControllerState {
         var state = ControllerState()
 
-        // XInput sticks are signed 16-bit, convert to unsigned 8-bit (0-255)
-        state.leftStickX = UInt8(clamping: Int(report.left_stick_x / 256) + 128)
-        state.leftStickY = UInt8(clamping: Int(report.left_stick_y / 256) + 128)
-        state.rightStickX = UInt8(clamping: Int(report.right_stick_x / 256) + 128)
-        state.rightStickY = UInt8(clamping: Int(report.right_stick_y / 256) + 128)
+        // XInput sticks are signed 16-bit and kept that way
+        state.leftStickX = report.left_stick_x
+        state.leftStickY = report.left_stick_y
+        state.rightStickX = report.right_stick_x
+        state.rightStickY = report.right_stick_y
 
         state.leftTrigger = report.left_trigger
         state.rightTrigger = report.right_trigger
         state.buttons = report.buttons
+        state.dpad = dpadValue(buttons: report.buttons)
 
-        // Convert button d-pad to numeric (for backward compat, though we use button flags now)
+        return state
+    }
+
+    // Read a borrowed report where it lies (see bigben_borrow)
+    static func from(view: UnsafePointer<BigbenReportView>) -> ControllerState {
+        var state = ControllerState()
+
+        state.leftStickX = bigben_view_left_stick_x(view)
+        state.leftStickY = bigben_view_left_stick_y(view)
+        state.rightStickX = bigben_view_right_stick_x(view)
+        state.rightStickY = bigben_view_right_stick_y(view)
+
+        state.leftTrigger = bigben_view_left_trigger(view)
+        state.rightTrigger = bigben_view_right_trigger(view)
+        state.buttons = bigben_view_buttons(view)
+        state.dpad = dpadValue(buttons: state.buttons)
+
+        return state
+    }
+
+    // Convert button d-pad to numeric (for backward compat, though we use button flags now)
+    private static func dpadValue(buttons: UInt16) -> UInt8 {
         var dpadValue: UInt8 = 8  // Neutral
-        let up = (report.buttons & UInt16(BTN_DPAD_UP)) != 0
-        let down = (report.buttons & UInt16(BTN_DPAD_DOWN)) != 0
-        let left = (report.buttons & UInt16(BTN_DPAD_LEFT)) != 0
-        let right = (report.buttons & UInt16(BTN_DPAD_RIGHT)) != 0
+        let up = (buttons & UInt16(BTN_DPAD_UP)) != 0
+        let down = (buttons & UInt16(BTN_DPAD_DOWN)) != 0
+        let left = (buttons & UInt16(BTN_DPAD_LEFT)) != 0
+        let right = (buttons & UInt16(BTN_DPAD_RIGHT)) != 0
 
         if up && !down && !left && !right { dpadValue = 0 }      // N
         else if up && right { dpadValue = 1 }                      // NE
@@ -71,9 +94,7 @@ struct ControllerState: Equatable {
         else if left && !up && !down { dpadValue = 6 }            // W
         else if up && left { dpadValue = 7 }                       // NW
 
-        state.dpad = dpadValue
-
-        return state
+        return dpadValue
     }
 }
 
@@ -81,23 +102,111 @@ struct ControllerState: Equatable {
 
 class USBControllerReader {
 
+    /// How the reader learns that a controller was plugged in
+    enum ArrivalMode {
+        /// libusb hotplug events; falls back to polling where unsupported
+        case hotplug
+        /// The owner calls `deviceArrived()`, e.g. from a USBArrivalMonitor
+        /// (IOKit first-match notifications, as in ControllerMonitor)
+        case external
+        /// Rescan the bus every second while disconnected
+        case polling
+    }
+
+    // All callbacks run on the input pipeline thread, in order with the
+    // reports, so consumers can keep their state unsynchronized
     var onStateChanged: ((ControllerState) -> Void)?
     var onError: ((Error) -> Void)?
     var onConnected: (() -> Void)?
     var onDisconnected: (() -> Void)?
 
+    /// Called with the open timings once the first report after each
+    /// connect has arrived
+    var onFirstReport: ((BigbenStartupStats) -> Void)?
+
+    /// USB completion time (mach ticks) of the report behind the state
+    /// currently being delivered through onStateChanged
+    private(set) var currentReportTimestamp: UInt64 = 0
+
+    /// Reports dropped because every engine buffer was still borrowed
+    var droppedReports: UInt64 {
+        guard let ctrl = controller else { return 0 }
+        return bigben_borrow_dropped(ctrl)
+    }
+
+    /// Record every report to this file while running (see InputReplayer);
+    /// set before `start()`
+    var recordingPath: String?
+
+    /// Where the open controller is attached, nil while disconnected
+    private(set) var deviceInfo: BigbenDeviceInfo?
+
+    /// Timings of the last open, nil if never connected
+    var startupStats: BigbenStartupStats? {
+        guard let ctrl = controller else { return nil }
+        var stats = BigbenStartupStats()
+        return bigben_get_startup_stats(ctrl, &stats) == 0 ? stats : nil
+    }
+
     private var controller: OpaquePointer?
-    private var readTimer: DispatchSourceTimer?
+    private var recorder: OpaquePointer?
+    private let targetDevice: BigbenDeviceInfo?
+    private var loopbackProductID: UInt16?
+    private var arrivalMode: ArrivalMode
+    private var hotplugHandle: Int32 = -1
     private var currentState = ControllerState()
     private var isRunning = false
-    private let pollQueue = DispatchQueue(label: "com.bigben.poll", qos: .userInteractive)
+    private let controlQueue = DispatchQueue(label: "com.bigben.control", qos: .userInteractive)
+    private static let controlQueueKey = DispatchSpecificKey<Bool>()
+
+    // Reports stay in the USB transfer buffers they were read into and are
+    // borrowed on the real-time pipeline thread, which also runs translation
+    // and event posting; slow consumers never hold up the endpoint
+    private var pipeline: InputPipelineThread!
+    private var awaitingFirstReport = false
+    private var drainViews = [BigbenReportView](repeating: BigbenReportView(), count: USBControllerReader.drainBatchSize)
+    private static let borrowBuffers: UInt32 = 64
+    private static let drainBatchSize = 16
+
+    // A freshly attached device can take a few milliseconds to become openable
+    private static let arrivalRetryCount = 5
+    private static let arrivalRetryDelay: DispatchTimeInterval = .milliseconds(10)
+    private static let pollingInterval: TimeInterval = 1.0
+
+    // Last opened bus/port path, tried first on the next launch
+    private static let deviceHintKey = "BigbenLastDevice"
+
+    /// - Parameters:
+    ///   - device: Controller to read from (from `attachedDevices()`).
+    ///     With nil, the first controller not already used by another reader
+    ///     is opened, so one reader per pad covers local multiplayer.
+    ///   - arrivalMode: How reconnects are triggered after an unplug.
+    init(device: BigbenDeviceInfo? = nil, arrivalMode: ArrivalMode = .hotplug) {
+        targetDevice = device
+        self.arrivalMode = arrivalMode
+        controlQueue.setSpecific(key: USBControllerReader.controlQueueKey, value: true)
+        pipeline = InputPipelineThread(name: "com.bigben.input-pipeline") { [unowned self] in
+            self.drainReports()
+        }
 
-    init() {
         // Initialize libusb
         let result = bigben_init()
         if result != 0 {
             print("Warning: Failed to initialize libusb")
         }
+
+        var hint = BigbenDeviceInfo()
+        if !bigben_get_device_hint(&hint), let saved = USBControllerReader.loadDeviceHint() {
+            hint = saved
+            bigben_set_device_hint(&hint)
+        }
+    }
+
+    /// Reader for a loopback controller with no device behind it, fed with
+    /// `injectLoopbackPacket`; for benchmarks
+    convenience init(loopbackProductID: UInt16) {
+        self.init(device: nil, arrivalMode: .external)
+        self.loopbackProductID = loopbackProductID
     }
 
     deinit {
@@ -107,107 +216,338 @@ class USBControllerReader {
 
     // MARK: - Public Methods
 
+    /// Bigben controllers currently attached
+    static func attachedDevices() -> [BigbenDeviceInfo] {
+        let count = bigben_enumerate(nil, 0)
+        guard count > 0 else { return [] }
+
+        var devices = [BigbenDeviceInfo](repeating: BigbenDeviceInfo(), count: count)
+        let found = devices.withUnsafeMutableBufferPointer { buffer in
+            bigben_enumerate(buffer.baseAddress, buffer.count)
+        }
+        return Array(devices.prefix(min(found, count)))
+    }
+
     func start() {
         guard !isRunning else { return }
         isRunning = true
 
         // Create controller instance
-        controller = bigben_create()
-        guard controller != nil else {
+        if let productID = loopbackProductID {
+            controller = bigben_create_loopback(productID)
+        } else {
+            controller = bigben_create()
+        }
+        guard let ctrl = controller else {
             print("Failed to create controller instance")
             return
         }
 
+        // Frames are copied on the USB thread and written from the
+        // recorder's own thread, so recording never delays a report
+        if let path = recordingPath {
+            recorder = bigben_recorder_create(path)
+            if let rec = recorder {
+                bigben_set_recorder(ctrl, rec)
+                print("Recording input to \(path)")
+            } else {
+                print("Failed to create recording \(path)")
+            }
+        }
+
+        // The USB thread only wakes the pipeline; reports are drained there
+        pipeline.start()
+
+        let context = Unmanaged.passUnretained(self).toOpaque()
+        let borrowResult = bigben_enable_borrowing(ctrl, USBControllerReader.borrowBuffers, { context in
+            guard let context = context else { return }
+            let reader = Unmanaged<USBControllerReader>.fromOpaque(context).takeUnretainedValue()
+            reader.pipeline.signal()
+        }, context)
+        if borrowResult != 0 {
+            print("Failed to enable report borrowing")
+        }
+
+        // Disconnects arrive on the libusb event thread
+        bigben_set_connection_callback(ctrl, { connected, context in
+            guard !connected, let context = context else { return }
+            let reader = Unmanaged<USBControllerReader>.fromOpaque(context).takeUnretainedValue()
+            reader.handleDisconnect()
+        }, context)
+
+        startArrivalMonitoring()
+
         // Try to open connection
-        tryConnect()
+        controlQueue.async { [weak self] in
+            self?.tryConnect()
+        }
     }
 
     func stop() {
+        // No new arrivals after this; a callback in progress only queues work
+        if hotplugHandle >= 0 {
+            bigben_hotplug_deregister(hotplugHandle)
+            hotplugHandle = -1
+        }
+
+        // Connects, retries and disconnect handling all run on controlQueue,
+        // so tearing down there means none of them sees a closing handle.
+        // Blocks still queued find isRunning false and controller nil.
+        // A control block can hold the last reference, so deinit may already
+        // be running on the queue.
+        if DispatchQueue.getSpecific(key: USBControllerReader.controlQueueKey) != nil {
+            tearDown()
+        } else {
+            controlQueue.sync { tearDown() }
+        }
+    }
+
+    // Runs on controlQueue
+    private func tearDown() {
         isRunning = false
-        readTimer?.cancel()
-        readTimer = nil
+        guard let ctrl = controller else { return }
 
-        if let ctrl = controller {
-            bigben_stop_reading(ctrl)
-            bigben_close(ctrl)
-            bigben_destroy(ctrl)
-            controller = nil
+        bigben_stop_reading(ctrl)
+
+        // Let any in-progress drain finish before the queue goes away
+        pipeline.stop()
+
+        if let rec = recorder {
+            bigben_set_recorder(ctrl, nil)
+            let dropped = bigben_recorder_dropped(rec)
+            var frames: UInt64 = 0
+            if bigben_recorder_close(rec, &frames) == 0 {
+                print("Recorded \(frames) frames to \(recordingPath ?? "") (dropped \(dropped))")
+            } else {
+                print("Failed to finish recording \(recordingPath ?? "")")
+            }
+            recorder = nil
         }
+
+        bigben_close(ctrl)
+        bigben_destroy(ctrl)
+        controller = nil
+        deviceInfo = nil
+    }
+
+    /// A Bigben controller was plugged in; reconnects if currently disconnected
+    /// Safe to call from any thread
+    func deviceArrived() {
+        controlQueue.async { [weak self] in
+            self?.connectAfterArrival(attempt: 0)
+        }
+    }
+
+    /// Deliver a raw input packet to a loopback reader as if the controller
+    /// had just sent it; call from one thread, while running
+    /// - Returns: false if the packet was rejected or dropped
+    @discardableResult
+    func injectLoopbackPacket(_ packet: UnsafePointer<UInt8>, length: Int) -> Bool {
+        guard loopbackProductID != nil, let ctrl = controller else { return false }
+        return bigben_loopback_inject(ctrl, packet, Int32(length), 0) == 0
     }
 
+    /// Never blocks; the rumble thread writes the latest levels once per tick
     func sendRumble(weakMotor: UInt8, strongMotor: UInt8) {
         guard let ctrl = controller, bigben_is_connected(ctrl) else { return }
         bigben_set_rumble(ctrl, weakMotor, strongMotor)
     }
 
+    /// Compile an effect once; it stays uploaded across reconnects
+    /// - Returns: The effect ID, or nil if the effect is invalid or no slot is free
+    func uploadRumbleEffect(_ effect: BigbenRumbleEffect) -> Int32? {
+        guard let ctrl = controller else { return nil }
+        var effect = effect
+        let id = bigben_rumble_upload(ctrl, &effect)
+        return id >= 0 ? id : nil
+    }
+
+    /// Play an uploaded effect; loops 0 repeats until stopRumble()
+    func playRumbleEffect(_ id: Int32, loops: UInt32 = 1) {
+        guard let ctrl = controller, bigben_is_connected(ctrl) else { return }
+        bigben_rumble_play(ctrl, id, loops)
+    }
+
+    func stopRumble() {
+        guard let ctrl = controller else { return }
+        bigben_rumble_stop(ctrl)
+    }
+
     // MARK: - Private Methods
 
+    private func startArrivalMonitoring() {
+        guard arrivalMode == .hotplug else { return }
+
+        guard bigben_hotplug_supported() else {
+            print("USB hotplug not supported, polling for reconnects")
+            arrivalMode = .polling
+            return
+        }
+
+        let context = Unmanaged.passUnretained(self).toOpaque()
+        hotplugHandle = bigben_hotplug_register({ _, arrived, context in
+            guard arrived, let context = context else { return }
+            let reader = Unmanaged<USBControllerReader>.fromOpaque(context).takeUnretainedValue()
+            reader.deviceArrived()
+        }, context)
+
+        if hotplugHandle < 0 {
+            print("Failed to register for USB hotplug, polling for reconnects")
+            arrivalMode = .polling
+        }
+    }
+
+    // Runs on controlQueue
     private func tryConnect() {
-        guard let ctrl = controller else { return }
+        guard isRunning, controller != nil else { return }
+        if !connect() {
+            scheduleReconnect()
+        }
+    }
 
-        // Try to open the controller
-        let result = bigben_open(ctrl)
-        if result == 0 {
-            print("Controller opened successfully")
-            DispatchQueue.main.async { [weak self] in
-                self?.onConnected?()
+    // Runs on controlQueue
+    private func connectAfterArrival(attempt: Int) {
+        guard isRunning, let ctrl = controller, !bigben_is_connected(ctrl) else { return }
+
+        if !connect() && attempt < USBControllerReader.arrivalRetryCount {
+            controlQueue.asyncAfter(deadline: .now() + USBControllerReader.arrivalRetryDelay) { [weak self] in
+                self?.connectAfterArrival(attempt: attempt + 1)
             }
-            startReading()
+        }
+    }
+
+    // Open the controller and start reading; runs on controlQueue
+    private func connect() -> Bool {
+        guard isRunning, let ctrl = controller else { return false }
+        if bigben_is_connected(ctrl) {
+            return true
+        }
+
+        // Drop a handle left over from a device that was lost
+        bigben_close(ctrl)
+
+        // Try to open the controller
+        let result: Int32
+        if var device = targetDevice {
+            result = bigben_open_device(ctrl, &device)
         } else {
-            // Schedule retry
-            DispatchQueue.main.asyncAfter(deadline: .now() + 1.0) { [weak self] in
-                guard let self = self, self.isRunning else { return }
-                self.tryConnect()
+            result = bigben_open(ctrl)
+        }
+        guard result == 0 else { return false }
+
+        guard startReading() else {
+            bigben_close(ctrl)
+            return false
+        }
+
+        var info = BigbenDeviceInfo()
+        if bigben_get_device_info(ctrl, &info) == 0 {
+            deviceInfo = info
+            if loopbackProductID == nil {
+                USBControllerReader.saveDeviceHint(info)
             }
         }
+        print("Controller opened successfully")
+        pipeline.perform { [weak self] in
+            self?.onConnected?()
+        }
+        return true
     }
 
-    private func startReading() {
-        // Poll for input at high frequency for smooth mouse movement
-        // 500Hz = 2ms intervals for very responsive camera control
-        readTimer?.cancel()
+    // Only polls in .polling mode; otherwise the next arrival event reconnects
+    private func scheduleReconnect() {
+        guard arrivalMode == .polling else { return }
 
-        let timer = DispatchSource.makeTimerSource(queue: pollQueue)
-        timer.schedule(deadline: .now(), repeating: .milliseconds(2), leeway: .microseconds(100))
-        timer.setEventHandler { [weak self] in
-            self?.pollController()
+        controlQueue.asyncAfter(deadline: .now() + USBControllerReader.pollingInterval) { [weak self] in
+            guard let self = self, self.isRunning, self.controller != nil else { return }
+            self.tryConnect()
         }
-        timer.resume()
-        readTimer = timer
     }
 
-    private func pollController() {
-        guard let ctrl = controller else { return }
+    private func startReading() -> Bool {
+        guard let ctrl = controller else { return false }
 
-        var report = BigbenInputReport()
-        let result = bigben_poll(ctrl, &report, 10)
+        // Transfers stay submitted on the libusb event thread, so each report
+        // is handled as soon as the controller sends it
+        pipeline.perform { [weak self] in
+            self?.currentState = ControllerState()
+            self?.awaitingFirstReport = true
+        }
+        if bigben_start_reading(ctrl) != 0 {
+            print("Failed to start reading")
+            return false
+        }
+        return true
+    }
 
-        if result == 0 {
-            let newState = ControllerState.from(report: report)
+    private func drainReports() {
+        guard let ctrl = controller else { return }
 
-            if newState != currentState {
-                currentState = newState
-                onStateChanged?(newState)
+        var count = 0
+        repeat {
+            count = drainViews.withUnsafeMutableBufferPointer { views in
+                guard let base = views.baseAddress else { return 0 }
+                let count = bigben_borrow(ctrl, base, views.count)
+                for i in 0..<count {
+                    handleReport(base + i)
+                }
+                // Nothing keeps a view past translation, so the whole batch goes back
+                bigben_release(ctrl, base, count)
+                return count
             }
-        } else if result == -4 { // LIBUSB_ERROR_NO_DEVICE
-            // Device disconnected
-            readTimer?.cancel()
-            readTimer = nil
+        } while count == drainViews.count
+    }
 
-            DispatchQueue.main.async { [weak self] in
-                self?.onDisconnected?()
-            }
+    private func handleReport(_ view: UnsafePointer<BigbenReportView>) {
+        let timestamp = view.pointee.timestamp
+        bigben_latency_record(BIGBEN_STAGE_DRAIN, timestamp)
 
-            // Try to reconnect
-            if let ctrl = controller {
-                bigben_close(ctrl)
+        if awaitingFirstReport {
+            awaitingFirstReport = false
+            if let stats = startupStats {
+                onFirstReport?(stats)
             }
+        }
 
-            DispatchQueue.main.asyncAfter(deadline: .now() + 1.0) { [weak self] in
-                guard let self = self, self.isRunning else { return }
-                self.tryConnect()
+        let newState = ControllerState.from(view: view)
+        bigben_latency_record(BIGBEN_STAGE_TRANSLATE, timestamp)
+
+        if newState != currentState {
+            currentState = newState
+            currentReportTimestamp = timestamp
+            onStateChanged?(newState)
+        }
+    }
+
+    private static func loadDeviceHint() -> BigbenDeviceInfo? {
+        guard let data = UserDefaults.standard.data(forKey: deviceHintKey),
+              data.count == MemoryLayout<BigbenDeviceInfo>.size else {
+            return nil
+        }
+        var info = BigbenDeviceInfo()
+        withUnsafeMutableBytes(of: &info) { _ = data.copyBytes(to: $0) }
+        return info
+    }
+
+    private static func saveDeviceHint(_ info: BigbenDeviceInfo) {
+        let data = withUnsafeBytes(of: info) { Data($0) }
+        UserDefaults.standard.set(data, forKey: deviceHintKey)
+    }
+
+    private func handleDisconnect() {
+        // Called on the event thread, which bigben_close has to join,
+        // so tear down from another queue
+        controlQueue.async { [weak self] in
+            guard let self = self, self.isRunning, let ctrl = self.controller else { return }
+
+            bigben_close(ctrl)
+            self.deviceInfo = nil
+
+            self.pipeline.perform { [weak self] in
+                self?.onDisconnected?()
             }
+
+            self.scheduleReconnect()
         }
-        // Ignore timeout errors (result == -7), they're normal
     }
 }
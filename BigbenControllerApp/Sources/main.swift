@@ -8,6 +8,7 @@
 
 import Foundation
 import AppKit
+import CUSBController
 
 // Helper to flush output immediately
 func log(_ message: String) {
@@ -31,41 +32,88 @@ func checkAccessibilityPermissions() -> Bool {
     return AXIsProcessTrustedWithOptions(options as CFDictionary)
 }
 
-log("\n🔐 Checking Accessibility permissions...")
+// Argument value following a flag, e.g. --record FILE
+func argumentValue(_ flag: String) -> String? {
+    guard let index = CommandLine.arguments.firstIndex(of: flag),
+          index + 1 < CommandLine.arguments.count else { return nil }
+    return CommandLine.arguments[index + 1]
+}
 
-if !checkAccessibilityPermissions() {
-    log("""
+// Benchmark - inject reports into a loopback controller and measure the
+// whole path; implies a dry run
+let benchmarkMode = CommandLine.arguments.contains("--benchmark")
 
-    ⚠️  Accessibility permissions required!
+// Dry run - run the whole mapping path but post no events, so no
+// Accessibility permission is needed (useful with --replay)
+let dryRun = benchmarkMode || CommandLine.arguments.contains("--dry-run")
 
-    This app needs permission to control your keyboard and mouse.
+// Record the session's reports, or replay a recording instead of reading USB
+let recordPath = argumentValue("--record")
+let replayPath = argumentValue("--replay")
 
-    Please:
-    1. Open System Settings → Privacy & Security → Accessibility
-    2. Find this app and enable the toggle
-    3. Run this app again
+if dryRun {
+    log("\n🧪 Dry run: no keyboard or mouse events will be posted\n")
+} else {
+    log("\n🔐 Checking Accessibility permissions...")
 
-    """)
+    if !checkAccessibilityPermissions() {
+        log("""
 
-    // Open System Preferences
-    if let url = URL(string: "x-apple.systempreferences:com.apple.preference.security?Privacy_Accessibility") {
-        NSWorkspace.shared.open(url)
-    }
+        ⚠️  Accessibility permissions required!
 
-    log("Press Enter after granting permission...")
-    _ = readLine()
+        This app needs permission to control your keyboard and mouse.
 
-    if !AXIsProcessTrusted() {
-        log("❌ Permission still not granted. Exiting.")
-        exit(1)
+        Please:
+        1. Open System Settings → Privacy & Security → Accessibility
+        2. Find this app and enable the toggle
+        3. Run this app again
+
+        """)
+
+        // Open System Preferences
+        if let url = URL(string: "x-apple.systempreferences:com.apple.preference.security?Privacy_Accessibility") {
+            NSWorkspace.shared.open(url)
+        }
+
+        log("Press Enter after granting permission...")
+        _ = readLine()
+
+        if !AXIsProcessTrusted() {
+            log("❌ Permission still not granted. Exiting.")
+            exit(1)
+        }
     }
+
+    log("✅ Accessibility permissions granted!\n")
 }
 
-log("✅ Accessibility permissions granted!\n")
+// How reconnects are noticed: libusb hotplug (default), IOKit
+// notifications, or a one-second rescan
+var arrivalMode = USBControllerReader.ArrivalMode.hotplug
+if let value = argumentValue("--arrival") {
+    switch value {
+    case "hotplug":
+        arrivalMode = .hotplug
+    case "iokit":
+        arrivalMode = .external
+    case "poll":
+        arrivalMode = .polling
+    default:
+        log("⚠️  Unknown --arrival value '\(value)', using hotplug")
+    }
+}
 
 // Initialize components
-let usbReader = USBControllerReader()
+let usbReader = USBControllerReader(arrivalMode: arrivalMode)
+let arrivalMonitor = arrivalMode == .external
+    ? USBArrivalMonitor(onArrival: { usbReader.deviceArrived() })
+    : nil
+if arrivalMode == .external && arrivalMonitor == nil {
+    log("⚠️  IOKit arrival notifications unavailable; replug the controller to reconnect")
+}
 let keyboardEmulator = KeyboardEmulator()
+keyboardEmulator.postsEvents = !dryRun
+usbReader.recordingPath = recordPath
 
 var isRunning = true
 
@@ -73,9 +121,92 @@ var isRunning = true
 let debugMode = CommandLine.arguments.contains("--debug")
 var lastDebugTime = Date.distantPast
 
-// Controller state callback
-usbReader.onStateChanged = { state in
-    keyboardEmulator.processState(state)
+// Legacy mouse mode: warp to the read-back cursor position on every move
+if CommandLine.arguments.contains("--absolute-mouse") {
+    keyboardEmulator.mouseOutputMode = .absolute
+}
+
+// Mouse output clock: immediate (default), vsync, or a fixed rate in Hz
+if let index = CommandLine.arguments.firstIndex(of: "--mouse-clock"),
+   index + 1 < CommandLine.arguments.count {
+    let value = CommandLine.arguments[index + 1]
+    switch value {
+    case "immediate":
+        keyboardEmulator.mouseOutputClock = .immediate
+    case "vsync":
+        keyboardEmulator.mouseOutputClock = .vsync
+    default:
+        if let hz = Double(value), hz > 0 {
+            keyboardEmulator.mouseOutputClock = .fixedRate(hz: hz)
+        } else {
+            log("⚠️  Unknown --mouse-clock value '\(value)', using immediate")
+        }
+    }
+}
+
+// Per-app presets, switched when the app comes to the front:
+// --app-profile BUNDLE_ID=fps|racing, repeatable
+var appMappings: [String: KeyMapping] = [:]
+for (index, argument) in CommandLine.arguments.enumerated()
+    where argument == "--app-profile" && index + 1 < CommandLine.arguments.count {
+    let value = CommandLine.arguments[index + 1]
+    let parts = value.split(separator: "=", maxSplits: 1).map(String.init)
+    switch parts.count == 2 ? parts[1] : "" {
+    case "fps":
+        appMappings[parts[0]] = .fpsPreset
+    case "racing":
+        appMappings[parts[0]] = .racingPreset
+    default:
+        log("⚠️  Unknown --app-profile value '\(value)', expected BUNDLE_ID=fps|racing")
+    }
+}
+keyboardEmulator.appMappings = appMappings
+
+// Back the output clock off after this many ms without input (0 = never)
+if let value = argumentValue("--idle-after") {
+    if let ms = Double(value), ms >= 0 {
+        keyboardEmulator.idleTimeout = ms / 1000
+    } else {
+        log("⚠️  Unknown --idle-after value '\(value)', using \(Int(keyboardEmulator.idleTimeout * 1000)) ms")
+    }
+}
+
+// Stats mode - periodically print per-stage latency percentiles
+let statsMode = CommandLine.arguments.contains("--stats")
+let statsInterval: TimeInterval = 5.0
+
+func formatLatency(_ ns: UInt64) -> String {
+    if ns >= 1_000_000 {
+        return String(format: "%.2fms", Double(ns) / 1_000_000)
+    }
+    return String(format: "%.1fµs", Double(ns) / 1_000)
+}
+
+func dumpLatencyStats() {
+    log("\n📊 Latency since USB transfer completion (dropped reports: \(usbReader.droppedReports))")
+    for rawStage in 0..<BIGBEN_STAGE_COUNT.rawValue {
+        let stage = BigbenLatencyStage(rawValue: rawStage)
+        var stats = BigbenLatencyStats()
+        bigben_latency_summary(stage, &stats)
+        guard stats.count > 0 else { continue }
+
+        let name = String(cString: bigben_latency_stage_name(stage))
+            .padding(toLength: 10, withPad: " ", startingAt: 0)
+        log("   \(name) n=\(stats.count) p50=\(formatLatency(stats.p50_ns)) " +
+            "p99=\(formatLatency(stats.p99_ns)) p99.9=\(formatLatency(stats.p999_ns)) " +
+            "max=\(formatLatency(stats.max_ns))")
+    }
+
+    if keyboardEmulator.mouseOutputClock != .immediate {
+        let clock = keyboardEmulator.takeOutputClockStats()
+        log(String(format: "   Output clock %.0f wakeups/s, idle %.1f%%",
+                   clock.wakeupsPerSecond, clock.idleResidency * 100))
+    }
+}
+
+// Controller state handler, shared by the live reader and replays
+func handleState(_ state: ControllerState, timestamp: UInt64) {
+    keyboardEmulator.processState(state, timestamp: timestamp)
 
     // Debug output
     if debugMode && Date().timeIntervalSince(lastDebugTime) > 0.1 {
@@ -99,19 +230,23 @@ usbReader.onStateChanged = { state in
         if state.dpadLeft { buttons.append("DLeft") }
         if state.dpadRight { buttons.append("DRight") }
 
-        let lx = Int(state.leftStickX) - 128
-        let ly = Int(state.leftStickY) - 128
-        let rx = Int(state.rightStickX) - 128
-        let ry = Int(state.rightStickY) - 128
+        let lx = Int(state.leftStickX)
+        let ly = Int(state.leftStickY)
+        let rx = Int(state.rightStickX)
+        let ry = Int(state.rightStickY)
         let lt = state.leftTrigger
         let rt = state.rightTrigger
 
-        let line = String(format: "L:(%+4d,%+4d) R:(%+4d,%+4d) LT:%3d RT:%3d %@",
+        let line = String(format: "L:(%+6d,%+6d) R:(%+6d,%+6d) LT:%3d RT:%3d %@",
                           lx, ly, rx, ry, lt, rt, buttons.joined(separator: " "))
         log("\r\(line)           ")
     }
 }
 
+usbReader.onStateChanged = { state in
+    handleState(state, timestamp: usbReader.currentReportTimestamp)
+}
+
 usbReader.onConnected = {
     log("""
 
@@ -141,6 +276,12 @@ usbReader.onConnected = {
     """)
 }
 
+usbReader.onFirstReport = { stats in
+    let source = stats.used_hint ? "cached port" : "bus scan"
+    log("⏱  Opened in \(formatLatency(stats.open_ns)) (\(source)), " +
+        "first report after \(formatLatency(stats.first_report_ns))")
+}
+
 usbReader.onDisconnected = {
     log("\n⚠️  Controller disconnected! Waiting for reconnection...")
     keyboardEmulator.releaseAllKeys()
@@ -150,16 +291,132 @@ usbReader.onError = { error in
     log("❌ Error: \(error.localizedDescription)")
 }
 
-// Handle Ctrl+C
-signal(SIGINT) { _ in
+// Handle Ctrl+C on the main queue, so the recording can be finalized
+signal(SIGINT, SIG_IGN)
+let interruptSource = DispatchSource.makeSignalSource(signal: SIGINT, queue: .main)
+interruptSource.setEventHandler {
     log("\n\n👋 Exiting...")
     isRunning = false
+    usbReader.stop()
+    keyboardEmulator.releaseAllKeys()
+    exit(0)
+}
+interruptSource.resume()
+
+// Replay a recording through the mapper instead of reading the controller
+func runReplay(path: String, pacing: InputReplayer.Pacing) -> Never {
+    guard let replayer = InputReplayer(path: path) else {
+        log("❌ Could not open recording \(path)")
+        exit(1)
+    }
+
+    log(String(format: "▶️  Replaying %d reports (VID 0x%04x, PID 0x%04x, %.1fs recorded)%@",
+               replayer.frameCount, replayer.vendorID, replayer.productID,
+               Double(replayer.recordedDurationNs) / 1_000_000_000,
+               pacing == .asFastAsPossible ? " as fast as possible" : ""))
+
+    replayer.onStateChanged = { state, timestamp in
+        handleState(state, timestamp: timestamp)
+    }
+
+    // Same scheduling as the live input pipeline
+    let thread = Thread {
+        _ = InputPipelineThread.setRealtimePolicy(.default)
+        let result = replayer.run(pacing: pacing)
+
+        DispatchQueue.main.async {
+            keyboardEmulator.releaseAllKeys()
+
+            let seconds = Double(result.elapsedNs) / 1_000_000_000
+            let rate = seconds > 0 ? Double(result.frames) / seconds : 0
+            log(String(format: "\n⏹  Replayed %d reports in %@ (%.0f reports/s)",
+                       result.frames, formatLatency(result.elapsedNs), rate))
+            if statsMode {
+                dumpLatencyStats()
+            }
+            exit(0)
+        }
+    }
+    thread.name = "com.bigben.replay"
+    thread.qualityOfService = .userInteractive
+    thread.start()
+
+    RunLoop.main.run()
+    exit(0)
+}
+
+// Run the standard loads against a loopback controller and exit
+func runBenchmark(recordingPath: String?, seconds: Double) -> Never {
+    guard let benchmark = InputBenchmark(emulator: keyboardEmulator, recordingPath: recordingPath) else {
+        log("❌ Could not open recording \(recordingPath ?? "")")
+        exit(1)
+    }
+    bigben_latency_enable(true)
+
+    log(String(format: "⏱  Benchmarking the input path with %@, %.1fs per load",
+               benchmark.source, seconds))
+
+    let thread = Thread {
+        guard benchmark.start() else {
+            log("❌ Loopback controller did not connect")
+            exit(1)
+        }
+
+        for load in InputBenchmark.Load.standard {
+            // Injection runs on this thread at the load's own period
+            let period = UInt64(1_000_000_000 / load.hz)
+            _ = InputPipelineThread.setRealtimePolicy(
+                InputPipelineThread.Timing(periodNs: period, computationNs: min(period / 4, 200_000),
+                                           constraintNs: period))
+
+            let result = benchmark.run(load, seconds: seconds)
+            log(String(format: "\n📈 %@: %d injected, %llu processed, %llu dropped, %.0f reports/s, CPU %@/report",
+                       load.description, result.injected, result.drained, result.dropped,
+                       result.reportsPerSecond, formatLatency(UInt64(result.cpuNsPerReport))))
+            for (name, stats) in result.stages {
+                log("   \(name.padding(toLength: 10, withPad: " ", startingAt: 0)) " +
+                    "p50=\(formatLatency(stats.p50_ns)) p99=\(formatLatency(stats.p99_ns)) " +
+                    "p99.9=\(formatLatency(stats.p999_ns)) max=\(formatLatency(stats.max_ns))")
+            }
+        }
+
+        benchmark.stop()
+        exit(0)
+    }
+    thread.name = "com.bigben.benchmark"
+    thread.qualityOfService = .userInteractive
+    thread.start()
+
+    RunLoop.main.run()
+    exit(0)
+}
+
+if benchmarkMode {
+    let seconds = argumentValue("--bench-seconds").flatMap(Double.init) ?? 3
+    runBenchmark(recordingPath: argumentValue("--bench-recording"), seconds: max(0.1, seconds))
+}
+
+if statsMode {
+    bigben_latency_enable(true)
+}
+
+if let path = replayPath {
+    let pacing: InputReplayer.Pacing = CommandLine.arguments.contains("--replay-fast")
+        ? .asFastAsPossible
+        : .originalTiming
+    runReplay(path: path, pacing: pacing)
 }
 
 // Start the controller reader
 log("🔍 Looking for Bigben controller (VID: 0x146b)...")
 log("   Supported: PC Compact (0x0603), PS4 Compact (0x0d05)\n")
 
+if statsMode {
+    Timer.scheduledTimer(withTimeInterval: statsInterval, repeats: true) { _ in
+        dumpLatencyStats()
+    }
+}
+
 usbReader.start()
 
 // Keep running
@@ -14,15 +14,20 @@
 #include <DriverKit/IOLib.h>
 #include <DriverKit/IOMemoryDescriptor.h>
 #include <DriverKit/IOBufferMemoryDescriptor.h>
+#include <DriverKit/IODispatchQueue.h>
+#include <DriverKit/IOTimerDispatchSource.h>
 #include <DriverKit/OSDictionary.h>
 #include <DriverKit/OSData.h>
 #include <DriverKit/OSNumber.h>
 #include <DriverKit/OSString.h>
 
 #include "BigbenHIDDevice.h"
+#include "BigbenUSBDriver.h"
 #include "InputTranslator.h"
 #include "../../Shared/BigbenProtocol.h"
 #include "../../Shared/HIDReportDescriptor.h"
+#include "../../Shared/ReportSnapshot.h"
+#include "../../Shared/TraceRing.h"
 
 // =============================================================================
 // MARK: - Logging
@@ -30,9 +35,35 @@
 
 #define LOG_SUBSYSTEM "com.bigben.controller.hid"
 
+// Per-report events are traced in binary instead (see traceEvent); debug
+// text is only compiled in with BIGBEN_DEBUG_LOG
 #define HIDLog(fmt, ...)     os_log(OS_LOG_DEFAULT, LOG_SUBSYSTEM ": " fmt, ##__VA_ARGS__)
-#define HIDLogDebug(fmt, ...) os_log_debug(OS_LOG_DEFAULT, LOG_SUBSYSTEM ": " fmt, ##__VA_ARGS__)
 #define HIDLogError(fmt, ...) os_log_error(OS_LOG_DEFAULT, LOG_SUBSYSTEM ": " fmt, ##__VA_ARGS__)
+#if defined(BIGBEN_DEBUG_LOG)
+#define HIDLogDebug(fmt, ...) os_log_debug(OS_LOG_DEFAULT, LOG_SUBSYSTEM ": " fmt, ##__VA_ARGS__)
+#else
+#define HIDLogDebug(fmt, ...) do { } while (0)
+#endif
+
+// =============================================================================
+// MARK: - Report Buffer Pool
+// =============================================================================
+
+/// Number of preallocated HID report descriptors
+#define kHIDReportPoolSize  4
+
+/// IORegistry property holding the pool and dispatch counters, and how often
+/// it is refreshed
+#define kHIDReportStatsProperty     "BigbenReportStats"
+#define kHIDReportStatsIntervalMs   1000
+
+/// A pre-mapped memory descriptor for one outgoing HID report
+struct HIDReportPoolEntry
+{
+    IOBufferMemoryDescriptor* buffer;    // Report memory handed to handleReport()
+    uint8_t*                  address;   // Mapped address of buffer
+    bool                      inUse;     // Checked out by handleInputReport()
+};
 
 // =============================================================================
 // MARK: - Class Extension Definition
@@ -48,11 +79,109 @@ struct BigbenHIDDevice_IVars
     // Input translation instance
     InputTranslator     translator;
 
-    // Cached last report for GET_REPORT
-    BigbenHIDReport     lastReport;
-    bool                hasValidReport;
+    // Latest report for GET_REPORT, readable while input is being handled
+    BigbenReportSnapshot snapshot;
+
+    // Preallocated report descriptors, created once in Start()
+    HIDReportPoolEntry  reportPool[kHIDReportPoolSize];
+    uint32_t            reportPoolCount;
+
+    // Allocation accounting: poolAllocations only moves in Start(),
+    // hotPathAllocations must stay at zero in steady state. Updated with
+    // relaxed atomics, read by the stats timer.
+    uint64_t            poolAllocations;
+    uint64_t            hotPathAllocations;
+    uint64_t            reportsDispatched;
+
+    // Publishes the counters above every kHIDReportStatsIntervalMs
+    IOTimerDispatchSource* statsTimer;
+    OSAction*           statsAction;
+    uint64_t            statsIntervalTicks;
+
+    // Binary trace of per-report events, logged on Stop()
+    BigbenTraceRing     trace;
+    uint64_t            traceCursor;
 };
 
+// =============================================================================
+// MARK: - Trace Helpers
+// =============================================================================
+
+static inline void traceEvent(BigbenHIDDevice_IVars* ivars, BigbenTraceEvent event,
+                              uint16_t arg16 = 0, uint32_t arg32 = 0)
+{
+    BigbenTraceRecordEvent(&ivars->trace, event, mach_absolute_time(), arg16, arg32, 0);
+}
+
+// Format the records written since the last call
+static void logTrace(BigbenHIDDevice_IVars* ivars)
+{
+    BigbenTraceRecord records[32];
+
+    for (;;) {
+        uint64_t lost = 0;
+        uint32_t count = BigbenTraceDrain(&ivars->trace, &ivars->traceCursor,
+                                          records, 32, &lost);
+        if (lost > 0) {
+            HIDLog("Trace: %llu older records overwritten", lost);
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            HIDLog("Trace %llu %{public}s: 0x%04x 0x%08x", records[i].timestamp,
+                   BigbenTraceEventName(records[i].event), records[i].arg16, records[i].arg32);
+        }
+        if (count < 32) {
+            break;
+        }
+    }
+}
+
+// =============================================================================
+// MARK: - Report Pool Helpers
+// =============================================================================
+
+static kern_return_t createReportBuffer(HIDReportPoolEntry* entry)
+{
+    kern_return_t ret = IOBufferMemoryDescriptor::Create(
+        kIOMemoryDirectionOut,
+        sizeof(BigbenHIDReport),
+        0,
+        &entry->buffer
+    );
+
+    if (ret != kIOReturnSuccess || entry->buffer == nullptr) {
+        entry->buffer = nullptr;
+        return ret != kIOReturnSuccess ? ret : kIOReturnNoMemory;
+    }
+
+    uint64_t address = 0;
+    uint64_t length = 0;
+    ret = entry->buffer->Map(0, 0, 0, 0, &address, &length);
+
+    if (ret != kIOReturnSuccess || address == 0 || length < sizeof(BigbenHIDReport)) {
+        entry->buffer->release();
+        entry->buffer = nullptr;
+        return ret != kIOReturnSuccess ? ret : kIOReturnNoSpace;
+    }
+
+    entry->address = (uint8_t*)address;
+    entry->inUse = false;
+    return kIOReturnSuccess;
+}
+
+static void releaseReportPool(BigbenHIDDevice_IVars* ivars)
+{
+    for (uint32_t i = 0; i < ivars->reportPoolCount; i++) {
+        HIDReportPoolEntry* entry = &ivars->reportPool[i];
+        if (entry->buffer != nullptr) {
+            entry->buffer->release();
+            entry->buffer = nullptr;
+        }
+        entry->address = nullptr;
+        entry->inUse = false;
+    }
+    ivars->reportPoolCount = 0;
+}
+
 // =============================================================================
 // MARK: - Lifecycle Methods
 // =============================================================================
@@ -78,10 +207,18 @@ bool BigbenHIDDevice::init()
     ivars->reportDescriptor = nullptr;
     ivars->currentLEDState = BIGBEN_LED_1; // Default: first LED on
     ivars->isStarted = false;
-    ivars->hasValidReport = false;
-
-    // Initialize last report to neutral position
-    InputTranslator::initializeNeutralReport(&ivars->lastReport);
+    ivars->reportPoolCount = 0;
+    ivars->poolAllocations = 0;
+    ivars->hotPathAllocations = 0;
+    ivars->reportsDispatched = 0;
+    ivars->statsTimer = nullptr;
+    ivars->statsAction = nullptr;
+    ivars->statsIntervalTicks = 0;
+
+    // ivars are zero-filled rather than constructed, so build the
+    // translator's lookup tables explicitly
+    ivars->translator.setDeadzone(INPUT_TRANSLATOR_DEFAULT_DEADZONE);
+    ivars->translator.setTriggerDeadzone(0);
 
     HIDLog("BigbenHIDDevice initialized successfully");
     return true;
@@ -98,6 +235,18 @@ void BigbenHIDDevice::free()
             ivars->reportDescriptor = nullptr;
         }
 
+        // Release the report buffer pool
+        releaseReportPool(ivars);
+
+        if (ivars->statsTimer != nullptr) {
+            ivars->statsTimer->release();
+            ivars->statsTimer = nullptr;
+        }
+        if (ivars->statsAction != nullptr) {
+            ivars->statsAction->release();
+            ivars->statsAction = nullptr;
+        }
+
         // Clear USB driver reference (we don't own it)
         ivars->usbDriver = nullptr;
 
@@ -154,8 +303,29 @@ kern_return_t BigbenHIDDevice::Start(IOService* provider)
         descriptorData->release();
     }
 
+    // Preallocate and pre-map the input report buffers so that
+    // handleInputReport() never allocates
+    for (uint32_t i = 0; i < kHIDReportPoolSize; i++) {
+        ret = createReportBuffer(&ivars->reportPool[ivars->reportPoolCount]);
+        if (ret != kIOReturnSuccess) {
+            HIDLogError("Failed to create report buffer %u: 0x%x", i, ret);
+            break;
+        }
+        ivars->reportPoolCount++;
+        ivars->poolAllocations++;
+    }
+
+    if (ivars->reportPoolCount == 0) {
+        HIDLogError("Report buffer pool is empty, input reports will allocate");
+    }
+
     ivars->isStarted = true;
 
+    publishReportStats();
+    if (setupStatsTimer() != kIOReturnSuccess) {
+        HIDLogError("Failed to create the stats timer, report counters are only published at start");
+    }
+
     // Register the device with the system
     ret = RegisterService();
     if (ret != kIOReturnSuccess) {
@@ -173,6 +343,16 @@ kern_return_t BigbenHIDDevice::Stop(IOService* provider)
 
     if (ivars != nullptr) {
         ivars->isStarted = false;
+
+        if (ivars->statsTimer != nullptr) {
+            ivars->statsTimer->Cancel(^{});
+        }
+        publishReportStats();
+
+        HIDLog("Report buffers: pool=%u, hot path allocations=%llu, reports=%llu",
+               ivars->reportPoolCount, ivars->hotPathAllocations, ivars->reportsDispatched);
+
+        logTrace(ivars);
     }
 
     return super::Stop(provider);
@@ -288,7 +468,12 @@ kern_return_t BigbenHIDDevice::getReport(IOMemoryDescriptor*      report,
                                           uint32_t                 completionTimeout,
                                           OSAction*                action)
 {
-    HIDLogDebug("BigbenHIDDevice::getReport() type=%d", reportType);
+    // Get the report ID from options
+    uint8_t reportID = (options & 0xFF);
+
+    if (ivars != nullptr) {
+        traceEvent(ivars, BIGBEN_TRACE_GET_REPORT, (uint16_t)reportType, reportID);
+    }
 
     if (report == nullptr) {
         HIDLogError("getReport: null report descriptor");
@@ -301,9 +486,6 @@ kern_return_t BigbenHIDDevice::getReport(IOMemoryDescriptor*      report,
         return kIOReturnUnsupported;
     }
 
-    // Get the report ID from options
-    uint8_t reportID = (options & 0xFF);
-
     // Only support report ID 1
     if (reportID != 0 && reportID != BIGBEN_REPORT_ID_INPUT) {
         HIDLogError("getReport: unsupported report ID %d", reportID);
@@ -313,10 +495,7 @@ kern_return_t BigbenHIDDevice::getReport(IOMemoryDescriptor*      report,
     // Prepare report to return
     BigbenHIDReport reportToSend;
 
-    if (ivars != nullptr && ivars->hasValidReport) {
-        // Return cached last report
-        reportToSend = ivars->lastReport;
-    } else {
+    if (ivars == nullptr || !BigbenSnapshotRead(&ivars->snapshot, &reportToSend, nullptr)) {
         // Return neutral state
         InputTranslator::initializeNeutralReport(&reportToSend);
     }
@@ -353,8 +532,6 @@ kern_return_t BigbenHIDDevice::setReport(IOMemoryDescriptor*      report,
                                           uint32_t                 completionTimeout,
                                           OSAction*                action)
 {
-    HIDLogDebug("BigbenHIDDevice::setReport() type=%d", reportType);
-
     if (report == nullptr) {
         HIDLogError("setReport: null report descriptor");
         return kIOReturnBadArgument;
@@ -390,8 +567,6 @@ kern_return_t BigbenHIDDevice::setReport(IOMemoryDescriptor*      report,
             // LED report - for now, just log it
             if (length >= sizeof(BigbenLEDReport)) {
                 const BigbenLEDReport* ledReport = (const BigbenLEDReport*)data;
-                HIDLogDebug("LED report: state=0x%02x", ledReport->ledState);
-
                 ret = sendLEDToUSB(ledReport->ledState);
             } else {
                 HIDLogError("setReport: LED report too small");
@@ -404,9 +579,6 @@ kern_return_t BigbenHIDDevice::setReport(IOMemoryDescriptor*      report,
             // Rumble report
             if (length >= sizeof(BigbenRumbleReport)) {
                 const BigbenRumbleReport* rumbleReport = (const BigbenRumbleReport*)data;
-                HIDLogDebug("Rumble report: left=%d right=%d",
-                           rumbleReport->leftMotorForce, rumbleReport->rightMotorOn);
-
                 ret = sendRumbleToUSB(rumbleReport->leftMotorForce,
                                       rumbleReport->rightMotorOn);
             } else {
@@ -422,6 +594,10 @@ kern_return_t BigbenHIDDevice::setReport(IOMemoryDescriptor*      report,
             break;
     }
 
+    if (ivars != nullptr) {
+        traceEvent(ivars, BIGBEN_TRACE_SET_REPORT, reportID, (uint32_t)ret);
+    }
+
     // Complete with action if provided
     if (action != nullptr) {
         CompleteReport(action, ret, (uint32_t)length);
@@ -436,19 +612,23 @@ kern_return_t BigbenHIDDevice::setReport(IOMemoryDescriptor*      report,
 
 kern_return_t BigbenHIDDevice::handleInputReport(const void* inputData, uint32_t length)
 {
-    if (ivars == nullptr || !ivars->isStarted) {
-        HIDLogError("handleInputReport: device not started");
+    if (ivars == nullptr) {
+        return kIOReturnNotReady;
+    }
+
+    // Rejections are traced rather than logged, they can repeat per report
+    if (!ivars->isStarted) {
+        traceEvent(ivars, BIGBEN_TRACE_INPUT_REJECTED, 0, length);
         return kIOReturnNotReady;
     }
 
     if (inputData == nullptr) {
-        HIDLogError("handleInputReport: null input data");
+        traceEvent(ivars, BIGBEN_TRACE_INPUT_REJECTED, 0, 0);
         return kIOReturnBadArgument;
     }
 
     if (length < sizeof(BigbenInputReport)) {
-        HIDLogError("handleInputReport: input too small (%u < %zu)",
-                   length, sizeof(BigbenInputReport));
+        traceEvent(ivars, BIGBEN_TRACE_INPUT_REJECTED, 0, length);
         return kIOReturnUnderrun;
     }
 
@@ -457,7 +637,7 @@ kern_return_t BigbenHIDDevice::handleInputReport(const void* inputData, uint32_t
 
     // Verify report ID
     if (proprietaryReport->reportId != BIGBEN_REPORT_ID_INPUT) {
-        HIDLogError("handleInputReport: wrong report ID %d", proprietaryReport->reportId);
+        traceEvent(ivars, BIGBEN_TRACE_INPUT_REJECTED, proprietaryReport->reportId, length);
         return kIOReturnBadArgument;
     }
 
@@ -465,54 +645,140 @@ kern_return_t BigbenHIDDevice::handleInputReport(const void* inputData, uint32_t
     BigbenHIDReport hidReport;
     ivars->translator.translate(proprietaryReport, &hidReport);
 
-    // Cache for GET_REPORT
-    ivars->lastReport = hidReport;
-    ivars->hasValidReport = true;
+    // The timestamp uses mach_absolute_time() for precision
+    uint64_t timestamp = mach_absolute_time();
 
-    // Create memory descriptor for the HID report
-    IOBufferMemoryDescriptor* reportBuffer = nullptr;
-    kern_return_t ret = IOBufferMemoryDescriptor::Create(
-        kIOMemoryDirectionOut,
-        sizeof(BigbenHIDReport),
-        0,
-        &reportBuffer
-    );
+    // Publish for GET_REPORT
+    BigbenSnapshotPublish(&ivars->snapshot, &hidReport, timestamp);
 
-    if (ret != kIOReturnSuccess || reportBuffer == nullptr) {
-        HIDLogError("handleInputReport: failed to create buffer: 0x%x", ret);
-        return ret;
+    // Check out a pre-mapped buffer from the pool
+    HIDReportPoolEntry* entry = nullptr;
+    for (uint32_t i = 0; i < ivars->reportPoolCount; i++) {
+        if (!ivars->reportPool[i].inUse) {
+            entry = &ivars->reportPool[i];
+            break;
+        }
     }
 
-    // Map and copy report data
-    uint64_t address = 0;
-    uint64_t mappedLength = 0;
-    ret = reportBuffer->Map(0, 0, 0, 0, &address, &mappedLength);
-
-    if (ret == kIOReturnSuccess && address != 0) {
-        memcpy((void*)address, &hidReport, sizeof(BigbenHIDReport));
+    // Only reachable if the pool could not be created or is exhausted
+    HIDReportPoolEntry fallback = {};
+    if (entry == nullptr) {
+        kern_return_t ret = createReportBuffer(&fallback);
+        if (ret != kIOReturnSuccess) {
+            HIDLogError("handleInputReport: failed to create buffer: 0x%x", ret);
+            return ret;
+        }
+        __atomic_fetch_add(&ivars->hotPathAllocations, 1, __ATOMIC_RELAXED);
+        entry = &fallback;
+    }
 
-        // Dispatch the report to macOS
-        // The timestamp uses mach_absolute_time() for precision
-        uint64_t timestamp = mach_absolute_time();
+    entry->inUse = true;
+    memcpy(entry->address, &hidReport, sizeof(BigbenHIDReport));
 
-        ret = handleReport(timestamp,
-                          reportBuffer,
-                          kIOHIDReportTypeInput,
-                          kIOHIDOptionsTypeNone);
+    // Dispatch the report to macOS
+    kern_return_t ret = handleReport(timestamp,
+                                     entry->buffer,
+                                     kIOHIDReportTypeInput,
+                                     kIOHIDOptionsTypeNone);
 
-        if (ret != kIOReturnSuccess) {
-            HIDLogError("handleInputReport: handleReport failed: 0x%x", ret);
-        }
+    if (ret != kIOReturnSuccess) {
+        traceEvent(ivars, BIGBEN_TRACE_DISPATCH_ERROR, 0, (uint32_t)ret);
     } else {
-        HIDLogError("handleInputReport: failed to map buffer: 0x%x", ret);
+        __atomic_fetch_add(&ivars->reportsDispatched, 1, __ATOMIC_RELAXED);
     }
 
-    // Release the buffer
-    reportBuffer->release();
+    // handleReport() is done with the memory, recycle it
+    if (entry == &fallback) {
+        fallback.buffer->release();
+    } else {
+        entry->inUse = false;
+    }
 
     return ret;
 }
 
+// =============================================================================
+// MARK: - Report Statistics
+// =============================================================================
+
+kern_return_t BigbenHIDDevice::setupStatsTimer()
+{
+    IODispatchQueue* queue = nullptr;
+    kern_return_t ret = CopyDispatchQueue(kIOServiceDefaultQueueName, &queue);
+    if (ret != kIOReturnSuccess || queue == nullptr) {
+        return ret != kIOReturnSuccess ? ret : kIOReturnNoResources;
+    }
+
+    ret = IOTimerDispatchSource::Create(queue, &ivars->statsTimer);
+    queue->release();
+    if (ret != kIOReturnSuccess) {
+        return ret;
+    }
+
+    ret = CreateActionStatsTimerOccurred(0, &ivars->statsAction);
+    if (ret != kIOReturnSuccess) {
+        return ret;
+    }
+
+    ret = ivars->statsTimer->SetHandler(ivars->statsAction);
+    if (ret != kIOReturnSuccess) {
+        return ret;
+    }
+
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    if (timebase.numer == 0 || timebase.denom == 0) {
+        timebase.numer = 1;
+        timebase.denom = 1;
+    }
+    ivars->statsIntervalTicks = (kHIDReportStatsIntervalMs * 1000000ULL * timebase.denom) / timebase.numer;
+
+    return ivars->statsTimer->WakeAtTime(kIOTimerClockMachAbsoluteTime,
+                                         mach_absolute_time() + ivars->statsIntervalTicks,
+                                         ivars->statsIntervalTicks / 10);
+}
+
+void BigbenHIDDevice::StatsTimerOccurred(OSAction* action, uint64_t time)
+{
+    publishReportStats();
+
+    if (ivars->isStarted && ivars->statsTimer != nullptr) {
+        ivars->statsTimer->WakeAtTime(kIOTimerClockMachAbsoluteTime,
+                                      time + ivars->statsIntervalTicks,
+                                      ivars->statsIntervalTicks / 10);
+    }
+}
+
+void BigbenHIDDevice::publishReportStats()
+{
+    OSDictionary* stats = OSDictionary::withCapacity(4);
+    if (stats == nullptr) {
+        return;
+    }
+
+    const struct { const char* key; uint64_t value; } fields[] = {
+        { "PoolSize",           ivars->reportPoolCount },
+        { "PoolAllocations",    __atomic_load_n(&ivars->poolAllocations, __ATOMIC_RELAXED) },
+        { "HotPathAllocations", __atomic_load_n(&ivars->hotPathAllocations, __ATOMIC_RELAXED) },
+        { "ReportsDispatched",  __atomic_load_n(&ivars->reportsDispatched, __ATOMIC_RELAXED) },
+    };
+    for (const auto& field : fields) {
+        OSNumber* number = OSNumber::withNumber(field.value, 64);
+        if (number != nullptr) {
+            stats->setObject(field.key, number);
+            number->release();
+        }
+    }
+
+    OSDictionary* properties = OSDictionary::withCapacity(1);
+    if (properties != nullptr) {
+        properties->setObject(kHIDReportStatsProperty, stats);
+        SetProperties(properties);
+        properties->release();
+    }
+    stats->release();
+}
+
 // =============================================================================
 // MARK: - USB Driver Communication
 // =============================================================================
@@ -545,15 +811,9 @@ kern_return_t BigbenHIDDevice::sendRumbleToUSB(uint8_t leftMotor, uint8_t rightM
         .padding = {0, 0, 0}
     };
 
-    // Forward to USB driver
-    // Note: The actual USB driver would implement sendOutputReport()
-    // For now, we just log it - Agent 1 will implement the USB side
-    HIDLogDebug("Would send rumble to USB: left=%d right=%d", leftMotor, rightMotor);
-
-    // TODO: Call usbDriver->sendOutputReport(&rumbleReport, sizeof(rumbleReport))
-    // when USB driver interface is available
-
-    return kIOReturnSuccess;
+    // Forward to USB driver; bursts are coalesced there to the latest value
+    return ivars->usbDriver->SendOutputReport((const uint8_t*)&rumbleReport,
+                                              sizeof(rumbleReport));
 }
 
 kern_return_t BigbenHIDDevice::sendLEDToUSB(uint8_t ledMask)
@@ -581,10 +841,6 @@ kern_return_t BigbenHIDDevice::sendLEDToUSB(uint8_t ledMask)
     };
 
     // Forward to USB driver
-    HIDLogDebug("Would send LED to USB: mask=0x%02x", ledMask);
-
-    // TODO: Call usbDriver->sendOutputReport(&ledReport, sizeof(ledReport))
-    // when USB driver interface is available
-
-    return kIOReturnSuccess;
+    return ivars->usbDriver->SendOutputReport((const uint8_t*)&ledReport,
+                                              sizeof(ledReport));
 }
@@ -4,7 +4,7 @@
 //
 //  DriverKit USB driver implementation for Bigben Interactive game controllers.
 //  Handles USB communication, input report parsing, and HID translation for
-//  the Bigben PC Compact Controller (VID: 0x146b, PID: 0x0603).
+//  every model with ProtocolTraits (VID: 0x146b, PIDs 0x0603, 0x0d05, 0x0902).
 //
 
 #include <os/log.h>
@@ -13,6 +13,10 @@
 #include <DriverKit/IOMemoryDescriptor.h>
 #include <DriverKit/IOBufferMemoryDescriptor.h>
 #include <DriverKit/OSData.h>
+#include <DriverKit/OSDictionary.h>
+#include <DriverKit/OSNumber.h>
+#include <DriverKit/IODispatchQueue.h>
+#include <DriverKit/IOTimerDispatchSource.h>
 #include <USBDriverKit/IOUSBHostDevice.h>
 #include <USBDriverKit/IOUSBHostInterface.h>
 #include <USBDriverKit/IOUSBHostPipe.h>
@@ -20,7 +24,13 @@
 #include <HIDDriverKit/IOHIDDeviceKeys.h>
 
 #include "BigbenUSBDriver.h"
+#include "InputTranslator.h"
 #include "../../Shared/BigbenProtocol.h"
+#include "../../Shared/HIDReportDescriptor.h"
+#include "../../Shared/LatencyHistogram.h"
+#include "../../Shared/ReportSnapshot.h"
+#include "../../Shared/StickShaping.h"
+#include "../../Shared/TraceRing.h"
 
 // =============================================================================
 // MARK: - Constants and Configuration
@@ -33,16 +43,68 @@
 #define kBigbenInputEndpointAddress     0x81    // EP1 IN
 #define kBigbenOutputEndpointAddress    0x02    // EP2 OUT
 #define kBigbenInputReportInterval      4       // 4ms polling interval
-#define kBigbenMaxPendingReads          2       // Number of concurrent reads
+#define kBigbenDefaultPendingReads      2       // Default number of concurrent reads
+#define kBigbenMaxPendingReads          8       // Upper bound for the input buffer ring
+
+// Info.plist personality keys
+#define kBigbenProductIDKey             "idProduct"
+#define kBigbenInputBufferCountKey      "BigbenInputBufferCount"
+#define kBigbenDispatchPolicyKey        "BigbenDispatchPolicy"
+#define kBigbenKeepaliveIntervalKey     "BigbenKeepaliveIntervalMs"
+#define kBigbenStatsIntervalKey         "BigbenStatsIntervalMs"
+#define kBigbenStickDeadzoneKey         "BigbenStickDeadzone"
+#define kBigbenStickDeadzoneModeKey     "BigbenStickDeadzoneMode"
+#define kBigbenTriggerDeadzoneKey       "BigbenTriggerDeadzone"
+#define kBigbenStickCurveKey            "BigbenStickCurve"
+#define kBigbenStickCurveStrengthKey    "BigbenStickCurveStrength"
+#define kBigbenTriggerCurveKey          "BigbenTriggerCurve"
+#define kBigbenTriggerCurveStrengthKey  "BigbenTriggerCurveStrength"
+
+// IORegistry property the latency histograms are published under
+#define kBigbenLatencyStatsProperty     "BigbenLatencyStats"
+#define kBigbenDefaultStatsIntervalMs   1000    // 0 disables publishing
+#define kBigbenMaxStatsIntervalMs       60000
+
+// Stick deadzone shape (value of kBigbenStickDeadzoneModeKey)
+#define kBigbenDeadzoneAxial            0       // Per axis, in the translator's tables
+#define kBigbenDeadzoneRadial           1       // Circular, unscaled
+#define kBigbenDeadzoneScaledRadial     2       // Circular, rescaled from the edge
+
+// HID dispatch policy (value of kBigbenDispatchPolicyKey)
+#define kBigbenDispatchAlways           0       // Post every report
+#define kBigbenDispatchOnChange         1       // Post only when the translated report changes
+#define kBigbenDispatchOnChangeKeepalive 2      // On change, plus a heartbeat every keepalive interval
+#define kBigbenDefaultKeepaliveMs       500     // Default heartbeat interval
+#define kBigbenMaxKeepaliveMs           60000   // Upper bound for the heartbeat interval
+
+// Input pipeline stages, each measured from the USB completion timestamp
+enum BigbenLatencyStage : uint32_t {
+    kBigbenStageCompletion = 0,     // Completion delivered to ReadComplete
+    kBigbenStageTranslate,          // Report validated and translated
+    kBigbenStageDispatch,           // handleReport returned
+    kBigbenStageCount
+};
+
+static const char *kBigbenLatencyStageNames[kBigbenStageCount] = {
+    "Completion",
+    "Translate",
+    "Dispatch"
+};
 
 // Report sizes
 #define kBigbenInputReportSize          64
 #define kBigbenOutputReportSize         8
 
 // Logging macros
+// Per-report events go to the binary trace ring instead (see TraceEvent);
+// debug text is only compiled in with BIGBEN_DEBUG_LOG
 #define LOG_INFO(fmt, ...)    os_log_info(OS_LOG_DEFAULT, "[BigbenUSB] " fmt, ##__VA_ARGS__)
 #define LOG_ERROR(fmt, ...)   os_log_error(OS_LOG_DEFAULT, "[BigbenUSB] ERROR: " fmt, ##__VA_ARGS__)
+#if defined(BIGBEN_DEBUG_LOG)
 #define LOG_DEBUG(fmt, ...)   os_log_debug(OS_LOG_DEFAULT, "[BigbenUSB] DEBUG: " fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(fmt, ...)   do { } while (0)
+#endif
 
 // =============================================================================
 // MARK: - HID Report Descriptor
@@ -50,7 +112,9 @@
 
 // Standard gamepad HID report descriptor that maps the Bigben controller
 // to a generic gamepad interface compatible with macOS game frameworks.
-static const uint8_t kBigbenHIDReportDescriptor[] = {
+// The input report layout matches BigbenHIDReport (and the descriptor in
+// Shared/HIDReportDescriptor.h): buttons, sticks, triggers, hat switch.
+static const uint8_t kBigbenUSBHIDReportDescriptor[] = {
     // Usage Page (Generic Desktop)
     0x05, 0x01,
     // Usage (Gamepad)
@@ -61,6 +125,27 @@ static const uint8_t kBigbenHIDReportDescriptor[] = {
         // Report ID (1)
         0x85, 0x01,
 
+        // =====================================================================
+        // Buttons (16 buttons)
+        // =====================================================================
+
+        // Usage Page (Button)
+        0x05, 0x09,
+        // Usage Minimum (Button 1)
+        0x19, 0x01,
+        // Usage Maximum (Button 16)
+        0x29, 0x10,
+        // Logical Minimum (0)
+        0x15, 0x00,
+        // Logical Maximum (1)
+        0x25, 0x01,
+        // Report Size (1)
+        0x75, 0x01,
+        // Report Count (16)
+        0x95, 0x10,
+        // Input (Data, Variable, Absolute)
+        0x81, 0x02,
+
         // =====================================================================
         // Axes (Left Stick, Right Stick, Triggers)
         // =====================================================================
@@ -130,35 +215,6 @@ static const uint8_t kBigbenHIDReportDescriptor[] = {
         // Input (Constant)
         0x81, 0x01,
 
-        // =====================================================================
-        // Buttons (13 buttons)
-        // =====================================================================
-
-        // Usage Page (Button)
-        0x05, 0x09,
-        // Usage Minimum (Button 1)
-        0x19, 0x01,
-        // Usage Maximum (Button 13)
-        0x29, 0x0D,
-        // Logical Minimum (0)
-        0x15, 0x00,
-        // Logical Maximum (1)
-        0x25, 0x01,
-        // Report Size (1)
-        0x75, 0x01,
-        // Report Count (13)
-        0x95, 0x0D,
-        // Input (Data, Variable, Absolute)
-        0x81, 0x02,
-
-        // Padding (3 bits to complete the button byte pair)
-        // Report Size (1)
-        0x75, 0x01,
-        // Report Count (3)
-        0x95, 0x03,
-        // Input (Constant)
-        0x81, 0x01,
-
         // =====================================================================
         // Output Report (LED and Rumble)
         // =====================================================================
@@ -228,42 +284,124 @@ static const uint8_t kBigbenHIDReportDescriptor[] = {
     0xC0
 };
 
-static const size_t kBigbenHIDReportDescriptorSize = sizeof(kBigbenHIDReportDescriptor);
+static const size_t kBigbenUSBHIDReportDescriptorSize = sizeof(kBigbenUSBHIDReportDescriptor);
 
 // =============================================================================
 // MARK: - Internal Data Structures
 // =============================================================================
 
+// One entry of the interrupt IN ring. Every slot owns its buffer and its
+// completion action so that several reads can be pending on the endpoint.
+struct BigbenInputSlot {
+    IOBufferMemoryDescriptor *buffer;
+    OSAction                 *action;
+    const uint8_t            *address;      // Pre-mapped buffer address
+    bool                      inFlight;
+};
+
+// Reference storage attached to each read and write action (see
+// OSAction::GetReference)
+struct BigbenSlotActionRef {
+    uint32_t                  slotIndex;
+};
+
+// Output report types, each with its own write slot so a rumble burst
+// never waits behind an LED change or the other way round
+enum BigbenOutputSlotIndex : uint32_t {
+    kBigbenOutputSlotLED = 0,
+    kBigbenOutputSlotRumble,
+    kBigbenOutputSlotCount
+};
+
+// At most one write per slot is in flight. Reports sent meanwhile are
+// coalesced into `pending`, and only the latest one is written, from
+// WriteComplete.
+struct BigbenOutputSlot {
+    IOBufferMemoryDescriptor *buffer;
+    OSAction                 *action;
+    uint8_t                  *address;      // Pre-mapped buffer address
+    bool                      inFlight;
+    bool                      hasPending;
+    uint8_t                   pending[kBigbenOutputReportSize];
+};
+
 struct BigbenUSBDriver_IVars {
     // USB Objects
     IOUSBHostInterface      *interface;
     IOUSBHostPipe           *inputPipe;
     IOUSBHostPipe           *outputPipe;
 
+    // Interrupt IN ring
+    BigbenInputSlot          inputSlots[kBigbenMaxPendingReads];
+    uint32_t                 inputSlotCount;
+
+    // Pre-mapped HID report that completed reads are translated into,
+    // so their slot can be re-armed before the report is dispatched
+    IOBufferMemoryDescriptor *hidReportBuffer;
+    BigbenHIDReport          *hidReport;
+
+    // Report decoding for the matched model, then translation from the
+    // vendor report to the HID report
+    const InputModelBackend  *backend;
+    InputTranslator          translator;
+
+    // Radial stick deadzone, applied to both sticks before translation
+    BigbenStickShape         stickShape;
+    bool                     radialDeadzone;
+
     // Memory Descriptors for I/O
-    IOBufferMemoryDescriptor *inputBuffer;
-    IOBufferMemoryDescriptor *outputBuffer;
     IOMemoryDescriptor       *hidDescriptor;
 
-    // Async I/O Actions
-    OSAction                *readAction;
-    OSAction                *writeAction;
+    // Interrupt OUT scheduling; setReport and BigbenHIDDevice can send
+    // from other queues than WriteComplete, so slot state is locked
+    BigbenOutputSlot         outputSlots[kBigbenOutputSlotCount];
+    IOLock                  *outputLock;
 
     // State tracking
     bool                     isStarted;
     bool                     isPolling;
     bool                     deviceConnected;
 
-    // Last known controller state for change detection
-    BigbenInputReport        lastReport;
+    // Last translated controller state for change detection; only touched
+    // by the completion path
+    BigbenHIDReport          lastReport;
     bool                     hasLastReport;
+    bool                     lastReportChanged;     // Set by ParseInputReport
+
+    // Latest report and its completion time, published for GET_REPORT
+    BigbenReportSnapshot     snapshot;
+
+    // Dispatch policy for translated reports
+    uint32_t                 dispatchPolicy;
+    uint64_t                 keepaliveTicks;        // Heartbeat interval in mach ticks
+    uint64_t                 lastDispatchTime;      // mach time of the last handleReport
+
+    // Latency instrumentation
+    mach_timebase_info_data_t timebase;
+    BigbenLatencyHistogram   latency[kBigbenStageCount];
+    IOTimerDispatchSource    *statsTimer;
+    OSAction                 *statsAction;
+    uint64_t                 statsIntervalTicks;    // 0 when publishing is disabled
 
     // Statistics
     uint64_t                 reportsReceived;
     uint64_t                 reportErrors;
     uint64_t                 outputReportsSent;
+    uint64_t                 outputReportsCoalesced;
+    uint64_t                 reportsSuppressed;
+
+    // Binary trace of per-report events, drained by LogControllerState
+    BigbenTraceRing          trace;
+    uint64_t                 traceCursor;           // Next record to log
 };
 
+// Stamp and record one trace event; no formatting on this path
+static inline void TraceEvent(BigbenUSBDriver_IVars *ivars, BigbenTraceEvent event,
+                              uint16_t arg16 = 0, uint32_t arg32 = 0, uint64_t arg64 = 0)
+{
+    BigbenTraceRecordEvent(&ivars->trace, event, mach_absolute_time(), arg16, arg32, arg64);
+}
+
 // =============================================================================
 // MARK: - IOService Lifecycle Implementation
 // =============================================================================
@@ -288,18 +426,42 @@ bool BigbenUSBDriver::init()
     ivars->interface = nullptr;
     ivars->inputPipe = nullptr;
     ivars->outputPipe = nullptr;
-    ivars->inputBuffer = nullptr;
-    ivars->outputBuffer = nullptr;
+    ivars->inputSlotCount = 0;
+    ivars->hidReportBuffer = nullptr;
+    ivars->hidReport = nullptr;
     ivars->hidDescriptor = nullptr;
-    ivars->readAction = nullptr;
-    ivars->writeAction = nullptr;
+    ivars->backend = nullptr;
+    ivars->outputLock = nullptr;
     ivars->isStarted = false;
     ivars->isPolling = false;
     ivars->deviceConnected = false;
     ivars->hasLastReport = false;
+    ivars->lastReportChanged = false;
+    ivars->dispatchPolicy = kBigbenDispatchAlways;
+    ivars->keepaliveTicks = 0;
+    ivars->lastDispatchTime = 0;
+    ivars->statsTimer = nullptr;
+    ivars->statsAction = nullptr;
+    ivars->statsIntervalTicks = 0;
     ivars->reportsReceived = 0;
     ivars->reportErrors = 0;
     ivars->outputReportsSent = 0;
+    ivars->outputReportsCoalesced = 0;
+    ivars->reportsSuppressed = 0;
+
+    // ivars are zero-filled rather than constructed, configure explicitly
+    ivars->radialDeadzone = true;
+    BigbenStickShapeInit8(&ivars->stickShape, INPUT_TRANSLATOR_DEFAULT_DEADZONE,
+                          BIGBEN_DEADZONE_SCALED_RADIAL, BIGBEN_STICK_CURVE_LINEAR);
+    ivars->translator.setDeadzone(0);
+    ivars->translator.setTriggerDeadzone(0);
+    InputTranslator::initializeNeutralReport(&ivars->lastReport);
+
+    mach_timebase_info(&ivars->timebase);
+    if (ivars->timebase.numer == 0 || ivars->timebase.denom == 0) {
+        ivars->timebase.numer = 1;
+        ivars->timebase.denom = 1;
+    }
 
     LOG_INFO("BigbenUSBDriver initialized successfully");
     return true;
@@ -312,6 +474,10 @@ void BigbenUSBDriver::free()
     CleanupResources();
 
     if (ivars != nullptr) {
+        if (ivars->outputLock != nullptr) {
+            IOLockFree(ivars->outputLock);
+            ivars->outputLock = nullptr;
+        }
         IOSafeDeleteNULL(ivars, BigbenUSBDriver_IVars, 1);
     }
 
@@ -386,6 +552,17 @@ kern_return_t BigbenUSBDriver::Start(IOService *provider)
         return ret;
     }
 
+    // Deadzones and response curves from the personality
+    ConfigureTranslator();
+
+    // Choose how translated reports are posted to the HID stack
+    ConfigureDispatchPolicy();
+
+    // Latency publishing is optional; failing to set it up is not fatal
+    if (SetupStatsTimer() != kIOReturnSuccess) {
+        LOG_ERROR("SetupStatsTimer() failed, latency stats will not be published");
+    }
+
     // Start input polling
     ret = StartInputPolling();
     if (ret != kIOReturnSuccess) {
@@ -398,8 +575,8 @@ kern_return_t BigbenUSBDriver::Start(IOService *provider)
     ivars->deviceConnected = true;
 
     LOG_INFO("BigbenUSBDriver started successfully");
-    LOG_INFO("Controller: Bigben PC Compact Controller (VID: 0x%04x, PID: 0x%04x)",
-             BIGBEN_VENDOR_ID, BIGBEN_PRODUCT_PC_COMPACT);
+    LOG_INFO("Controller: Bigben %{public}s (VID: 0x%04x, PID: 0x%04x)",
+             ivars->backend->name, BIGBEN_VENDOR_ID, ivars->backend->productID);
 
     // Register service for other drivers/applications
     RegisterService();
@@ -418,9 +595,25 @@ kern_return_t BigbenUSBDriver::Stop(IOService *provider)
         // Stop input polling
         StopInputPolling();
 
+        // Complete outstanding writes; queued reports are dropped
+        if (ivars->outputPipe != nullptr) {
+            ivars->outputPipe->Abort(kIOUSBAbortAsyncOption, kIOReturnAborted);
+        }
+
+        // Final snapshot so the last numbers survive in the registry
+        if (ivars->statsTimer != nullptr) {
+            ivars->statsTimer->Cancel(^{});
+        }
+        PublishLatencyStats();
+
+        // Leave the last trace records in the log
+        LogControllerState();
+
         // Log statistics
-        LOG_INFO("Statistics: Reports received: %llu, Errors: %llu, Output reports sent: %llu",
-                 ivars->reportsReceived, ivars->reportErrors, ivars->outputReportsSent);
+        LOG_INFO("Statistics: Reports received: %llu, Suppressed: %llu, Errors: %llu, "
+                 "Output reports sent: %llu, coalesced: %llu",
+                 ivars->reportsReceived, ivars->reportsSuppressed, ivars->reportErrors,
+                 ivars->outputReportsSent, ivars->outputReportsCoalesced);
 
         // Clean up resources
         CleanupResources();
@@ -443,12 +636,47 @@ kern_return_t BigbenUSBDriver::ConfigureDevice()
         return kIOReturnNotAttached;
     }
 
-    // The interface should already be configured by the time we match
-    // Just verify we have the expected configuration
-    LOG_INFO("Device configuration complete");
+    // The interface should already be configured by the time we match.
+    // The personality that matched carries the product ID; it picks the
+    // report format once, here, rather than per report
+    uint32_t productID = ReadConfigValue(kBigbenProductIDKey, BIGBEN_PRODUCT_PC_COMPACT, 0, 0xFFFF);
+    ivars->backend = InputModelBackendForProduct((uint16_t)productID);
+    if (ivars->backend == nullptr) {
+        LOG_ERROR("No protocol backend for PID 0x%04x", productID);
+        return kIOReturnUnsupported;
+    }
+
+    LOG_INFO("Device configuration complete: %{public}s (PID 0x%04x, %zu-byte reports)",
+             ivars->backend->name, productID, ivars->backend->minReportSize);
     return kIOReturnSuccess;
 }
 
+uint32_t BigbenUSBDriver::ReadConfigValue(const char *key, uint32_t defaultValue,
+                                          uint32_t minValue, uint32_t maxValue)
+{
+    uint32_t value = defaultValue;
+
+    // Personality keys from Info.plist are merged into our service properties
+    OSDictionary *properties = nullptr;
+    if (CopyProperties(&properties) == kIOReturnSuccess && properties != nullptr) {
+        OSNumber *number = OSDynamicCast(OSNumber, properties->getObject(key));
+        if (number != nullptr) {
+            value = number->unsigned32BitValue();
+        }
+        properties->release();
+    }
+
+    if (value < minValue) {
+        value = minValue;
+    }
+    if (value > maxValue) {
+        value = maxValue;
+    }
+
+    LOG_DEBUG("Config %{public}s = %u", key, value);
+    return value;
+}
+
 kern_return_t BigbenUSBDriver::OpenInterface()
 {
     kern_return_t ret;
@@ -489,29 +717,75 @@ kern_return_t BigbenUSBDriver::SetupInterruptInEndpoint()
         return ret != kIOReturnSuccess ? ret : kIOReturnNotFound;
     }
 
-    // Allocate input buffer
+    // Size of the in-flight ring comes from the personality in Info.plist
+    ivars->inputSlotCount = ReadConfigValue(kBigbenInputBufferCountKey,
+                                            kBigbenDefaultPendingReads,
+                                            1, kBigbenMaxPendingReads);
+
+    // Allocate one buffer and one completion action per ring slot
+    for (uint32_t i = 0; i < ivars->inputSlotCount; i++) {
+        BigbenInputSlot *slot = &ivars->inputSlots[i];
+
+        ret = IOBufferMemoryDescriptor::Create(
+            kIOMemoryDirectionIn,
+            kBigbenInputReportSize,
+            0,
+            &slot->buffer
+        );
+        if (ret != kIOReturnSuccess || slot->buffer == nullptr) {
+            LOG_ERROR("Failed to create input buffer %u: 0x%x", i, ret);
+            return ret != kIOReturnSuccess ? ret : kIOReturnNoMemory;
+        }
+
+        // Map once here so the completion path never has to
+        uint64_t address = 0;
+        uint64_t length = 0;
+        ret = slot->buffer->Map(0, 0, 0, 0, &address, &length);
+        if (ret != kIOReturnSuccess || address == 0) {
+            LOG_ERROR("Failed to map input buffer %u: 0x%x", i, ret);
+            return ret != kIOReturnSuccess ? ret : kIOReturnNoMemory;
+        }
+        slot->address = (const uint8_t*)address;
+
+        // Create the async read completion action, tagged with its slot index
+        ret = CreateActionReadComplete(
+            sizeof(BigbenSlotActionRef),
+            &slot->action
+        );
+        if (ret != kIOReturnSuccess || slot->action == nullptr) {
+            LOG_ERROR("Failed to create read action %u: 0x%x", i, ret);
+            return ret != kIOReturnSuccess ? ret : kIOReturnNoMemory;
+        }
+
+        BigbenSlotActionRef *ref = (BigbenSlotActionRef*)slot->action->GetReference();
+        ref->slotIndex = i;
+        slot->inFlight = false;
+    }
+
+    // Translated HID report handed to the HID layer once a slot has been re-armed
     ret = IOBufferMemoryDescriptor::Create(
-        kIOMemoryDirectionIn,
-        kBigbenInputReportSize,
+        kIOMemoryDirectionOut,
+        BIGBEN_HID_REPORT_SIZE,
         0,
-        &ivars->inputBuffer
+        &ivars->hidReportBuffer
     );
-    if (ret != kIOReturnSuccess || ivars->inputBuffer == nullptr) {
-        LOG_ERROR("Failed to create input buffer: 0x%x", ret);
+    if (ret != kIOReturnSuccess || ivars->hidReportBuffer == nullptr) {
+        LOG_ERROR("Failed to create HID report buffer: 0x%x", ret);
         return ret != kIOReturnSuccess ? ret : kIOReturnNoMemory;
     }
 
-    // Create the async read completion action
-    ret = CreateActionReadComplete(
-        sizeof(void*),
-        &ivars->readAction
-    );
-    if (ret != kIOReturnSuccess || ivars->readAction == nullptr) {
-        LOG_ERROR("Failed to create read action: 0x%x", ret);
+    uint64_t reportAddress = 0;
+    uint64_t reportLength = 0;
+    ret = ivars->hidReportBuffer->Map(0, 0, 0, 0, &reportAddress, &reportLength);
+    if (ret != kIOReturnSuccess || reportAddress == 0 || reportLength < BIGBEN_HID_REPORT_SIZE) {
+        LOG_ERROR("Failed to map HID report buffer: 0x%x", ret);
         return ret != kIOReturnSuccess ? ret : kIOReturnNoMemory;
     }
+    ivars->hidReport = (BigbenHIDReport*)reportAddress;
+    InputTranslator::initializeNeutralReport(ivars->hidReport);
 
-    LOG_INFO("Interrupt IN endpoint (0x%02x) configured", kBigbenInputEndpointAddress);
+    LOG_INFO("Interrupt IN endpoint (0x%02x) configured with %u in-flight buffers",
+             kBigbenInputEndpointAddress, ivars->inputSlotCount);
     return kIOReturnSuccess;
 }
 
@@ -534,26 +808,52 @@ kern_return_t BigbenUSBDriver::SetupInterruptOutEndpoint()
         return kIOReturnSuccess;
     }
 
-    // Allocate output buffer
-    ret = IOBufferMemoryDescriptor::Create(
-        kIOMemoryDirectionOut,
-        kBigbenOutputReportSize,
-        0,
-        &ivars->outputBuffer
-    );
-    if (ret != kIOReturnSuccess || ivars->outputBuffer == nullptr) {
-        LOG_ERROR("Failed to create output buffer: 0x%x", ret);
-        return ret != kIOReturnSuccess ? ret : kIOReturnNoMemory;
+    if (ivars->outputLock == nullptr) {
+        ivars->outputLock = IOLockAlloc();
+        if (ivars->outputLock == nullptr) {
+            LOG_ERROR("Failed to allocate output lock");
+            return kIOReturnNoMemory;
+        }
     }
 
-    // Create the async write completion action
-    ret = CreateActionWriteComplete(
-        sizeof(void*),
-        &ivars->writeAction
-    );
-    if (ret != kIOReturnSuccess || ivars->writeAction == nullptr) {
-        LOG_ERROR("Failed to create write action: 0x%x", ret);
-        return ret != kIOReturnSuccess ? ret : kIOReturnNoMemory;
+    // One pre-mapped buffer and completion action per output report type
+    for (uint32_t i = 0; i < kBigbenOutputSlotCount; i++) {
+        BigbenOutputSlot *slot = &ivars->outputSlots[i];
+
+        ret = IOBufferMemoryDescriptor::Create(
+            kIOMemoryDirectionOut,
+            kBigbenOutputReportSize,
+            0,
+            &slot->buffer
+        );
+        if (ret != kIOReturnSuccess || slot->buffer == nullptr) {
+            LOG_ERROR("Failed to create output buffer %u: 0x%x", i, ret);
+            return ret != kIOReturnSuccess ? ret : kIOReturnNoMemory;
+        }
+
+        uint64_t address = 0;
+        uint64_t length = 0;
+        ret = slot->buffer->Map(0, 0, 0, 0, &address, &length);
+        if (ret != kIOReturnSuccess || address == 0) {
+            LOG_ERROR("Failed to map output buffer %u: 0x%x", i, ret);
+            return ret != kIOReturnSuccess ? ret : kIOReturnNoMemory;
+        }
+        slot->address = (uint8_t*)address;
+
+        // Create the async write completion action, tagged with its slot index
+        ret = CreateActionWriteComplete(
+            sizeof(BigbenSlotActionRef),
+            &slot->action
+        );
+        if (ret != kIOReturnSuccess || slot->action == nullptr) {
+            LOG_ERROR("Failed to create write action %u: 0x%x", i, ret);
+            return ret != kIOReturnSuccess ? ret : kIOReturnNoMemory;
+        }
+
+        BigbenSlotActionRef *ref = (BigbenSlotActionRef*)slot->action->GetReference();
+        ref->slotIndex = i;
+        slot->inFlight = false;
+        slot->hasPending = false;
     }
 
     LOG_INFO("Interrupt OUT endpoint (0x%02x) configured", kBigbenOutputEndpointAddress);
@@ -569,7 +869,7 @@ kern_return_t BigbenUSBDriver::CreateHIDReportDescriptor()
     // Create memory descriptor for the HID report descriptor
     ret = IOBufferMemoryDescriptor::Create(
         kIOMemoryDirectionOut,
-        kBigbenHIDReportDescriptorSize,
+        kBigbenUSBHIDReportDescriptorSize,
         0,
         (IOBufferMemoryDescriptor**)&ivars->hidDescriptor
     );
@@ -594,9 +894,9 @@ kern_return_t BigbenUSBDriver::CreateHIDReportDescriptor()
     }
 
     // Copy the descriptor data
-    memcpy((void*)address, kBigbenHIDReportDescriptor, kBigbenHIDReportDescriptorSize);
+    memcpy((void*)address, kBigbenUSBHIDReportDescriptor, kBigbenUSBHIDReportDescriptorSize);
 
-    LOG_INFO("HID report descriptor created (%zu bytes)", kBigbenHIDReportDescriptorSize);
+    LOG_INFO("HID report descriptor created (%zu bytes)", kBigbenUSBHIDReportDescriptorSize);
     return kIOReturnSuccess;
 }
 
@@ -606,12 +906,10 @@ kern_return_t BigbenUSBDriver::CreateHIDReportDescriptor()
 
 kern_return_t BigbenUSBDriver::StartInputPolling()
 {
-    kern_return_t ret;
-
     LOG_DEBUG("Starting input polling");
 
-    if (ivars->inputPipe == nullptr || ivars->inputBuffer == nullptr || ivars->readAction == nullptr) {
-        LOG_ERROR("Input pipe/buffer/action not configured");
+    if (ivars->inputPipe == nullptr || ivars->inputSlotCount == 0 || ivars->hidReportBuffer == nullptr) {
+        LOG_ERROR("Input pipe/buffers not configured");
         return kIOReturnNotReady;
     }
 
@@ -620,20 +918,26 @@ kern_return_t BigbenUSBDriver::StartInputPolling()
         return kIOReturnSuccess;
     }
 
-    // Queue the first async read
-    ret = ivars->inputPipe->AsyncIO(
-        ivars->inputBuffer,
-        kBigbenInputReportSize,
-        ivars->readAction,
-        0
-    );
-    if (ret != kIOReturnSuccess) {
+    // Queue one async read per ring slot so the endpoint always has
+    // a buffer pending while a completed report is being processed
+    ivars->isPolling = true;
+
+    uint32_t armed = 0;
+    kern_return_t ret = kIOReturnSuccess;
+    for (uint32_t i = 0; i < ivars->inputSlotCount; i++) {
+        ret = ArmInputSlot(i);
+        if (ret == kIOReturnSuccess) {
+            armed++;
+        }
+    }
+
+    if (armed == 0) {
         LOG_ERROR("Failed to start async read: 0x%x", ret);
+        ivars->isPolling = false;
         return ret;
     }
 
-    ivars->isPolling = true;
-    LOG_INFO("Input polling started");
+    LOG_INFO("Input polling started (%u/%u reads in flight)", armed, ivars->inputSlotCount);
     return kIOReturnSuccess;
 }
 
@@ -647,7 +951,7 @@ void BigbenUSBDriver::StopInputPolling()
 
     ivars->isPolling = false;
 
-    // Abort any pending I/O on the input pipe
+    // Abort any pending I/O on the input pipe (completes every slot)
     if (ivars->inputPipe != nullptr) {
         ivars->inputPipe->Abort(kIOUSBAbortAsyncOption, kIOReturnAborted);
     }
@@ -655,8 +959,50 @@ void BigbenUSBDriver::StopInputPolling()
     LOG_INFO("Input polling stopped");
 }
 
-void BigbenUSBDriver::ReadComplete(OSAction *action, IOReturn status, uint32_t actualByteCount)
+kern_return_t BigbenUSBDriver::ArmInputSlot(uint32_t index)
 {
+    BigbenInputSlot *slot = &ivars->inputSlots[index];
+
+    if (!ivars->isPolling || slot->inFlight) {
+        return kIOReturnSuccess;
+    }
+
+    kern_return_t ret = ivars->inputPipe->AsyncIO(
+        slot->buffer,
+        kBigbenInputReportSize,
+        slot->action,
+        0
+    );
+    if (ret != kIOReturnSuccess) {
+        LOG_ERROR("Failed to queue async read on slot %u: 0x%x", index, ret);
+        return ret;
+    }
+
+    slot->inFlight = true;
+    return kIOReturnSuccess;
+}
+
+void BigbenUSBDriver::ReadComplete(OSAction *action, IOReturn status, uint32_t actualByteCount,
+                                   uint64_t completionTimestamp)
+{
+    uint64_t timestamp = mach_absolute_time();
+
+    // Measure from when the host controller finished the transfer
+    if (completionTimestamp == 0 || completionTimestamp > timestamp) {
+        completionTimestamp = timestamp;
+    }
+    RecordLatency(kBigbenStageCompletion, completionTimestamp, timestamp);
+
+    BigbenSlotActionRef *ref = (BigbenSlotActionRef*)action->GetReference();
+    if (ref == nullptr || ref->slotIndex >= ivars->inputSlotCount) {
+        LOG_ERROR("Read completed on unknown slot");
+        return;
+    }
+
+    uint32_t index = ref->slotIndex;
+    BigbenInputSlot *slot = &ivars->inputSlots[index];
+    slot->inFlight = false;
+
     // Check for abort/disconnect
     if (status == kIOReturnAborted || status == kIOReturnNotResponding) {
         LOG_INFO("Read aborted or device not responding (status: 0x%x)", status);
@@ -664,169 +1010,455 @@ void BigbenUSBDriver::ReadComplete(OSAction *action, IOReturn status, uint32_t a
     }
 
     if (status != kIOReturnSuccess) {
-        LOG_ERROR("Read completed with error: 0x%x", status);
+        TraceEvent(ivars, BIGBEN_TRACE_READ_ERROR, 0, (uint32_t)status);
         ivars->reportErrors++;
 
-        // Try to restart polling if we're still connected
+        // Try to restart this slot if we're still connected
         if (ivars->isPolling && ivars->deviceConnected) {
-            kern_return_t ret = ivars->inputPipe->AsyncIO(
-                ivars->inputBuffer,
-                kBigbenInputReportSize,
-                ivars->readAction,
-                0
-            );
-            if (ret != kIOReturnSuccess) {
-                LOG_ERROR("Failed to restart async read: 0x%x", ret);
-                ivars->isPolling = false;
-            }
+            ArmInputSlot(index);
         }
         return;
     }
 
-    // Validate report size
-    if (actualByteCount < sizeof(BigbenInputReport)) {
-        LOG_DEBUG("Short read: %u bytes (expected at least %zu)", actualByteCount, sizeof(BigbenInputReport));
+    // Translate straight from the slot buffer into the pre-mapped HID
+    // report. This is the only pass over the vendor report.
+    bool haveReport = false;
+    if (actualByteCount < ivars->backend->minReportSize) {
+        TraceEvent(ivars, BIGBEN_TRACE_SHORT_READ, 0, actualByteCount);
         ivars->reportErrors++;
     } else {
-        // Get the buffer address
-        uint64_t address = 0;
-        uint64_t length = 0;
-        kern_return_t ret = ivars->inputBuffer->Map(0, 0, 0, 0, &address, &length);
-        if (ret == kIOReturnSuccess && address != 0) {
-            const uint8_t *data = (const uint8_t*)address;
+        haveReport = ParseInputReport(slot->address, actualByteCount);
+        if (haveReport) {
+            RecordLatency(kBigbenStageTranslate, completionTimestamp, mach_absolute_time());
+        }
+    }
 
-            // Parse the input report
-            ParseInputReport(data, actualByteCount);
+    // Re-arm the slot before dispatching so the endpoint is never left
+    // without a pending read
+    if (ivars->isPolling && ivars->deviceConnected) {
+        if (ArmInputSlot(index) != kIOReturnSuccess) {
+            bool anyInFlight = false;
+            for (uint32_t i = 0; i < ivars->inputSlotCount; i++) {
+                anyInFlight |= ivars->inputSlots[i].inFlight;
+            }
+            if (!anyInFlight) {
+                ivars->isPolling = false;
+            }
+        }
+    }
 
-            ivars->reportsReceived++;
+    if (haveReport) {
+        ivars->reportsReceived++;
+        BigbenSnapshotPublish(&ivars->snapshot, ivars->hidReport, completionTimestamp);
 
-            // Forward the report to the HID layer
-            uint64_t timestamp = mach_absolute_time();
-            handleReport(timestamp, ivars->inputBuffer, actualByteCount,
+        // Forward the translated report to the HID layer unless the
+        // dispatch policy says it carries nothing new
+        if (ShouldDispatchReport(timestamp)) {
+            ivars->lastDispatchTime = timestamp;
+            handleReport(timestamp, ivars->hidReportBuffer, BIGBEN_HID_REPORT_SIZE,
                         kIOHIDReportTypeInput, 0);
+            RecordLatency(kBigbenStageDispatch, completionTimestamp, mach_absolute_time());
+        } else {
+            ivars->reportsSuppressed++;
         }
     }
+}
 
-    // Queue the next read if still polling
-    if (ivars->isPolling && ivars->deviceConnected) {
-        kern_return_t ret = ivars->inputPipe->AsyncIO(
-            ivars->inputBuffer,
-            kBigbenInputReportSize,
-            ivars->readAction,
-            0
-        );
-        if (ret != kIOReturnSuccess) {
-            LOG_ERROR("Failed to queue next async read: 0x%x", ret);
-            ivars->isPolling = false;
-        }
-    }
+// =============================================================================
+// MARK: - Latency Instrumentation
+// =============================================================================
+
+void BigbenUSBDriver::RecordLatency(uint32_t stage, uint64_t start, uint64_t end)
+{
+    uint64_t ticks = end > start ? end - start : 0;
+    BigbenLatencyRecord(&ivars->latency[stage],
+                        ticks * ivars->timebase.numer / ivars->timebase.denom);
 }
 
-void BigbenUSBDriver::ParseInputReport(const uint8_t *data, size_t length)
+kern_return_t BigbenUSBDriver::SetupStatsTimer()
 {
-    if (length < sizeof(BigbenInputReport)) {
-        return;
+    uint32_t intervalMs = ReadConfigValue(kBigbenStatsIntervalKey,
+                                          kBigbenDefaultStatsIntervalMs,
+                                          0, kBigbenMaxStatsIntervalMs);
+    if (intervalMs == 0) {
+        LOG_INFO("Latency stats publishing disabled");
+        return kIOReturnSuccess;
+    }
+
+    IODispatchQueue *queue = nullptr;
+    kern_return_t ret = CopyDispatchQueue(kIOServiceDefaultQueueName, &queue);
+    if (ret != kIOReturnSuccess || queue == nullptr) {
+        return ret != kIOReturnSuccess ? ret : kIOReturnNoResources;
     }
 
-    const BigbenInputReport *report = (const BigbenInputReport*)data;
+    ret = IOTimerDispatchSource::Create(queue, &ivars->statsTimer);
+    queue->release();
+    if (ret != kIOReturnSuccess) {
+        return ret;
+    }
+
+    ret = CreateActionStatsTimerOccurred(0, &ivars->statsAction);
+    if (ret != kIOReturnSuccess) {
+        return ret;
+    }
+
+    ret = ivars->statsTimer->SetHandler(ivars->statsAction);
+    if (ret != kIOReturnSuccess) {
+        return ret;
+    }
+
+    ivars->statsIntervalTicks = ((uint64_t)intervalMs * 1000000ULL * ivars->timebase.denom) /
+                                ivars->timebase.numer;
+
+    return ivars->statsTimer->WakeAtTime(kIOTimerClockMachAbsoluteTime,
+                                         mach_absolute_time() + ivars->statsIntervalTicks,
+                                         ivars->statsIntervalTicks / 10);
+}
+
+void BigbenUSBDriver::StatsTimerOccurred(OSAction *action, uint64_t time)
+{
+    PublishLatencyStats();
+
+    if (ivars->isStarted && ivars->statsTimer != nullptr && ivars->statsIntervalTicks != 0) {
+        ivars->statsTimer->WakeAtTime(kIOTimerClockMachAbsoluteTime,
+                                      time + ivars->statsIntervalTicks,
+                                      ivars->statsIntervalTicks / 10);
+    }
+}
 
-    // Verify report ID
-    if (report->reportId != BIGBEN_REPORT_ID_INPUT) {
-        LOG_DEBUG("Unexpected report ID: 0x%02x", report->reportId);
+void BigbenUSBDriver::PublishLatencyStats()
+{
+    OSDictionary *stages = OSDictionary::withCapacity(kBigbenStageCount);
+    if (stages == nullptr) {
         return;
     }
 
-    // Log state changes for debugging (only if changed)
-    if (ivars->hasLastReport) {
-        bool changed = memcmp(report, &ivars->lastReport, sizeof(BigbenInputReport)) != 0;
-        if (changed) {
-            LOG_DEBUG("Input: LX=%3u LY=%3u RX=%3u RY=%3u DPad=%u Btn=0x%04x LT=%3u RT=%3u",
-                     report->leftStickX, report->leftStickY,
-                     report->rightStickX, report->rightStickY,
-                     report->dpad, report->buttons,
-                     report->leftTrigger, report->rightTrigger);
+    for (uint32_t i = 0; i < kBigbenStageCount; i++) {
+        BigbenLatencySummary summary;
+        BigbenLatencySummarize(&ivars->latency[i], &summary);
+
+        OSDictionary *entry = OSDictionary::withCapacity(6);
+        if (entry == nullptr) {
+            continue;
         }
+
+        const struct { const char *key; uint64_t value; } fields[] = {
+            { "Count",  summary.count },
+            { "MeanNs", summary.meanNs },
+            { "P50Ns",  summary.p50Ns },
+            { "P99Ns",  summary.p99Ns },
+            { "P999Ns", summary.p999Ns },
+            { "MaxNs",  summary.maxNs },
+        };
+        for (const auto &field : fields) {
+            OSNumber *number = OSNumber::withNumber(field.value, 64);
+            if (number != nullptr) {
+                entry->setObject(field.key, number);
+                number->release();
+            }
+        }
+
+        stages->setObject(kBigbenLatencyStageNames[i], entry);
+        entry->release();
+    }
+
+    OSDictionary *properties = OSDictionary::withCapacity(1);
+    if (properties != nullptr) {
+        properties->setObject(kBigbenLatencyStatsProperty, stages);
+        SetProperties(properties);
+        properties->release();
+    }
+    stages->release();
+}
+
+void BigbenUSBDriver::ConfigureTranslator()
+{
+    uint32_t stickDeadzone = ReadConfigValue(kBigbenStickDeadzoneKey,
+                                             INPUT_TRANSLATOR_DEFAULT_DEADZONE, 0, 127);
+    uint32_t deadzoneMode = ReadConfigValue(kBigbenStickDeadzoneModeKey,
+                                            kBigbenDeadzoneScaledRadial,
+                                            kBigbenDeadzoneAxial, kBigbenDeadzoneScaledRadial);
+    uint32_t triggerDeadzone = ReadConfigValue(kBigbenTriggerDeadzoneKey, 0, 0, 255);
+
+    // Piecewise curves need point lists, so only the parametric curves
+    // are selectable from the personality
+    uint32_t stickCurve = ReadConfigValue(kBigbenStickCurveKey, INPUT_CURVE_LINEAR,
+                                          INPUT_CURVE_LINEAR, INPUT_CURVE_S_CURVE);
+    uint32_t stickStrength = ReadConfigValue(kBigbenStickCurveStrengthKey, 0,
+                                             0, INPUT_TRANSLATOR_MAX_CURVE_STRENGTH);
+    uint32_t triggerCurve = ReadConfigValue(kBigbenTriggerCurveKey, INPUT_CURVE_LINEAR,
+                                            INPUT_CURVE_LINEAR, INPUT_CURVE_S_CURVE);
+    uint32_t triggerStrength = ReadConfigValue(kBigbenTriggerCurveStrengthKey, 0,
+                                               0, INPUT_TRANSLATOR_MAX_CURVE_STRENGTH);
+
+    // A radial deadzone is applied to the stick pair before the per-axis
+    // tables, which then only carry the response curve
+    ivars->radialDeadzone = (deadzoneMode != kBigbenDeadzoneAxial);
+    BigbenStickShapeInit8(&ivars->stickShape, (uint8_t)stickDeadzone,
+                          deadzoneMode == kBigbenDeadzoneRadial ? BIGBEN_DEADZONE_RADIAL
+                                                                : BIGBEN_DEADZONE_SCALED_RADIAL,
+                          BIGBEN_STICK_CURVE_LINEAR);
+
+    // Each call rebuilds the affected lookup tables once
+    ivars->translator.setDeadzone(ivars->radialDeadzone ? 0 : (uint8_t)stickDeadzone);
+    ivars->translator.setTriggerDeadzone((uint8_t)triggerDeadzone);
+    ivars->translator.setStickResponseCurve(
+        InputTranslator::makeCurve((InputCurveType)stickCurve, (uint8_t)stickStrength));
+    ivars->translator.setTriggerResponseCurve(
+        InputTranslator::makeCurve((InputCurveType)triggerCurve, (uint8_t)triggerStrength));
+
+    LOG_INFO("Translator: stick deadzone %u (mode %u) curve %u/%u, trigger deadzone %u curve %u/%u",
+             stickDeadzone, deadzoneMode, stickCurve, stickStrength,
+             triggerDeadzone, triggerCurve, triggerStrength);
+}
+
+void BigbenUSBDriver::ConfigureDispatchPolicy()
+{
+    ivars->dispatchPolicy = ReadConfigValue(kBigbenDispatchPolicyKey,
+                                            kBigbenDispatchAlways,
+                                            kBigbenDispatchAlways,
+                                            kBigbenDispatchOnChangeKeepalive);
+
+    uint32_t keepaliveMs = ReadConfigValue(kBigbenKeepaliveIntervalKey,
+                                           kBigbenDefaultKeepaliveMs,
+                                           1, kBigbenMaxKeepaliveMs);
+
+    // Convert the heartbeat interval to mach ticks once
+    ivars->keepaliveTicks = ((uint64_t)keepaliveMs * 1000000ULL * ivars->timebase.denom) /
+                            ivars->timebase.numer;
+
+    LOG_INFO("Dispatch policy: %u (keepalive %u ms)", ivars->dispatchPolicy, keepaliveMs);
+}
+
+bool BigbenUSBDriver::ShouldDispatchReport(uint64_t timestamp)
+{
+    switch (ivars->dispatchPolicy) {
+        case kBigbenDispatchOnChange:
+            return ivars->lastReportChanged;
+
+        case kBigbenDispatchOnChangeKeepalive:
+            return ivars->lastReportChanged ||
+                   (timestamp - ivars->lastDispatchTime) >= ivars->keepaliveTicks;
+
+        case kBigbenDispatchAlways:
+        default:
+            return true;
+    }
+}
+
+bool BigbenUSBDriver::ParseInputReport(const uint8_t *data, size_t length)
+{
+    // Decode with the model's backend; the length was checked against its
+    // minimum already, so a rejection here is a report of another kind
+    BigbenInputReport parsed;
+    const BigbenInputReport *report = ivars->backend->parse(data, length, &parsed);
+    if (report == nullptr) {
+        TraceEvent(ivars, BIGBEN_TRACE_BAD_REPORT_ID, length > 0 ? data[0] : 0);
+        return false;
+    }
+
+    // Shape the stick pairs radially, then translate into the HID report
+    // that will be dispatched
+    BigbenInputReport shaped;
+    if (ivars->radialDeadzone) {
+        shaped = *report;
+        BigbenStickApply8(&ivars->stickShape, &shaped.leftStickX, &shaped.leftStickY);
+        BigbenStickApply8(&ivars->stickShape, &shaped.rightStickX, &shaped.rightStickY);
+        report = &shaped;
     }
 
-    // Store the report for change detection
-    memcpy(&ivars->lastReport, report, sizeof(BigbenInputReport));
+    BigbenHIDReport *hidReport = ivars->hidReport;
+    ivars->translator.translate(report, hidReport);
+
+    // Compare the translated report, so reserved bytes and sub-deadzone
+    // noise in the vendor report never count as a change
+    bool changed = !ivars->hasLastReport ||
+                   memcmp(hidReport, &ivars->lastReport, sizeof(BigbenHIDReport)) != 0;
+    ivars->lastReportChanged = changed;
+
+    // Trace state changes for debugging (only if changed)
+    if (changed) {
+        TraceEvent(ivars, BIGBEN_TRACE_INPUT_CHANGED, hidReport->buttons, 0,
+                   BigbenTracePackAxes(hidReport->leftStickX, hidReport->leftStickY,
+                                       hidReport->rightStickX, hidReport->rightStickY,
+                                       hidReport->leftTrigger, hidReport->rightTrigger,
+                                       hidReport->hatSwitch));
+    }
+
+    // Store the report for change detection and GET_REPORT
+    ivars->lastReport = *hidReport;
     ivars->hasLastReport = true;
+    return true;
 }
 
 void BigbenUSBDriver::LogControllerState()
 {
-    if (!ivars->hasLastReport) {
+    BigbenHIDReport state;
+    if (!BigbenSnapshotRead(&ivars->snapshot, &state, nullptr)) {
         LOG_INFO("No controller state available");
+        LogTrace();
         return;
     }
 
-    const BigbenInputReport *r = &ivars->lastReport;
+    const BigbenHIDReport *r = &state;
     LOG_INFO("Controller State:");
     LOG_INFO("  Left Stick:  X=%d Y=%d", BIGBEN_ANALOG_TO_SIGNED(r->leftStickX),
              BIGBEN_ANALOG_TO_SIGNED(r->leftStickY));
     LOG_INFO("  Right Stick: X=%d Y=%d", BIGBEN_ANALOG_TO_SIGNED(r->rightStickX),
              BIGBEN_ANALOG_TO_SIGNED(r->rightStickY));
     LOG_INFO("  Triggers:    L=%u R=%u", r->leftTrigger, r->rightTrigger);
-    LOG_INFO("  D-Pad:       %u", r->dpad);
+    LOG_INFO("  Hat Switch:  %u", r->hatSwitch);
     LOG_INFO("  Buttons:     0x%04x", r->buttons);
+
+    LogTrace();
+}
+
+// Format the trace records written since the last call; only runs on demand
+void BigbenUSBDriver::LogTrace()
+{
+    BigbenTraceRecord records[32];
+    uint64_t origin = 0;
+
+    for (;;) {
+        uint64_t lost = 0;
+        uint32_t count = BigbenTraceDrain(&ivars->trace, &ivars->traceCursor,
+                                          records, 32, &lost);
+        if (lost > 0) {
+            LOG_INFO("Trace: %llu older records overwritten", lost);
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            const BigbenTraceRecord *record = &records[i];
+            if (origin == 0) {
+                origin = record->timestamp;
+            }
+            uint64_t us = (record->timestamp - origin) * ivars->timebase.numer /
+                          ivars->timebase.denom / 1000;
+
+            if (record->event == BIGBEN_TRACE_INPUT_CHANGED) {
+                LOG_INFO("Trace +%llu us Input: LX=%3u LY=%3u RX=%3u RY=%3u Hat=%u Btn=0x%04x LT=%3u RT=%3u",
+                         us, BigbenTraceAxis(record->arg64, 0), BigbenTraceAxis(record->arg64, 1),
+                         BigbenTraceAxis(record->arg64, 2), BigbenTraceAxis(record->arg64, 3),
+                         BigbenTraceAxis(record->arg64, 6), record->arg16,
+                         BigbenTraceAxis(record->arg64, 4), BigbenTraceAxis(record->arg64, 5));
+            } else {
+                LOG_INFO("Trace +%llu us %{public}s: 0x%04x 0x%08x",
+                         us, BigbenTraceEventName(record->event), record->arg16, record->arg32);
+            }
+        }
+        if (count < 32) {
+            break;
+        }
+    }
 }
 
 // =============================================================================
 // MARK: - Output Report Handling
 // =============================================================================
 
-void BigbenUSBDriver::WriteComplete(OSAction *action, IOReturn status, uint32_t actualByteCount)
+void BigbenUSBDriver::WriteComplete(OSAction *action, IOReturn status, uint32_t actualByteCount,
+                                    uint64_t completionTimestamp)
 {
-    if (status != kIOReturnSuccess) {
-        LOG_ERROR("Write completed with error: 0x%x", status);
+    BigbenSlotActionRef *ref = (BigbenSlotActionRef*)action->GetReference();
+    if (ref == nullptr || ref->slotIndex >= kBigbenOutputSlotCount || ivars->outputLock == nullptr) {
+        LOG_ERROR("Write completed on unknown slot");
         return;
     }
 
-    LOG_DEBUG("Output report sent successfully (%u bytes)", actualByteCount);
-    ivars->outputReportsSent++;
+    uint32_t index = ref->slotIndex;
+    BigbenOutputSlot *slot = &ivars->outputSlots[index];
+    uint8_t reportId = slot->address != nullptr ? slot->address[0] : 0;
+
+    if (status != kIOReturnSuccess) {
+        TraceEvent(ivars, BIGBEN_TRACE_OUTPUT_ERROR, reportId, (uint32_t)status);
+    } else {
+        TraceEvent(ivars, BIGBEN_TRACE_OUTPUT_SENT, reportId, actualByteCount);
+        ivars->outputReportsSent++;
+    }
+
+    // Hand the slot straight to the latest coalesced report, if any; it
+    // stays marked in flight so no other sender can claim it in between
+    uint8_t next[kBigbenOutputReportSize];
+    bool sendNext = false;
+
+    IOLockLock(ivars->outputLock);
+    if (slot->hasPending && status != kIOReturnAborted && ivars->deviceConnected) {
+        memcpy(next, slot->pending, kBigbenOutputReportSize);
+        sendNext = true;
+    } else {
+        slot->inFlight = false;
+    }
+    slot->hasPending = false;
+    IOLockUnlock(ivars->outputLock);
+
+    if (sendNext) {
+        SubmitOutputSlot(index, next);
+    }
 }
 
 kern_return_t BigbenUSBDriver::SendOutputReport(const uint8_t *data, size_t length)
 {
-    if (ivars->outputPipe == nullptr || ivars->outputBuffer == nullptr) {
+    if (ivars->outputPipe == nullptr || ivars->outputLock == nullptr) {
         LOG_DEBUG("Output endpoint not available");
         return kIOReturnNotFound;
     }
 
-    if (length > kBigbenOutputReportSize) {
-        LOG_ERROR("Output report too large: %zu bytes", length);
+    if (data == nullptr || length == 0 || length > kBigbenOutputReportSize) {
+        LOG_ERROR("Output report has a bad size: %zu bytes", length);
         return kIOReturnBadArgument;
     }
 
-    // Map the output buffer and copy data
-    uint64_t address = 0;
-    uint64_t bufferLength = 0;
-    kern_return_t ret = ivars->outputBuffer->Map(0, 0, 0, 0, &address, &bufferLength);
-    if (ret != kIOReturnSuccess) {
-        LOG_ERROR("Failed to map output buffer: 0x%x", ret);
-        return ret;
+    uint32_t index;
+    switch (data[0]) {
+        case BIGBEN_REPORT_ID_LED:      index = kBigbenOutputSlotLED; break;
+        case BIGBEN_REPORT_ID_RUMBLE:   index = kBigbenOutputSlotRumble; break;
+        default:                        return kIOReturnUnsupported;
     }
 
-    memcpy((void*)address, data, length);
-
     // Pad remaining bytes with zeros
-    if (length < kBigbenOutputReportSize) {
-        memset((uint8_t*)address + length, 0, kBigbenOutputReportSize - length);
+    uint8_t report[kBigbenOutputReportSize] = { 0 };
+    memcpy(report, data, length);
+
+    BigbenOutputSlot *slot = &ivars->outputSlots[index];
+
+    IOLockLock(ivars->outputLock);
+    if (slot->inFlight) {
+        // Replace whatever is already waiting; only the newest state matters
+        if (slot->hasPending) {
+            ivars->outputReportsCoalesced++;
+        }
+        memcpy(slot->pending, report, kBigbenOutputReportSize);
+        slot->hasPending = true;
+        IOLockUnlock(ivars->outputLock);
+        return kIOReturnSuccess;
     }
+    slot->inFlight = true;
+    IOLockUnlock(ivars->outputLock);
+
+    return SubmitOutputSlot(index, report);
+}
+
+kern_return_t BigbenUSBDriver::SubmitOutputSlot(uint32_t index, const uint8_t *report)
+{
+    BigbenOutputSlot *slot = &ivars->outputSlots[index];
 
-    // Send the report
-    ret = ivars->outputPipe->AsyncIO(
-        ivars->outputBuffer,
+    // The caller has claimed the slot (inFlight is set), so the buffer is free
+    memcpy(slot->address, report, kBigbenOutputReportSize);
+
+    kern_return_t ret = ivars->outputPipe->AsyncIO(
+        slot->buffer,
         kBigbenOutputReportSize,
-        ivars->writeAction,
+        slot->action,
         0
     );
     if (ret != kIOReturnSuccess) {
-        LOG_ERROR("Failed to send output report: 0x%x", ret);
-        return ret;
-    }
+        TraceEvent(ivars, BIGBEN_TRACE_OUTPUT_ERROR, report[0], (uint32_t)ret);
 
-    return kIOReturnSuccess;
+        IOLockLock(ivars->outputLock);
+        slot->inFlight = false;
+        slot->hasPending = false;
+        IOLockUnlock(ivars->outputLock);
+    }
+    return ret;
 }
 
 // =============================================================================
@@ -880,8 +1512,6 @@ kern_return_t BigbenUSBDriver::setReport(
     // Get report ID from options
     uint8_t reportID = (uint8_t)(options & 0xFF);
 
-    LOG_DEBUG("setReport: type=%d, reportID=%u", reportType, reportID);
-
     // Map the report buffer
     uint64_t address = 0;
     uint64_t length = 0;
@@ -895,14 +1525,16 @@ kern_return_t BigbenUSBDriver::setReport(
 
     // Handle LED report
     if (reportID == BIGBEN_REPORT_ID_LED || (length > 0 && data[0] == BIGBEN_REPORT_ID_LED)) {
-        LOG_DEBUG("Processing LED report");
-        return SendOutputReport(data, length);
+        ret = SendOutputReport(data, length);
+        TraceEvent(ivars, BIGBEN_TRACE_SET_REPORT, BIGBEN_REPORT_ID_LED, (uint32_t)ret);
+        return ret;
     }
 
     // Handle Rumble report
     if (reportID == BIGBEN_REPORT_ID_RUMBLE || (length > 0 && data[0] == BIGBEN_REPORT_ID_RUMBLE)) {
-        LOG_DEBUG("Processing Rumble report");
-        return SendOutputReport(data, length);
+        ret = SendOutputReport(data, length);
+        TraceEvent(ivars, BIGBEN_TRACE_SET_REPORT, BIGBEN_REPORT_ID_RUMBLE, (uint32_t)ret);
+        return ret;
     }
 
     LOG_DEBUG("Unknown output report ID: %u", reportID);
@@ -921,11 +1553,13 @@ kern_return_t BigbenUSBDriver::getReport(
     // Get report ID from options
     uint8_t reportID = (uint8_t)(options & 0xFF);
 
-    LOG_DEBUG("getReport: type=%d, reportID=%u", reportType, reportID);
+    TraceEvent(ivars, BIGBEN_TRACE_GET_REPORT, (uint16_t)reportType, reportID);
 
-    // For input reports, return the last cached report if available
+    // For input reports, return the last published report if available;
+    // the snapshot is consistent even while a completion is publishing
     if (reportType == kIOHIDReportTypeInput && reportID == BIGBEN_REPORT_ID_INPUT) {
-        if (!ivars->hasLastReport) {
+        BigbenHIDReport latest;
+        if (!BigbenSnapshotRead(&ivars->snapshot, &latest, nullptr)) {
             return kIOReturnNotReady;
         }
 
@@ -936,8 +1570,8 @@ kern_return_t BigbenUSBDriver::getReport(
             return ret;
         }
 
-        size_t copyLength = length < sizeof(BigbenInputReport) ? length : sizeof(BigbenInputReport);
-        memcpy((void*)address, &ivars->lastReport, copyLength);
+        size_t copyLength = length < sizeof(BigbenHIDReport) ? length : sizeof(BigbenHIDReport);
+        memcpy((void*)address, &latest, copyLength);
 
         return kIOReturnSuccess;
     }
@@ -953,26 +1587,60 @@ void BigbenUSBDriver::CleanupResources()
 {
     LOG_DEBUG("Cleaning up resources");
 
-    // Release actions
-    if (ivars->readAction != nullptr) {
-        ivars->readAction->release();
-        ivars->readAction = nullptr;
+    // Release the input ring
+    for (uint32_t i = 0; i < ivars->inputSlotCount; i++) {
+        BigbenInputSlot *slot = &ivars->inputSlots[i];
+
+        if (slot->action != nullptr) {
+            slot->action->release();
+            slot->action = nullptr;
+        }
+
+        if (slot->buffer != nullptr) {
+            slot->buffer->release();
+            slot->buffer = nullptr;
+        }
+
+        slot->address = nullptr;
+        slot->inFlight = false;
     }
+    ivars->inputSlotCount = 0;
 
-    if (ivars->writeAction != nullptr) {
-        ivars->writeAction->release();
-        ivars->writeAction = nullptr;
+    // Release the stats timer
+    if (ivars->statsTimer != nullptr) {
+        ivars->statsTimer->release();
+        ivars->statsTimer = nullptr;
     }
 
-    // Release buffers
-    if (ivars->inputBuffer != nullptr) {
-        ivars->inputBuffer->release();
-        ivars->inputBuffer = nullptr;
+    if (ivars->statsAction != nullptr) {
+        ivars->statsAction->release();
+        ivars->statsAction = nullptr;
     }
 
-    if (ivars->outputBuffer != nullptr) {
-        ivars->outputBuffer->release();
-        ivars->outputBuffer = nullptr;
+    // Release the output slots
+    for (uint32_t i = 0; i < kBigbenOutputSlotCount; i++) {
+        BigbenOutputSlot *slot = &ivars->outputSlots[i];
+
+        if (slot->action != nullptr) {
+            slot->action->release();
+            slot->action = nullptr;
+        }
+
+        if (slot->buffer != nullptr) {
+            slot->buffer->release();
+            slot->buffer = nullptr;
+        }
+
+        slot->address = nullptr;
+        slot->inFlight = false;
+        slot->hasPending = false;
+    }
+
+    // Release buffers
+    if (ivars->hidReportBuffer != nullptr) {
+        ivars->hidReportBuffer->release();
+        ivars->hidReportBuffer = nullptr;
+        ivars->hidReport = nullptr;
     }
 
     if (ivars->hidDescriptor != nullptr) {
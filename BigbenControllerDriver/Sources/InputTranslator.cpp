@@ -9,7 +9,7 @@
 //
 
 #include "InputTranslator.h"
-#include <string.h>  // for memset
+#include <string.h>  // for memset, memcpy
 
 // =============================================================================
 // MARK: - Construction
@@ -19,16 +19,24 @@ InputTranslator::InputTranslator()
     : m_deadzone(INPUT_TRANSLATOR_DEFAULT_DEADZONE)
     , m_triggerDeadzone(0)
 {
+    memset(m_curves, 0, sizeof(m_curves));
+    rebuildStickTables();
+    rebuildTriggerTables();
 }
 
 InputTranslator::InputTranslator(uint8_t deadzone)
     : m_deadzone(deadzone)
     , m_triggerDeadzone(0)
 {
+    memset(m_curves, 0, sizeof(m_curves));
+
     // Clamp deadzone to valid range
     if (m_deadzone > 127) {
         m_deadzone = 127;
     }
+
+    rebuildStickTables();
+    rebuildTriggerTables();
 }
 
 // =============================================================================
@@ -38,11 +46,109 @@ InputTranslator::InputTranslator(uint8_t deadzone)
 void InputTranslator::setDeadzone(uint8_t deadzone)
 {
     m_deadzone = (deadzone > 127) ? 127 : deadzone;
+    rebuildStickTables();
 }
 
 void InputTranslator::setTriggerDeadzone(uint8_t deadzone)
 {
     m_triggerDeadzone = deadzone;
+    rebuildTriggerTables();
+}
+
+bool InputTranslator::setResponseCurve(InputAxis axis, const InputResponseCurve& curve)
+{
+    if (axis < 0 || axis >= INPUT_AXIS_COUNT || !isValidCurve(curve)) {
+        return false;
+    }
+
+    m_curves[axis] = curve;
+    rebuildTable(axis);
+    return true;
+}
+
+bool InputTranslator::setStickResponseCurve(const InputResponseCurve& curve)
+{
+    if (!isValidCurve(curve)) {
+        return false;
+    }
+
+    for (int axis = INPUT_AXIS_LEFT_X; axis <= INPUT_AXIS_RIGHT_Y; axis++) {
+        setResponseCurve((InputAxis)axis, curve);
+    }
+    return true;
+}
+
+bool InputTranslator::setTriggerResponseCurve(const InputResponseCurve& curve)
+{
+    if (!isValidCurve(curve)) {
+        return false;
+    }
+
+    setResponseCurve(INPUT_AXIS_LEFT_TRIGGER, curve);
+    setResponseCurve(INPUT_AXIS_RIGHT_TRIGGER, curve);
+    return true;
+}
+
+bool InputTranslator::isValidCurve(const InputResponseCurve& curve)
+{
+    if (curve.type > INPUT_CURVE_PIECEWISE || curve.strength > INPUT_TRANSLATOR_MAX_CURVE_STRENGTH) {
+        return false;
+    }
+
+    if (curve.type == INPUT_CURVE_PIECEWISE) {
+        if (curve.pointCount > INPUT_TRANSLATOR_MAX_CURVE_POINTS) {
+            return false;
+        }
+        for (uint8_t i = 1; i < curve.pointCount; i++) {
+            if (curve.points[i].input <= curve.points[i - 1].input) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void InputTranslator::rebuildTable(InputAxis axis)
+{
+    const InputResponseCurve& curve = m_curves[axis];
+    uint8_t* table = m_tables[axis];
+    bool linear = (curve.type == INPUT_CURVE_LINEAR);
+
+    if (axis >= INPUT_AXIS_LEFT_TRIGGER) {
+        for (int value = 0; value < 256; value++) {
+            uint8_t base = applyTriggerDeadzone((uint8_t)value, m_triggerDeadzone);
+            table[value] = linear ? base : applyCurve(curve, base, 255);
+        }
+        return;
+    }
+
+    // Sticks: shape the distance from center; the negative side reaches 128
+    for (int value = 0; value < 256; value++) {
+        uint8_t base = applyDeadzone((uint8_t)value, m_deadzone);
+        if (linear || base == INPUT_TRANSLATOR_AXIS_CENTER) {
+            table[value] = base;
+        } else if (base > INPUT_TRANSLATOR_AXIS_CENTER) {
+            uint8_t magnitude = base - INPUT_TRANSLATOR_AXIS_CENTER;
+            table[value] = INPUT_TRANSLATOR_AXIS_CENTER + applyCurve(curve, magnitude, 127);
+        } else {
+            uint8_t magnitude = INPUT_TRANSLATOR_AXIS_CENTER - base;
+            table[value] = INPUT_TRANSLATOR_AXIS_CENTER - applyCurve(curve, magnitude, 128);
+        }
+    }
+}
+
+void InputTranslator::rebuildStickTables()
+{
+    for (int axis = INPUT_AXIS_LEFT_X; axis <= INPUT_AXIS_RIGHT_Y; axis++) {
+        rebuildTable((InputAxis)axis);
+    }
+}
+
+void InputTranslator::rebuildTriggerTables()
+{
+    rebuildTable(INPUT_AXIS_LEFT_TRIGGER);
+    rebuildTable(INPUT_AXIS_RIGHT_TRIGGER);
 }
 
 // =============================================================================
@@ -64,15 +170,13 @@ bool InputTranslator::translate(const BigbenInputReport* input, BigbenHIDReport*
     // Translate buttons (direct mapping for Bigben controllers)
     output->buttons = translateButtons(input->buttons);
 
-    // Translate analog sticks with deadzone
-    output->leftStickX = applyDeadzone(input->leftStickX, m_deadzone);
-    output->leftStickY = applyDeadzone(input->leftStickY, m_deadzone);
-    output->rightStickX = applyDeadzone(input->rightStickX, m_deadzone);
-    output->rightStickY = applyDeadzone(input->rightStickY, m_deadzone);
-
-    // Translate triggers with optional deadzone
-    output->leftTrigger = applyTriggerDeadzone(input->leftTrigger, m_triggerDeadzone);
-    output->rightTrigger = applyTriggerDeadzone(input->rightTrigger, m_triggerDeadzone);
+    // Translate analog sticks and triggers (deadzone and curve are precomputed)
+    output->leftStickX = m_tables[INPUT_AXIS_LEFT_X][input->leftStickX];
+    output->leftStickY = m_tables[INPUT_AXIS_LEFT_Y][input->leftStickY];
+    output->rightStickX = m_tables[INPUT_AXIS_RIGHT_X][input->rightStickX];
+    output->rightStickY = m_tables[INPUT_AXIS_RIGHT_Y][input->rightStickY];
+    output->leftTrigger = m_tables[INPUT_AXIS_LEFT_TRIGGER][input->leftTrigger];
+    output->rightTrigger = m_tables[INPUT_AXIS_RIGHT_TRIGGER][input->rightTrigger];
 
     // Translate D-pad to hat switch
     output->hatSwitch = translateDPadToHat(input->dpad);
@@ -80,6 +184,27 @@ bool InputTranslator::translate(const BigbenInputReport* input, BigbenHIDReport*
     return true;
 }
 
+// =============================================================================
+// MARK: - Batch Translation
+// =============================================================================
+
+bool InputTranslator::translateBatch(const BigbenInputReport* inputs, BigbenHIDReport* outputs,
+                                     size_t count) const
+{
+    if (count == 0) {
+        return true;
+    }
+    if (inputs == nullptr || outputs == nullptr) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        translate(&inputs[i], &outputs[i]);
+    }
+
+    return true;
+}
+
 // =============================================================================
 // MARK: - Button Translation
 // =============================================================================
@@ -207,6 +332,93 @@ uint8_t InputTranslator::applyTriggerDeadzone(uint8_t value, uint8_t deadzone)
     return value;
 }
 
+// =============================================================================
+// MARK: - Response Curves
+// =============================================================================
+
+InputResponseCurve InputTranslator::makeCurve(InputCurveType type, uint8_t strength)
+{
+    InputResponseCurve curve;
+    memset(&curve, 0, sizeof(curve));
+    curve.type = type;
+    curve.strength = (strength > INPUT_TRANSLATOR_MAX_CURVE_STRENGTH)
+                   ? INPUT_TRANSLATOR_MAX_CURVE_STRENGTH : strength;
+    return curve;
+}
+
+InputResponseCurve InputTranslator::makePiecewiseCurve(const InputCurvePoint* points, uint8_t count)
+{
+    InputResponseCurve curve = makeCurve(INPUT_CURVE_PIECEWISE, 0);
+    if (points == nullptr) {
+        return curve;
+    }
+
+    curve.pointCount = (count > INPUT_TRANSLATOR_MAX_CURVE_POINTS)
+                     ? INPUT_TRANSLATOR_MAX_CURVE_POINTS : count;
+    memcpy(curve.points, points, curve.pointCount * sizeof(InputCurvePoint));
+    return curve;
+}
+
+// Shape a normalized 0-255 magnitude; every curve keeps 0 and 255 fixed
+static int32_t shapeNormalized(const InputResponseCurve& curve, int32_t n)
+{
+    int32_t shaped = n;
+
+    switch (curve.type) {
+        case INPUT_CURVE_EXPONENTIAL:
+            // n^3 / 255^2
+            shaped = (n * n * n + 32512) / 65025;
+            break;
+
+        case INPUT_CURVE_S_CURVE:
+            // Smoothstep 3t^2 - 2t^3, scaled back to 0-255
+            shaped = (3 * n * n * 255 - 2 * n * n * n + 32512) / 65025;
+            break;
+
+        case INPUT_CURVE_PIECEWISE: {
+            int32_t x0 = 0;
+            int32_t y0 = 0;
+            for (uint8_t i = 0; i <= curve.pointCount; i++) {
+                int32_t x1 = (i < curve.pointCount) ? curve.points[i].input : 255;
+                int32_t y1 = (i < curve.pointCount) ? curve.points[i].output : 255;
+                if (n <= x1) {
+                    return (x1 == x0) ? y1 : y0 + ((n - x0) * (y1 - y0)) / (x1 - x0);
+                }
+                x0 = x1;
+                y0 = y1;
+            }
+            return y0;
+        }
+
+        case INPUT_CURVE_LINEAR:
+        default:
+            return n;
+    }
+
+    // Strength blends between linear and the full curve
+    return (n * (INPUT_TRANSLATOR_MAX_CURVE_STRENGTH - curve.strength) +
+            shaped * curve.strength + INPUT_TRANSLATOR_MAX_CURVE_STRENGTH / 2) /
+           INPUT_TRANSLATOR_MAX_CURVE_STRENGTH;
+}
+
+uint8_t InputTranslator::applyCurve(const InputResponseCurve& curve, uint8_t magnitude, uint8_t maxMagnitude)
+{
+    if (curve.type == INPUT_CURVE_LINEAR || maxMagnitude == 0) {
+        return magnitude;
+    }
+    if (magnitude >= maxMagnitude) {
+        return maxMagnitude;
+    }
+
+    int32_t normalized = ((int32_t)magnitude * 255 + maxMagnitude / 2) / maxMagnitude;
+    int32_t shaped = shapeNormalized(curve, normalized);
+
+    if (shaped < 0) shaped = 0;
+    if (shaped > 255) shaped = 255;
+
+    return (uint8_t)((shaped * maxMagnitude + 127) / 255);
+}
+
 // =============================================================================
 // MARK: - Static Utilities
 // =============================================================================
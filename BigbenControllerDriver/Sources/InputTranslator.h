@@ -14,9 +14,11 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "../../Shared/BigbenProtocol.h"
 #include "../../Shared/HIDReportDescriptor.h"
+#include "../../Shared/ProtocolTraits.h"
 
 // =============================================================================
 // MARK: - Constants
@@ -38,6 +40,12 @@
 /// Hat switch neutral value (released state)
 #define INPUT_TRANSLATOR_HAT_NEUTRAL        8
 
+/// Maximum number of user points in a piecewise response curve
+#define INPUT_TRANSLATOR_MAX_CURVE_POINTS   8
+
+/// Response curve strength range (0 = linear, 100 = full curve)
+#define INPUT_TRANSLATOR_MAX_CURVE_STRENGTH 100
+
 // =============================================================================
 // MARK: - Button Mapping
 // =============================================================================
@@ -66,6 +74,138 @@ typedef enum {
     HID_BTN_RESERVED_16 = 15,   // Button 16: Reserved
 } HIDButton;
 
+// =============================================================================
+// MARK: - Response Curves
+// =============================================================================
+
+/*!
+ * @enum InputAxis
+ * @abstract Analog axes that carry their own lookup table and response curve
+ */
+typedef enum {
+    INPUT_AXIS_LEFT_X       = 0,
+    INPUT_AXIS_LEFT_Y       = 1,
+    INPUT_AXIS_RIGHT_X      = 2,
+    INPUT_AXIS_RIGHT_Y      = 3,
+    INPUT_AXIS_LEFT_TRIGGER = 4,
+    INPUT_AXIS_RIGHT_TRIGGER = 5,
+    INPUT_AXIS_COUNT        = 6,
+} InputAxis;
+
+/*!
+ * @enum InputCurveType
+ * @abstract Shape applied to an axis after its deadzone
+ * @discussion Zero-filled storage is a linear curve.
+ */
+typedef enum {
+    INPUT_CURVE_LINEAR      = 0,    // Output follows the deadzone-scaled input
+    INPUT_CURVE_EXPONENTIAL = 1,    // Blend toward x^3: finer control near rest
+    INPUT_CURVE_S_CURVE     = 2,    // Blend toward smoothstep: soft at both ends
+    INPUT_CURVE_PIECEWISE   = 3,    // Linear interpolation through user points
+} InputCurveType;
+
+/*!
+ * @struct InputCurvePoint
+ * @abstract One point of a piecewise curve, on a normalized 0-255 magnitude scale
+ * @discussion For sticks the magnitude is the distance from center, for
+ *             triggers the trigger value. (0,0) and (255,255) are implied.
+ */
+typedef struct {
+    uint8_t input;
+    uint8_t output;
+} InputCurvePoint;
+
+/*!
+ * @struct InputResponseCurve
+ * @abstract Response curve configuration for one axis
+ */
+typedef struct {
+    InputCurveType  type;
+    uint8_t         strength;       // 0-100, used by exponential and S-curve
+    uint8_t         pointCount;     // Used by piecewise
+    InputCurvePoint points[INPUT_TRANSLATOR_MAX_CURVE_POINTS];
+} InputResponseCurve;
+
+// =============================================================================
+// MARK: - Model Backends
+// =============================================================================
+
+static_assert((int)kProtocolButtonA == (int)BIGBEN_BTN_A && (int)kProtocolButtonHome == (int)BIGBEN_BTN_HOME,
+              "ProtocolButton must use the BigbenButton bit order");
+static_assert(ProtocolTraits<BIGBEN_PRODUCT_PS3_MINIPAD>::kMinReportSize == sizeof(BigbenInputReport) &&
+              ProtocolTraits<BIGBEN_PRODUCT_PS3_MINIPAD>::kButtonsOffset == offsetof(BigbenInputReport, buttons) &&
+              ProtocolTraits<BIGBEN_PRODUCT_PS3_MINIPAD>::kRightTriggerOffset == offsetof(BigbenInputReport, rightTrigger),
+              "Vendor traits must describe BigbenInputReport");
+
+/*!
+ * @typedef InputReportParser
+ * @abstract Turns one raw report of a given model into the vendor layout the translator reads
+ * @param data Raw report as read from the interrupt endpoint
+ * @param length Bytes read
+ * @param scratch Storage for the converted report; its reserved bytes are not written
+ * @return The report to translate (data itself for models that already use the
+ *         vendor layout, otherwise scratch), or nullptr if the report is rejected
+ */
+typedef const BigbenInputReport* (*InputReportParser)(const uint8_t* data, size_t length,
+                                                      BigbenInputReport* scratch);
+
+/*!
+ * @struct InputModelBackend
+ * @abstract Report handling for one controller model, built from its ProtocolTraits
+ * @discussion Chosen once when the device starts; the parser is a separate
+ *             instantiation per model, so the per-report path never looks at
+ *             the model again.
+ */
+struct InputModelBackend {
+    uint16_t            productID;
+    const char*         name;
+    size_t              minReportSize;
+    InputReportParser   parse;
+
+    template <class Traits>
+    static const BigbenInputReport* parseReport(const uint8_t* data, size_t length,
+                                                BigbenInputReport* scratch)
+    {
+        if (length < Traits::kMinReportSize || !Traits::accepts(data, length)) {
+            return nullptr;
+        }
+
+        if constexpr (Traits::kFormat == kProtocolFormatVendor) {
+            return (const BigbenInputReport*)data;
+        } else {
+            ProtocolPadState state;
+            Traits::parse(data, &state);
+
+            scratch->reportId = BIGBEN_REPORT_ID_INPUT;
+            scratch->leftStickX = ProtocolNarrowAxis(state.leftX);
+            scratch->leftStickY = ProtocolNarrowAxis(state.leftY);
+            scratch->rightStickX = ProtocolNarrowAxis(state.rightX);
+            scratch->rightStickY = ProtocolNarrowAxis(state.rightY);
+            scratch->dpad = state.hat;
+            scratch->buttons = state.buttons;
+            scratch->leftTrigger = state.leftTrigger;
+            scratch->rightTrigger = state.rightTrigger;
+            return scratch;
+        }
+    }
+
+    template <class Traits>
+    static constexpr InputModelBackend forModel()
+    {
+        return { Traits::kProductID, Traits::kName, Traits::kMinReportSize, &parseReport<Traits> };
+    }
+};
+
+/*!
+ * @function InputModelBackendForProduct
+ * @abstract Look up the backend for a Bigben product ID
+ * @return The backend, or nullptr if the model has no ProtocolTraits
+ */
+static inline const InputModelBackend* InputModelBackendForProduct(uint16_t productID)
+{
+    return ProtocolSelect<InputModelBackend>(productID);
+}
+
 // =============================================================================
 // MARK: - InputTranslator Class
 // =============================================================================
@@ -80,8 +220,11 @@ typedef enum {
  *             - D-pad conversion: Maps D-pad states to hat switch values
  *             - Trigger handling: Passes through trigger values with optional deadzone
  *
- *             The translator is designed to be stateless for the main translation
- *             path, with optional configuration for deadzone values.
+ *             Deadzones and response curves are folded into one 256-entry
+ *             lookup table per axis whenever the configuration changes, so
+ *             the translation path is table lookups only. Storage that is
+ *             zero-filled rather than constructed must call setDeadzone() and
+ *             setTriggerDeadzone() before translating.
  */
 class InputTranslator {
 public:
@@ -134,6 +277,49 @@ public:
      */
     uint8_t getTriggerDeadzone() const;
 
+    /*!
+     * @function setResponseCurve
+     * @abstract Set the response curve of one axis
+     * @param axis Axis to configure
+     * @param curve Curve to apply after the deadzone
+     * @return true if applied, false if the axis or curve is invalid
+     *         (piecewise points must have strictly increasing inputs)
+     */
+    bool setResponseCurve(InputAxis axis, const InputResponseCurve& curve);
+
+    /*!
+     * @function setStickResponseCurve
+     * @abstract Set the same response curve on all four stick axes
+     * @param curve Curve to apply after the deadzone
+     * @return true if applied
+     */
+    bool setStickResponseCurve(const InputResponseCurve& curve);
+
+    /*!
+     * @function setTriggerResponseCurve
+     * @abstract Set the same response curve on both triggers
+     * @param curve Curve to apply after the deadzone
+     * @return true if applied
+     */
+    bool setTriggerResponseCurve(const InputResponseCurve& curve);
+
+    /*!
+     * @function getResponseCurve
+     * @abstract Get the response curve of one axis
+     * @param axis Axis to query (must be valid)
+     * @return Current curve
+     */
+    const InputResponseCurve& getResponseCurve(InputAxis axis) const;
+
+    /*!
+     * @function axisLookup
+     * @abstract Translate one raw axis value through its precomputed table
+     * @param axis Axis table to use (must be valid)
+     * @param value Raw axis value (0-255)
+     * @return Translated axis value (0-255)
+     */
+    uint8_t axisLookup(InputAxis axis, uint8_t value) const;
+
     // =========================================================================
     // MARK: - Translation
     // =========================================================================
@@ -147,6 +333,18 @@ public:
      */
     bool translate(const BigbenInputReport* input, BigbenHIDReport* output) const;
 
+    /*!
+     * @function translateBatch
+     * @abstract Translate an array of Bigben input reports to standard HID format
+     * @discussion Equivalent to calling translate() on each report, for
+     *             replaying or testing many reports at once.
+     * @param inputs Array of n proprietary BigbenInputReports
+     * @param outputs Array of n BigbenHIDReports to fill
+     * @param count Number of reports
+     * @return true if translation succeeded, false on error
+     */
+    bool translateBatch(const BigbenInputReport* inputs, BigbenHIDReport* outputs, size_t count) const;
+
     // =========================================================================
     // MARK: - Static Utilities
     // =========================================================================
@@ -201,6 +399,34 @@ public:
      */
     static bool isButtonPressed(const BigbenHIDReport* report, HIDButton button);
 
+    /*!
+     * @function makeCurve
+     * @abstract Build a linear, exponential or S-curve configuration
+     * @param type Curve type (piecewise curves need points, see makePiecewiseCurve)
+     * @param strength Curve strength (0-100)
+     * @return Curve configuration
+     */
+    static InputResponseCurve makeCurve(InputCurveType type, uint8_t strength);
+
+    /*!
+     * @function makePiecewiseCurve
+     * @abstract Build a piecewise curve from user points
+     * @param points Points with strictly increasing inputs
+     * @param count Number of points (up to INPUT_TRANSLATOR_MAX_CURVE_POINTS)
+     * @return Curve configuration (validated when it is set on an axis)
+     */
+    static InputResponseCurve makePiecewiseCurve(const InputCurvePoint* points, uint8_t count);
+
+    /*!
+     * @function applyCurve
+     * @abstract Apply a response curve to a magnitude
+     * @param curve Curve to apply
+     * @param magnitude Magnitude to shape (0-maxMagnitude)
+     * @param maxMagnitude Full-scale magnitude (127/128 for sticks, 255 for triggers)
+     * @return Shaped magnitude (0-maxMagnitude)
+     */
+    static uint8_t applyCurve(const InputResponseCurve& curve, uint8_t magnitude, uint8_t maxMagnitude);
+
 private:
     // =========================================================================
     // MARK: - Private Members
@@ -208,6 +434,14 @@ private:
 
     uint8_t m_deadzone;         ///< Analog stick deadzone (0-127)
     uint8_t m_triggerDeadzone;  ///< Trigger deadzone (0-255)
+
+    InputResponseCurve m_curves[INPUT_AXIS_COUNT];  ///< Per-axis response curves
+    uint8_t m_tables[INPUT_AXIS_COUNT][256];        ///< Deadzone + curve per raw value
+
+    void rebuildStickTables();
+    void rebuildTriggerTables();
+    void rebuildTable(InputAxis axis);
+    static bool isValidCurve(const InputResponseCurve& curve);
 };
 
 // =============================================================================
@@ -224,6 +458,16 @@ inline uint8_t InputTranslator::getTriggerDeadzone() const
     return m_triggerDeadzone;
 }
 
+inline const InputResponseCurve& InputTranslator::getResponseCurve(InputAxis axis) const
+{
+    return m_curves[axis];
+}
+
+inline uint8_t InputTranslator::axisLookup(InputAxis axis, uint8_t value) const
+{
+    return m_tables[axis][value];
+}
+
 inline bool InputTranslator::isButtonPressed(const BigbenHIDReport* report, HIDButton button)
 {
     if (report == nullptr || button > HID_BTN_RESERVED_16) {
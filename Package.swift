@@ -22,7 +22,7 @@ let package = Package(
         .target(
             name: "CUSBController",
             path: "BigbenControllerApp/Sources/CUSBController",
-            sources: ["BigbenUSB.c"],
+            sources: ["BigbenUSB.c", "BigbenRing.c", "BigbenLatency.c", "BigbenDelta.c", "BigbenPublish.c", "BigbenRecord.c", "BigbenRumble.c", "BigbenBorrow.c", "BigbenBackend.cpp"],
             publicHeadersPath: "include",
             cSettings: [
                 .define("_GNU_SOURCE"),
@@ -50,7 +50,11 @@ let package = Package(
             sources: [
                 "main.swift",
                 "Services/USBController.swift",
-                "Services/KeyboardEmulator.swift"
+                "Services/USBArrivalMonitor.swift",
+                "Services/KeyboardEmulator.swift",
+                "Services/InputPipeline.swift",
+                "Services/InputReplay.swift",
+                "Services/InputBenchmark.swift"
             ],
             linkerSettings: [
                 .linkedFramework("IOKit"),
@@ -0,0 +1,149 @@
+//
+//  LatencyHistogram.h
+//  BigbenController
+//
+//  Fixed-bucket, lock-free latency histogram shared by the dext and the mapper
+//  Recording is three relaxed atomic adds and a rarely-taken max update, so it
+//  is safe to call from USB completions and event threads without locks.
+//
+
+#ifndef LatencyHistogram_h
+#define LatencyHistogram_h
+
+#include <stdint.h>
+
+// =============================================================================
+// MARK: - Layout
+// =============================================================================
+
+// Log-linear buckets: values 0-3 ns get their own bucket, then every power of
+// two is split into 4 sub-buckets (~19% worst-case error). 128 buckets cover
+// up to ~4.3 s; anything slower lands in the last bucket.
+#define BIGBEN_LATENCY_SUB_BITS     2
+#define BIGBEN_LATENCY_SUB_COUNT    (1u << BIGBEN_LATENCY_SUB_BITS)
+#define BIGBEN_LATENCY_BUCKETS      128
+
+typedef struct {
+    uint64_t buckets[BIGBEN_LATENCY_BUCKETS];
+    uint64_t count;
+    uint64_t sumNs;
+    uint64_t maxNs;
+} BigbenLatencyHistogram;
+
+// Percentile summary (all values in nanoseconds)
+typedef struct {
+    uint64_t count;
+    uint64_t meanNs;
+    uint64_t p50Ns;
+    uint64_t p99Ns;
+    uint64_t p999Ns;
+    uint64_t maxNs;
+} BigbenLatencySummary;
+
+// =============================================================================
+// MARK: - Bucket Math
+// =============================================================================
+
+static inline uint32_t BigbenLatencyBucket(uint64_t ns)
+{
+    if (ns < BIGBEN_LATENCY_SUB_COUNT) {
+        return (uint32_t)ns;
+    }
+
+    uint32_t msb = 63u - (uint32_t)__builtin_clzll(ns);
+    uint32_t sub = (uint32_t)(ns >> (msb - BIGBEN_LATENCY_SUB_BITS)) & (BIGBEN_LATENCY_SUB_COUNT - 1);
+    uint32_t index = (msb - BIGBEN_LATENCY_SUB_BITS + 1) * BIGBEN_LATENCY_SUB_COUNT + sub;
+
+    return index < BIGBEN_LATENCY_BUCKETS ? index : BIGBEN_LATENCY_BUCKETS - 1;
+}
+
+// Largest value that maps to the bucket (reported as the percentile value)
+static inline uint64_t BigbenLatencyBucketUpperBound(uint32_t index)
+{
+    if (index < BIGBEN_LATENCY_SUB_COUNT) {
+        return index;
+    }
+
+    uint32_t msb = index / BIGBEN_LATENCY_SUB_COUNT + BIGBEN_LATENCY_SUB_BITS - 1;
+    uint64_t sub = index % BIGBEN_LATENCY_SUB_COUNT;
+    uint64_t lower = (BIGBEN_LATENCY_SUB_COUNT + sub) << (msb - BIGBEN_LATENCY_SUB_BITS);
+
+    return lower + (1ull << (msb - BIGBEN_LATENCY_SUB_BITS)) - 1;
+}
+
+// =============================================================================
+// MARK: - Recording and Reading
+// =============================================================================
+
+static inline void BigbenLatencyRecord(BigbenLatencyHistogram *h, uint64_t ns)
+{
+    __atomic_fetch_add(&h->buckets[BigbenLatencyBucket(ns)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->sumNs, ns, __ATOMIC_RELAXED);
+
+    uint64_t max = __atomic_load_n(&h->maxNs, __ATOMIC_RELAXED);
+    while (ns > max &&
+           !__atomic_compare_exchange_n(&h->maxNs, &max, ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static inline void BigbenLatencyReset(BigbenLatencyHistogram *h)
+{
+    for (uint32_t i = 0; i < BIGBEN_LATENCY_BUCKETS; i++) {
+        __atomic_store_n(&h->buckets[i], 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&h->count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->sumNs, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->maxNs, 0, __ATOMIC_RELAXED);
+}
+
+// Summarize a histogram that may still be recording
+// Buckets are read one at a time, so the result is approximate under load
+static inline void BigbenLatencySummarize(const BigbenLatencyHistogram *h, BigbenLatencySummary *out)
+{
+    uint64_t counts[BIGBEN_LATENCY_BUCKETS];
+    uint64_t total = 0;
+
+    for (uint32_t i = 0; i < BIGBEN_LATENCY_BUCKETS; i++) {
+        counts[i] = __atomic_load_n(&h->buckets[i], __ATOMIC_RELAXED);
+        total += counts[i];
+    }
+
+    out->count = total;
+    out->maxNs = __atomic_load_n(&h->maxNs, __ATOMIC_RELAXED);
+    out->meanNs = total ? __atomic_load_n(&h->sumNs, __ATOMIC_RELAXED) / total : 0;
+    if (total == 0) {
+        out->p50Ns = out->p99Ns = out->p999Ns = 0;
+        return;
+    }
+
+    // UINT64_MAX marks a percentile that has not been reached yet
+    out->p50Ns = out->p99Ns = out->p999Ns = UINT64_MAX;
+
+    // Ranks for p50 / p99 / p99.9, rounded up so small samples report the tail
+    uint64_t rank50 = (total * 500 + 999) / 1000;
+    uint64_t rank99 = (total * 990 + 999) / 1000;
+    uint64_t rank999 = (total * 999 + 999) / 1000;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BIGBEN_LATENCY_BUCKETS; i++) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        seen += counts[i];
+        uint64_t bound = BigbenLatencyBucketUpperBound(i);
+        if (out->p50Ns == UINT64_MAX && seen >= rank50) out->p50Ns = bound;
+        if (out->p99Ns == UINT64_MAX && seen >= rank99) out->p99Ns = bound;
+        if (seen >= rank999) {
+            out->p999Ns = bound;
+            break;
+        }
+    }
+
+    // Never report a percentile above the observed maximum
+    if (out->p50Ns > out->maxNs) out->p50Ns = out->maxNs;
+    if (out->p99Ns > out->maxNs) out->p99Ns = out->maxNs;
+    if (out->p999Ns > out->maxNs) out->p999Ns = out->maxNs;
+}
+
+#endif /* LatencyHistogram_h */
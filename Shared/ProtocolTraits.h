@@ -0,0 +1,292 @@
+//
+//  ProtocolTraits.h
+//  BigbenController
+//
+//  Per-model input report layouts and parsers, specialized at compile time.
+//  ProtocolTraits<PID> describes one controller's report; consumers build
+//  their own parse functions from the traits and pick one per device when it
+//  is opened, so the per-report path never branches on the model. A new
+//  model only needs a traits specialization and an entry in ProtocolModels.
+//
+//  C++ only, and self-contained so that it can be included next to either
+//  BigbenProtocol.h (dext) or BigbenUSB.h (mapper library).
+//
+
+#ifndef ProtocolTraits_h
+#define ProtocolTraits_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+// =============================================================================
+// MARK: - Normalized State
+// =============================================================================
+
+// Buttons in the bit order of BigbenButton (BigbenProtocol.h)
+enum ProtocolButton : uint16_t {
+    kProtocolButtonA        = 1 << 0,
+    kProtocolButtonB        = 1 << 1,
+    kProtocolButtonX        = 1 << 2,
+    kProtocolButtonY        = 1 << 3,
+    kProtocolButtonLB       = 1 << 4,
+    kProtocolButtonRB       = 1 << 5,
+    kProtocolButtonLT       = 1 << 6,
+    kProtocolButtonRT       = 1 << 7,
+    kProtocolButtonBack     = 1 << 8,
+    kProtocolButtonStart    = 1 << 9,
+    kProtocolButtonLStick   = 1 << 10,
+    kProtocolButtonRStick   = 1 << 11,
+    kProtocolButtonHome     = 1 << 12,
+};
+
+#define PROTOCOL_HAT_NEUTRAL        8
+
+// Trigger level at which models without digital trigger bits report them
+// pressed (the XInput gamepad threshold)
+#define PROTOCOL_TRIGGER_THRESHOLD  30
+
+// One report, independent of the model it came from. Sticks keep 16 bits,
+// centre 0, X positive right and Y positive down as in HID; 8-bit sticks
+// are widened by a shift so they narrow back exactly.
+struct ProtocolPadState {
+    uint16_t buttons;       // ProtocolButton bits
+    uint8_t  hat;           // 0-7 clockwise from up, PROTOCOL_HAT_NEUTRAL
+    uint8_t  leftTrigger;
+    uint8_t  rightTrigger;
+    int16_t  leftX;
+    int16_t  leftY;
+    int16_t  rightX;
+    int16_t  rightY;
+};
+
+// Wire formats a model can use
+enum ProtocolFormat {
+    kProtocolFormatVendor    = 0,   // 64-byte Bigben report (BigbenInputReport in BigbenProtocol.h)
+    kProtocolFormatXInput    = 1,   // 20-byte XInput report (BigbenInputReport in BigbenUSB.h)
+    kProtocolFormatDualShock = 2,   // 64-byte DualShock 4 style report
+};
+
+// =============================================================================
+// MARK: - Field Helpers
+// =============================================================================
+
+static constexpr int16_t ProtocolWidenAxis(uint8_t value)
+{
+    return (int16_t)(((int32_t)value - 128) * 256);
+}
+
+static constexpr uint8_t ProtocolNarrowAxis(int16_t value)
+{
+    return (uint8_t)((value >> 8) + 128);
+}
+
+static constexpr uint16_t ProtocolRead16(const uint8_t *data, size_t offset)
+{
+    return (uint16_t)(data[offset] | (data[offset + 1] << 8));
+}
+
+// XInput D-pad bits (up, down, left, right in bits 0-3) to a hat value;
+// opposite directions pressed together cancel out
+static constexpr uint8_t kProtocolDPadBitsToHat[16] = {
+    8, 0, 4, 8,     // -, U, D, UD
+    6, 7, 5, 6,     // L, UL, DL, UDL
+    2, 1, 3, 2,     // R, UR, DR, UDR
+    8, 0, 4, 8,     // LR, ULR, DLR, UDLR
+};
+
+// Hat value to XInput D-pad bits, the inverse of the table above
+static constexpr uint8_t kProtocolHatToDPadBits[9] = {
+    0x1, 0x9, 0x8, 0xA, 0x2, 0x6, 0x4, 0x5, 0x0
+};
+
+static constexpr uint8_t ProtocolHatToDPadBits(uint8_t hat)
+{
+    return kProtocolHatToDPadBits[hat < PROTOCOL_HAT_NEUTRAL ? hat : PROTOCOL_HAT_NEUTRAL];
+}
+
+// =============================================================================
+// MARK: - Model Traits
+// =============================================================================
+
+// Every specialization provides:
+//   kProductID, kName, kFormat
+//   kMinReportSize      bytes needed by parse()
+//   accepts(data, len)  header check; len >= kMinReportSize is already known
+//   parse(data, state)  decode every field
+// and constexpr offsets for the fields its parser reads.
+template <uint16_t ProductID>
+struct ProtocolTraits;
+
+// PC Compact Controller, XInput mode
+template <>
+struct ProtocolTraits<0x0603> {
+    static constexpr uint16_t       kProductID      = 0x0603;
+    static constexpr const char    *kName           = "PC Compact Controller";
+    static constexpr ProtocolFormat kFormat         = kProtocolFormatXInput;
+    static constexpr size_t         kMinReportSize  = 14;
+
+    static constexpr size_t kTypeOffset         = 0;    // 0x00 for input
+    static constexpr size_t kButtonsOffset      = 2;    // XInput button bits, little endian
+    static constexpr size_t kLeftTriggerOffset  = 4;
+    static constexpr size_t kRightTriggerOffset = 5;
+    static constexpr size_t kLeftXOffset        = 6;    // int16, Y positive up
+    static constexpr size_t kLeftYOffset        = 8;
+    static constexpr size_t kRightXOffset       = 10;
+    static constexpr size_t kRightYOffset       = 12;
+
+    static constexpr bool accepts(const uint8_t *data, size_t)
+    {
+        return data[kTypeOffset] == 0x00;
+    }
+
+    static inline void parse(const uint8_t *data, ProtocolPadState *state)
+    {
+        uint16_t bits = ProtocolRead16(data, kButtonsOffset);
+        uint16_t buttons = 0;
+        buttons |= (bits & 0x1000) ? kProtocolButtonA : 0;
+        buttons |= (bits & 0x2000) ? kProtocolButtonB : 0;
+        buttons |= (bits & 0x4000) ? kProtocolButtonX : 0;
+        buttons |= (bits & 0x8000) ? kProtocolButtonY : 0;
+        buttons |= (bits & 0x0100) ? kProtocolButtonLB : 0;
+        buttons |= (bits & 0x0200) ? kProtocolButtonRB : 0;
+        buttons |= (bits & 0x0020) ? kProtocolButtonBack : 0;
+        buttons |= (bits & 0x0010) ? kProtocolButtonStart : 0;
+        buttons |= (bits & 0x0040) ? kProtocolButtonLStick : 0;
+        buttons |= (bits & 0x0080) ? kProtocolButtonRStick : 0;
+        buttons |= (bits & 0x0400) ? kProtocolButtonHome : 0;
+
+        state->leftTrigger = data[kLeftTriggerOffset];
+        state->rightTrigger = data[kRightTriggerOffset];
+        buttons |= state->leftTrigger >= PROTOCOL_TRIGGER_THRESHOLD ? kProtocolButtonLT : 0;
+        buttons |= state->rightTrigger >= PROTOCOL_TRIGGER_THRESHOLD ? kProtocolButtonRT : 0;
+
+        state->buttons = buttons;
+        state->hat = kProtocolDPadBitsToHat[bits & 0x0F];
+
+        // Bitwise NOT flips Y to positive down without overflowing at -32768
+        state->leftX = (int16_t)ProtocolRead16(data, kLeftXOffset);
+        state->leftY = (int16_t)~ProtocolRead16(data, kLeftYOffset);
+        state->rightX = (int16_t)ProtocolRead16(data, kRightXOffset);
+        state->rightY = (int16_t)~ProtocolRead16(data, kRightYOffset);
+    }
+};
+
+// PS4 Compact Controller, DualShock 4 style report
+template <>
+struct ProtocolTraits<0x0d05> {
+    static constexpr uint16_t       kProductID      = 0x0d05;
+    static constexpr const char    *kName           = "PS4 Compact Controller";
+    static constexpr ProtocolFormat kFormat         = kProtocolFormatDualShock;
+    static constexpr size_t         kMinReportSize  = 10;
+
+    static constexpr size_t kReportIDOffset     = 0;    // 0x01
+    static constexpr size_t kLeftXOffset        = 1;    // 0-255, Y positive down
+    static constexpr size_t kLeftYOffset        = 2;
+    static constexpr size_t kRightXOffset       = 3;
+    static constexpr size_t kRightYOffset       = 4;
+    static constexpr size_t kHatFaceOffset      = 5;    // Hat in bits 0-3, face buttons in 4-7
+    static constexpr size_t kShoulderOffset     = 6;    // L1 R1 L2 R2 Share Options L3 R3
+    static constexpr size_t kSystemOffset       = 7;    // PS in bit 0
+    static constexpr size_t kLeftTriggerOffset  = 8;
+    static constexpr size_t kRightTriggerOffset = 9;
+
+    static constexpr bool accepts(const uint8_t *data, size_t)
+    {
+        return data[kReportIDOffset] == 0x01;
+    }
+
+    static inline void parse(const uint8_t *data, ProtocolPadState *state)
+    {
+        uint8_t face = data[kHatFaceOffset];
+        uint8_t shoulder = data[kShoulderOffset];
+        uint16_t buttons = 0;
+        buttons |= (face & 0x20) ? kProtocolButtonA : 0;        // Cross
+        buttons |= (face & 0x40) ? kProtocolButtonB : 0;        // Circle
+        buttons |= (face & 0x10) ? kProtocolButtonX : 0;        // Square
+        buttons |= (face & 0x80) ? kProtocolButtonY : 0;        // Triangle
+        buttons |= (uint16_t)(shoulder & 0x0F) << 4;            // L1 R1 L2 R2 in order
+        buttons |= (uint16_t)(shoulder & 0xF0) << 4;            // Share Options L3 R3 in order
+        buttons |= (data[kSystemOffset] & 0x01) ? kProtocolButtonHome : 0;
+
+        uint8_t hat = face & 0x0F;
+        state->buttons = buttons;
+        state->hat = hat < PROTOCOL_HAT_NEUTRAL ? hat : PROTOCOL_HAT_NEUTRAL;
+        state->leftTrigger = data[kLeftTriggerOffset];
+        state->rightTrigger = data[kRightTriggerOffset];
+        state->leftX = ProtocolWidenAxis(data[kLeftXOffset]);
+        state->leftY = ProtocolWidenAxis(data[kLeftYOffset]);
+        state->rightX = ProtocolWidenAxis(data[kRightXOffset]);
+        state->rightY = ProtocolWidenAxis(data[kRightYOffset]);
+    }
+};
+
+// PS3 Minipad, the Bigben vendor report
+template <>
+struct ProtocolTraits<0x0902> {
+    static constexpr uint16_t       kProductID      = 0x0902;
+    static constexpr const char    *kName           = "PS3 Minipad";
+    static constexpr ProtocolFormat kFormat         = kProtocolFormatVendor;
+    static constexpr size_t         kMinReportSize  = 64;
+
+    static constexpr size_t kReportIDOffset     = 0;    // 0x01
+    static constexpr size_t kLeftXOffset        = 1;    // 0-255, Y positive down
+    static constexpr size_t kLeftYOffset        = 2;
+    static constexpr size_t kRightXOffset       = 3;
+    static constexpr size_t kRightYOffset       = 4;
+    static constexpr size_t kDPadOffset         = 5;    // Hat 0-7, 8 = neutral
+    static constexpr size_t kButtonsOffset      = 6;    // ProtocolButton bits, little endian
+    static constexpr size_t kLeftTriggerOffset  = 8;
+    static constexpr size_t kRightTriggerOffset = 9;
+
+    static constexpr bool accepts(const uint8_t *data, size_t)
+    {
+        return data[kReportIDOffset] == 0x01;
+    }
+
+    static inline void parse(const uint8_t *data, ProtocolPadState *state)
+    {
+        uint8_t hat = data[kDPadOffset];
+        state->buttons = ProtocolRead16(data, kButtonsOffset);
+        state->hat = hat < PROTOCOL_HAT_NEUTRAL ? hat : PROTOCOL_HAT_NEUTRAL;
+        state->leftTrigger = data[kLeftTriggerOffset];
+        state->rightTrigger = data[kRightTriggerOffset];
+        state->leftX = ProtocolWidenAxis(data[kLeftXOffset]);
+        state->leftY = ProtocolWidenAxis(data[kLeftYOffset]);
+        state->rightX = ProtocolWidenAxis(data[kRightXOffset]);
+        state->rightY = ProtocolWidenAxis(data[kRightYOffset]);
+    }
+};
+
+// =============================================================================
+// MARK: - Model Selection
+// =============================================================================
+
+template <uint16_t... ProductIDs>
+struct ProtocolModelList {};
+
+// Every model with traits, in matching order
+typedef ProtocolModelList<0x0603, 0x0d05, 0x0902> ProtocolModels;
+
+// Find the entry for productID in a table built from every model.
+// Entry must be a literal type with a productID member and a
+// `template <class Traits> static constexpr Entry forModel()`; the table is
+// constant-initialized, so lookups never take a lock or allocate.
+template <class Entry, uint16_t... ProductIDs>
+static inline const Entry *ProtocolSelectFrom(ProtocolModelList<ProductIDs...>, uint16_t productID)
+{
+    static constexpr Entry kEntries[] = { Entry::template forModel<ProtocolTraits<ProductIDs>>()... };
+    for (const Entry &entry : kEntries) {
+        if (entry.productID == productID) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+template <class Entry>
+static inline const Entry *ProtocolSelect(uint16_t productID)
+{
+    return ProtocolSelectFrom<Entry>(ProtocolModels(), productID);
+}
+
+#endif /* ProtocolTraits_h */
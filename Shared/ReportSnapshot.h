@@ -0,0 +1,85 @@
+//
+//  ReportSnapshot.h
+//  BigbenController
+//
+//  Seqlock-published copy of the latest translated HID report, so GET_REPORT
+//  can read it from any queue while completions keep writing. Publishing is
+//  two sequence stores around three word stores and never waits; readers
+//  retry in the rare case they overlap a publish, and never see a torn report.
+//
+
+#ifndef ReportSnapshot_h
+#define ReportSnapshot_h
+
+#include <stdint.h>
+#include <string.h>
+#include "HIDReportDescriptor.h"
+
+// =============================================================================
+// MARK: - Layout
+// =============================================================================
+
+#define BIGBEN_SNAPSHOT_WORDS   ((sizeof(BigbenHIDReport) + 3) / 4)
+
+typedef struct {
+    uint64_t sequence;                      // Odd while a publish is in progress, 0 = never published;
+                                            // 64 bits so it never wraps back to 0
+    uint32_t words[BIGBEN_SNAPSHOT_WORDS];  // BigbenHIDReport, copied as whole words
+    uint64_t timestamp;                     // mach time of the report
+} BigbenReportSnapshot;
+
+// =============================================================================
+// MARK: - Publish and Read
+// =============================================================================
+
+// Single writer: call from the queue that translates reports
+static inline void BigbenSnapshotPublish(BigbenReportSnapshot *snapshot,
+                                         const BigbenHIDReport *report, uint64_t timestamp)
+{
+    uint32_t words[BIGBEN_SNAPSHOT_WORDS] = { 0 };
+    memcpy(words, report, sizeof(BigbenHIDReport));
+
+    uint64_t sequence = __atomic_load_n(&snapshot->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&snapshot->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    for (uint32_t i = 0; i < BIGBEN_SNAPSHOT_WORDS; i++) {
+        __atomic_store_n(&snapshot->words[i], words[i], __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&snapshot->timestamp, timestamp, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&snapshot->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+// Copy the latest report; returns 0 if nothing has been published yet
+// timestamp is optional. Lock-free: retries only while a publish overlaps.
+static inline int BigbenSnapshotRead(const BigbenReportSnapshot *snapshot,
+                                     BigbenHIDReport *report, uint64_t *timestamp)
+{
+    uint32_t words[BIGBEN_SNAPSHOT_WORDS];
+    uint64_t stamp;
+    uint64_t before, after;
+
+    do {
+        before = __atomic_load_n(&snapshot->sequence, __ATOMIC_ACQUIRE);
+        if (before == 0) {
+            return 0;
+        }
+
+        for (uint32_t i = 0; i < BIGBEN_SNAPSHOT_WORDS; i++) {
+            words[i] = __atomic_load_n(&snapshot->words[i], __ATOMIC_RELAXED);
+        }
+        stamp = __atomic_load_n(&snapshot->timestamp, __ATOMIC_RELAXED);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&snapshot->sequence, __ATOMIC_RELAXED);
+    } while ((before & 1) != 0 || before != after);
+
+    memcpy(report, words, sizeof(BigbenHIDReport));
+    if (timestamp) {
+        *timestamp = stamp;
+    }
+    return 1;
+}
+
+#endif /* ReportSnapshot_h */
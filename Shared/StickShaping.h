@@ -0,0 +1,192 @@
+//
+//  StickShaping.h
+//  BigbenController
+//
+//  Fixed-point radial deadzone and response curve engine shared by the dext
+//  and the mapper. Sticks are shaped as a pair, so the deadzone is a circle
+//  rather than a cross and diagonals keep their direction. Everything is
+//  integer math on Q15 values (BIGBEN_STICK_ONE = full deflection).
+//
+
+#ifndef StickShaping_h
+#define StickShaping_h
+
+#include <stdint.h>
+
+// =============================================================================
+// MARK: - Configuration
+// =============================================================================
+
+#define BIGBEN_STICK_ONE            32767
+#define BIGBEN_STICK_CURVE_SEGMENTS 64
+#define BIGBEN_STICK_CURVE_SHIFT    9       // log2(32768 / BIGBEN_STICK_CURVE_SEGMENTS)
+
+typedef enum {
+    BIGBEN_DEADZONE_RADIAL        = 0,  // Zero inside the inner circle, unchanged outside
+    BIGBEN_DEADZONE_SCALED_RADIAL = 1,  // Rescale inner..outer to 0..1, no jump at the edge
+} BigbenDeadzoneMode;
+
+typedef enum {
+    BIGBEN_STICK_CURVE_LINEAR     = 0,
+    BIGBEN_STICK_CURVE_MULTISTAGE = 1,  // Precision, linear and acceleration zones
+} BigbenStickCurve;
+
+typedef struct {
+    int32_t             inner;          // Q15 radius below which the stick is centred
+    int32_t             outer;          // Q15 radius treated as full deflection
+    BigbenDeadzoneMode  mode;
+    BigbenStickCurve    curve;
+} BigbenStickShape;
+
+// =============================================================================
+// MARK: - Response Tables
+// =============================================================================
+
+// Output magnitude (Q15) at 65 evenly spaced input magnitudes from 0 to full
+// scale, linearly interpolated in between
+
+static const uint16_t BigbenStickCurveLinear[BIGBEN_STICK_CURVE_SEGMENTS + 1] = {
+        0,   512,  1024,  1536,  2048,  2560,  3072,  3584,
+     4096,  4608,  5120,  5632,  6144,  6656,  7168,  7680,
+     8192,  8704,  9216,  9728, 10240, 10752, 11264, 11776,
+    12288, 12800, 13312, 13824, 14336, 14848, 15360, 15872,
+    16384, 16896, 17408, 17920, 18432, 18944, 19456, 19968,
+    20480, 20992, 21504, 22016, 22528, 23040, 23552, 24064,
+    24576, 25088, 25600, 26112, 26624, 27136, 27648, 28160,
+    28672, 29184, 29696, 30208, 30720, 31232, 31744, 32256,
+    32767
+};
+
+// 0-40%: power 0.7 for fine aiming, 40-80%: linear, 80-100%: power 1.3
+static const uint16_t BigbenStickCurveMultistage[BIGBEN_STICK_CURVE_SEGMENTS + 1] = {
+        0,  1354,  2200,  2922,  3574,  4178,  4747,  5288,
+     5806,  6305,  6788,  7256,  7712,  8156,  8590,  9016,
+     9432,  9841, 10243, 10638, 11027, 11410, 11788, 12160,
+    12528, 12891, 13312, 13824, 14336, 14848, 15360, 15872,
+    16384, 16895, 17407, 17919, 18431, 18943, 19455, 19967,
+    20479, 20991, 21503, 22015, 22527, 23039, 23551, 24063,
+    24575, 25087, 25599, 26111, 26392, 26725, 27122, 27565,
+    28045, 28555, 29093, 29656, 30240, 30845, 31468, 32109,
+    32767
+};
+
+// =============================================================================
+// MARK: - Helpers
+// =============================================================================
+
+// Integer square root, rounded down
+static inline uint32_t BigbenStickIsqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+// Position 0-32768 through the table
+static inline int32_t BigbenStickCurveLookup(BigbenStickCurve curve, int32_t position)
+{
+    const uint16_t* table = (curve == BIGBEN_STICK_CURVE_MULTISTAGE)
+        ? BigbenStickCurveMultistage
+        : BigbenStickCurveLinear;
+
+    int32_t segment = position >> BIGBEN_STICK_CURVE_SHIFT;
+    if (segment >= BIGBEN_STICK_CURVE_SEGMENTS) {
+        return table[BIGBEN_STICK_CURVE_SEGMENTS];
+    }
+
+    int32_t fraction = position & ((1 << BIGBEN_STICK_CURVE_SHIFT) - 1);
+    int32_t lo = table[segment];
+    int32_t hi = table[segment + 1];
+    return lo + (((hi - lo) * fraction) >> BIGBEN_STICK_CURVE_SHIFT);
+}
+
+// =============================================================================
+// MARK: - Shaping
+// =============================================================================
+
+// inner and outer are Q15 radii; outer is kept above inner
+static inline void BigbenStickShapeInit(BigbenStickShape* shape, int32_t inner, int32_t outer,
+                                        BigbenDeadzoneMode mode, BigbenStickCurve curve)
+{
+    if (inner < 0) inner = 0;
+    if (inner >= BIGBEN_STICK_ONE) inner = BIGBEN_STICK_ONE - 1;
+    if (outer > BIGBEN_STICK_ONE) outer = BIGBEN_STICK_ONE;
+    if (outer <= inner) outer = inner + 1;
+
+    shape->inner = inner;
+    shape->outer = outer;
+    shape->mode = mode;
+    shape->curve = curve;
+}
+
+// Same, from a deadzone radius on the 0-127 scale of the Bigben report's
+// sticks, reaching full deflection at the edge
+static inline void BigbenStickShapeInit8(BigbenStickShape* shape, uint8_t deadzone,
+                                         BigbenDeadzoneMode mode, BigbenStickCurve curve)
+{
+    int32_t inner = ((int32_t)(deadzone > 127 ? 127 : deadzone) * BIGBEN_STICK_ONE) / 127;
+    BigbenStickShapeInit(shape, inner, BIGBEN_STICK_ONE, mode, curve);
+}
+
+// Shape one stick given as signed Q15 axes; outputs are Q15, 0 inside the
+// deadzone. Diagonals beyond full scale are clamped at the outer edge.
+static inline void BigbenStickApply(const BigbenStickShape* shape, int32_t x, int32_t y,
+                                    int32_t* outX, int32_t* outY)
+{
+    if (x < -BIGBEN_STICK_ONE) x = -BIGBEN_STICK_ONE;
+    if (x > BIGBEN_STICK_ONE) x = BIGBEN_STICK_ONE;
+    if (y < -BIGBEN_STICK_ONE) y = -BIGBEN_STICK_ONE;
+    if (y > BIGBEN_STICK_ONE) y = BIGBEN_STICK_ONE;
+
+    int32_t magnitude = (int32_t)BigbenStickIsqrt((uint32_t)(x * x) + (uint32_t)(y * y));
+    if (magnitude <= shape->inner) {
+        *outX = 0;
+        *outY = 0;
+        return;
+    }
+
+    int32_t clamped = magnitude < shape->outer ? magnitude : shape->outer;
+    int32_t from = (shape->mode == BIGBEN_DEADZONE_SCALED_RADIAL) ? shape->inner : 0;
+    int32_t position = (int32_t)(((int64_t)(clamped - from) << 15) / (shape->outer - from));
+    int32_t length = BigbenStickCurveLookup(shape->curve, position);
+
+    // Keep the stick's direction, replace its length
+    *outX = (int32_t)(((int64_t)x * length) / magnitude);
+    *outY = (int32_t)(((int64_t)y * length) / magnitude);
+}
+
+// Shape an 8-bit stick pair (0-255, 128 = center) in place, as carried by
+// the Bigben report. The negative side reaches 128 steps, the positive 127.
+static inline void BigbenStickApply8(const BigbenStickShape* shape, uint8_t* x, uint8_t* y)
+{
+    int32_t cx = (int32_t)*x - 128;
+    int32_t cy = (int32_t)*y - 128;
+    int32_t qx = cx < 0 ? (cx * BIGBEN_STICK_ONE) / 128 : (cx * BIGBEN_STICK_ONE) / 127;
+    int32_t qy = cy < 0 ? (cy * BIGBEN_STICK_ONE) / 128 : (cy * BIGBEN_STICK_ONE) / 127;
+
+    int32_t sx, sy;
+    BigbenStickApply(shape, qx, qy, &sx, &sy);
+
+    // Round to nearest on the way back so small outputs are not lost
+    int32_t ox = sx < 0 ? -((-sx * 128 + BIGBEN_STICK_ONE / 2) / BIGBEN_STICK_ONE)
+                        : (sx * 127 + BIGBEN_STICK_ONE / 2) / BIGBEN_STICK_ONE;
+    int32_t oy = sy < 0 ? -((-sy * 128 + BIGBEN_STICK_ONE / 2) / BIGBEN_STICK_ONE)
+                        : (sy * 127 + BIGBEN_STICK_ONE / 2) / BIGBEN_STICK_ONE;
+    *x = (uint8_t)(128 + ox);
+    *y = (uint8_t)(128 + oy);
+}
+
+#endif /* StickShaping_h */
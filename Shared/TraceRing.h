@@ -0,0 +1,161 @@
+//
+//  TraceRing.h
+//  BigbenController
+//
+//  Binary flight recorder for per-report events in the dext. Recording an
+//  event is a handful of stores and one release store, with no formatting,
+//  so it can stay on in production; the ring is drained and formatted only
+//  when someone asks (LogControllerState, or on Stop).
+//
+
+#ifndef TraceRing_h
+#define TraceRing_h
+
+#include <stdint.h>
+
+// =============================================================================
+// MARK: - Layout
+// =============================================================================
+
+// Power of two; the oldest records are overwritten once the ring is full
+#define BIGBEN_TRACE_CAPACITY   256
+#define BIGBEN_TRACE_MASK       (BIGBEN_TRACE_CAPACITY - 1)
+
+typedef enum {
+    BIGBEN_TRACE_INPUT_CHANGED = 1,     // arg16 buttons, arg64 BigbenTracePackAxes()
+    BIGBEN_TRACE_READ_ERROR,            // arg32 IOReturn
+    BIGBEN_TRACE_SHORT_READ,            // arg32 byte count
+    BIGBEN_TRACE_BAD_REPORT_ID,         // arg16 report ID
+    BIGBEN_TRACE_GET_REPORT,            // arg16 report type, arg32 report ID
+    BIGBEN_TRACE_SET_REPORT,            // arg16 report ID, arg32 IOReturn
+    BIGBEN_TRACE_OUTPUT_SENT,           // arg16 report ID, arg32 byte count
+    BIGBEN_TRACE_OUTPUT_ERROR,          // arg16 report ID, arg32 IOReturn
+    BIGBEN_TRACE_DISPATCH_ERROR,        // arg32 IOReturn from handleReport
+    BIGBEN_TRACE_INPUT_REJECTED,        // arg16 report ID, arg32 length
+    BIGBEN_TRACE_EVENT_COUNT
+} BigbenTraceEvent;
+
+typedef struct {
+    uint64_t timestamp;                 // mach_absolute_time()
+    uint16_t event;                     // BigbenTraceEvent
+    uint16_t arg16;
+    uint32_t arg32;
+    uint64_t arg64;
+} BigbenTraceRecord;
+
+typedef struct {
+    BigbenTraceRecord records[BIGBEN_TRACE_CAPACITY];
+    uint64_t head;                      // Records written since reset
+    uint64_t claimed;                   // head + 1 while a record is being written
+} BigbenTraceRing;
+
+// =============================================================================
+// MARK: - Recording
+// =============================================================================
+
+// Single producer: call from the driver's queue only
+static inline void BigbenTraceRecordEvent(BigbenTraceRing *ring, BigbenTraceEvent event,
+                                          uint64_t timestamp, uint16_t arg16,
+                                          uint32_t arg32, uint64_t arg64)
+{
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    BigbenTraceRecord *record = &ring->records[head & BIGBEN_TRACE_MASK];
+
+    // Tell a concurrent drain this slot is being rewritten before touching it
+    __atomic_store_n(&ring->claimed, head + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    record->timestamp = timestamp;
+    record->event = (uint16_t)event;
+    record->arg16 = arg16;
+    record->arg32 = arg32;
+    record->arg64 = arg64;
+
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+// Sticks, triggers and hat of a HID report, one byte each from the low end
+static inline uint64_t BigbenTracePackAxes(uint8_t leftX, uint8_t leftY,
+                                           uint8_t rightX, uint8_t rightY,
+                                           uint8_t leftTrigger, uint8_t rightTrigger,
+                                           uint8_t hat)
+{
+    return (uint64_t)leftX | ((uint64_t)leftY << 8) |
+           ((uint64_t)rightX << 16) | ((uint64_t)rightY << 24) |
+           ((uint64_t)leftTrigger << 32) | ((uint64_t)rightTrigger << 40) |
+           ((uint64_t)hat << 48);
+}
+
+static inline uint8_t BigbenTraceAxis(uint64_t packed, uint32_t index)
+{
+    return (uint8_t)(packed >> (index * 8));
+}
+
+// =============================================================================
+// MARK: - Draining
+// =============================================================================
+
+// Copy up to `capacity` records written after *cursor into out, oldest
+// first, and advance the cursor. Safe against a concurrent producer: records
+// overwritten while being copied are discarded and counted in *lost together
+// with those that had already been overwritten.
+static inline uint32_t BigbenTraceDrain(const BigbenTraceRing *ring, uint64_t *cursor,
+                                        BigbenTraceRecord *out, uint32_t capacity,
+                                        uint64_t *lost)
+{
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t start = *cursor;
+    uint64_t skipped = 0;
+
+    if (head - start > BIGBEN_TRACE_CAPACITY) {
+        skipped = head - start - BIGBEN_TRACE_CAPACITY;
+        start = head - BIGBEN_TRACE_CAPACITY;
+    }
+
+    uint64_t end = head - start > capacity ? start + capacity : head;
+    for (uint64_t i = start; i < end; i++) {
+        out[i - start] = ring->records[i & BIGBEN_TRACE_MASK];
+    }
+
+    // The producer may have lapped the copy: every record older than the
+    // last claimed one minus a full ring may have been rewritten under us
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint64_t claimed = __atomic_load_n(&ring->claimed, __ATOMIC_RELAXED);
+    uint32_t count = (uint32_t)(end - start);
+    if (claimed > start + BIGBEN_TRACE_CAPACITY) {
+        uint64_t torn = claimed - BIGBEN_TRACE_CAPACITY - start;
+        if (torn > count) {
+            torn = count;
+        }
+        for (uint32_t i = 0; i + torn < count; i++) {
+            out[i] = out[i + torn];
+        }
+        count -= (uint32_t)torn;
+        skipped += torn;
+    }
+
+    *cursor = end;
+    if (lost) {
+        *lost = skipped;
+    }
+    return count;
+}
+
+static inline const char *BigbenTraceEventName(uint16_t event)
+{
+    switch (event) {
+        case BIGBEN_TRACE_INPUT_CHANGED:    return "Input";
+        case BIGBEN_TRACE_READ_ERROR:       return "ReadError";
+        case BIGBEN_TRACE_SHORT_READ:       return "ShortRead";
+        case BIGBEN_TRACE_BAD_REPORT_ID:    return "BadReportID";
+        case BIGBEN_TRACE_GET_REPORT:       return "GetReport";
+        case BIGBEN_TRACE_SET_REPORT:       return "SetReport";
+        case BIGBEN_TRACE_OUTPUT_SENT:      return "OutputSent";
+        case BIGBEN_TRACE_OUTPUT_ERROR:     return "OutputError";
+        case BIGBEN_TRACE_DISPATCH_ERROR:   return "DispatchError";
+        case BIGBEN_TRACE_INPUT_REJECTED:   return "InputRejected";
+        default:                            return "Unknown";
+    }
+}
+
+#endif /* TraceRing_h */
@@ -0,0 +1,382 @@
+//
+//  TranslatorBenchmarks.cpp
+//  BigbenControllerDriver Tests
+//
+//  Microbenchmarks for the InputTranslator hot paths.
+//  Measures ns/report for single and batched translation across deadzone
+//  settings and input distributions, and prints one JSON document to stdout
+//  so results can be diffed between commits.
+//
+//  Build and run from the repository root:
+//    c++ -std=c++17 -O2 -o translator-bench Tests/Benchmarks/TranslatorBenchmarks.cpp BigbenControllerDriver/Sources/InputTranslator.cpp
+//    ./translator-bench > bench.json
+//
+//  Options:
+//    --reports N     Reports per distribution (default 65536)
+//    --repeats N     Timed repetitions, the median is reported (default 7)
+//    --input FILE    Add a distribution from a capture of raw 64-byte reports
+//
+//  Copyright (c) 2024. Licensed under MIT License.
+//
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Include the classes under test
+#include "../../BigbenControllerDriver/Sources/InputTranslator.h"
+
+// =============================================================================
+// MARK: - Configuration
+// =============================================================================
+
+static size_t reportsPerDistribution = 65536;
+static int timedRepeats = 7;
+
+static const uint8_t kDeadzones[] = { 0, INPUT_TRANSLATOR_DEFAULT_DEADZONE, 40, 127 };
+static const size_t kBatchSizes[] = { 1, 4, 16, 64 };
+
+// Keeps results observable so the compiler cannot drop the work
+static volatile uint32_t benchmarkSink = 0;
+
+// =============================================================================
+// MARK: - Input Distributions
+// =============================================================================
+
+struct Distribution {
+    std::string name;
+    std::vector<BigbenInputReport> reports;
+};
+
+// Small deterministic generator so every run sees the same inputs
+struct Random {
+    uint32_t state;
+    explicit Random(uint32_t seed) : state(seed) {}
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    int range(int lo, int hi) { return lo + (int)(next() % (uint32_t)(hi - lo + 1)); }
+};
+
+static uint8_t clampAxis(int value)
+{
+    return (uint8_t)std::min(255, std::max(0, value));
+}
+
+static BigbenInputReport neutralReport()
+{
+    BigbenInputReport report;
+    memset(&report, 0, sizeof(report));
+    report.reportId = BIGBEN_REPORT_ID_INPUT;
+    report.leftStickX = report.leftStickY = 128;
+    report.rightStickX = report.rightStickY = 128;
+    report.dpad = BIGBEN_DPAD_NEUTRAL;
+    return report;
+}
+
+// Controller resting on the desk: sticks jitter a few counts around center
+static Distribution makeIdle(size_t count)
+{
+    Distribution d{ "idle", {} };
+    Random rng(1);
+    for (size_t i = 0; i < count; i++) {
+        BigbenInputReport r = neutralReport();
+        r.leftStickX = clampAxis(128 + rng.range(-3, 3));
+        r.leftStickY = clampAxis(128 + rng.range(-3, 3));
+        r.rightStickX = clampAxis(128 + rng.range(-3, 3));
+        r.rightStickY = clampAxis(128 + rng.range(-3, 3));
+        d.reports.push_back(r);
+    }
+    return d;
+}
+
+// Typical shooter input: walking on the left stick, aiming sweeps on the
+// right, occasional trigger pulls and button presses
+static Distribution makeGameplay(size_t count)
+{
+    Distribution d{ "gameplay", {} };
+    Random rng(2);
+    int lx = 128, ly = 128, rx = 128, ry = 128, lt = 0, rt = 0;
+    uint16_t buttons = 0;
+    for (size_t i = 0; i < count; i++) {
+        // Sticks drift toward a new target every ~250 reports
+        if (i % 250 == 0) {
+            lx = rng.range(0, 255);
+            ly = rng.range(0, 64);
+        }
+        rx = clampAxis(rx + rng.range(-6, 6));
+        ry = clampAxis(ry + rng.range(-4, 4));
+        if (i % 97 == 0) rt = rt ? 0 : 255;
+        if (i % 151 == 0) lt = rng.range(0, 255);
+        if (i % 40 == 0) buttons = (uint16_t)(rng.next() & 0x1FFF);
+
+        BigbenInputReport r = neutralReport();
+        r.leftStickX = clampAxis(lx + rng.range(-2, 2));
+        r.leftStickY = clampAxis(ly + rng.range(-2, 2));
+        r.rightStickX = (uint8_t)rx;
+        r.rightStickY = (uint8_t)ry;
+        r.leftTrigger = (uint8_t)lt;
+        r.rightTrigger = (uint8_t)rt;
+        r.buttons = buttons;
+        r.dpad = (uint8_t)((i / 500) % 9);
+        d.reports.push_back(r);
+    }
+    return d;
+}
+
+// Worst case for branchy code: every field uniformly random
+static Distribution makeUniform(size_t count)
+{
+    Distribution d{ "uniform", {} };
+    Random rng(3);
+    for (size_t i = 0; i < count; i++) {
+        BigbenInputReport r = neutralReport();
+        r.leftStickX = (uint8_t)rng.next();
+        r.leftStickY = (uint8_t)rng.next();
+        r.rightStickX = (uint8_t)rng.next();
+        r.rightStickY = (uint8_t)rng.next();
+        r.leftTrigger = (uint8_t)rng.next();
+        r.rightTrigger = (uint8_t)rng.next();
+        r.buttons = (uint16_t)rng.next();
+        r.dpad = (uint8_t)(rng.next() % 10);
+        d.reports.push_back(r);
+    }
+    return d;
+}
+
+// Raw 64-byte reports as read from the interrupt endpoint
+static bool loadCapture(const char* path, Distribution* d)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot open capture %s\n", path);
+        return false;
+    }
+
+    d->name = std::string("capture:") + path;
+    BigbenInputReport report;
+    while (fread(&report, sizeof(report), 1, file) == 1) {
+        if (report.reportId == BIGBEN_REPORT_ID_INPUT) {
+            d->reports.push_back(report);
+        }
+    }
+    fclose(file);
+
+    if (d->reports.empty()) {
+        fprintf(stderr, "Capture %s contains no input reports\n", path);
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// MARK: - Timing
+// =============================================================================
+
+struct Result {
+    std::string benchmark;
+    std::string distribution;
+    std::string curve;
+    int deadzone;
+    size_t batch;
+    double nsPerReport;
+};
+
+static std::vector<Result> results;
+
+// Runs body() once to warm up, then timedRepeats times; returns median ns/report
+template <typename Body>
+static double measure(size_t reportCount, Body body)
+{
+    body();
+
+    std::vector<double> samples;
+    for (int i = 0; i < timedRepeats; i++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto end = std::chrono::steady_clock::now();
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        samples.push_back(ns / (double)reportCount);
+    }
+
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+static uint32_t checksum(const std::vector<BigbenHIDReport>& reports)
+{
+    uint32_t sum = 0;
+    for (const BigbenHIDReport& r : reports) {
+        sum += r.leftStickX + r.rightStickY + r.leftTrigger + r.buttons + r.hatSwitch;
+    }
+    return sum;
+}
+
+// =============================================================================
+// MARK: - Benchmarks
+// =============================================================================
+
+static void benchmarkTranslate(const Distribution& d, const InputTranslator& translator,
+                               const char* curve, int deadzone)
+{
+    std::vector<BigbenHIDReport> out(d.reports.size());
+
+    double ns = measure(d.reports.size(), [&] {
+        for (size_t i = 0; i < d.reports.size(); i++) {
+            translator.translate(&d.reports[i], &out[i]);
+        }
+    });
+    benchmarkSink += checksum(out);
+
+    results.push_back({ "translate", d.name, curve, deadzone, 1, ns });
+}
+
+static void benchmarkTranslateBatch(const Distribution& d, const InputTranslator& translator,
+                                    const char* curve, int deadzone, size_t batch)
+{
+    std::vector<BigbenHIDReport> out(d.reports.size());
+
+    double ns = measure(d.reports.size(), [&] {
+        for (size_t i = 0; i < d.reports.size(); i += batch) {
+            size_t n = std::min(batch, d.reports.size() - i);
+            translator.translateBatch(&d.reports[i], &out[i], n);
+        }
+    });
+    benchmarkSink += checksum(out);
+
+    results.push_back({ "translateBatch", d.name, curve, deadzone, batch, ns });
+}
+
+static void benchmarkApplyDeadzone(const Distribution& d, int deadzone)
+{
+    double ns = measure(d.reports.size(), [&] {
+        uint32_t sum = 0;
+        for (const BigbenInputReport& r : d.reports) {
+            sum += InputTranslator::applyDeadzone(r.leftStickX, (uint8_t)deadzone);
+            sum += InputTranslator::applyDeadzone(r.leftStickY, (uint8_t)deadzone);
+            sum += InputTranslator::applyDeadzone(r.rightStickX, (uint8_t)deadzone);
+            sum += InputTranslator::applyDeadzone(r.rightStickY, (uint8_t)deadzone);
+        }
+        benchmarkSink += sum;
+    });
+
+    results.push_back({ "applyDeadzone", d.name, "linear", deadzone, 1, ns });
+}
+
+static void benchmarkTranslateButtons(const Distribution& d)
+{
+    double ns = measure(d.reports.size(), [&] {
+        uint32_t sum = 0;
+        for (const BigbenInputReport& r : d.reports) {
+            sum += InputTranslator::translateButtons(r.buttons);
+            sum += InputTranslator::translateDPadToHat(r.dpad);
+        }
+        benchmarkSink += sum;
+    });
+
+    results.push_back({ "translateButtons", d.name, "linear", 0, 1, ns });
+}
+
+static void runDistribution(const Distribution& d)
+{
+    for (uint8_t deadzone : kDeadzones) {
+        InputTranslator linear(deadzone);
+        benchmarkTranslate(d, linear, "linear", deadzone);
+        for (size_t batch : kBatchSizes) {
+            benchmarkTranslateBatch(d, linear, "linear", deadzone, batch);
+        }
+        benchmarkApplyDeadzone(d, deadzone);
+    }
+
+    // Curves change the table contents, not the lookup cost
+    InputTranslator curved(INPUT_TRANSLATOR_DEFAULT_DEADZONE);
+    curved.setStickResponseCurve(InputTranslator::makeCurve(INPUT_CURVE_S_CURVE, 70));
+    benchmarkTranslate(d, curved, "s-curve", INPUT_TRANSLATOR_DEFAULT_DEADZONE);
+    benchmarkTranslateBatch(d, curved, "s-curve", INPUT_TRANSLATOR_DEFAULT_DEADZONE, 16);
+
+    benchmarkTranslateButtons(d);
+}
+
+// =============================================================================
+// MARK: - Output
+// =============================================================================
+
+static void printJSON()
+{
+    printf("{\n");
+    printf("  \"suite\": \"InputTranslator\",\n");
+    printf("  \"reports\": %zu,\n", reportsPerDistribution);
+    printf("  \"repeats\": %d,\n", timedRepeats);
+    printf("  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        printf("    {\"benchmark\": \"%s\", \"distribution\": \"%s\", \"curve\": \"%s\", "
+               "\"deadzone\": %d, \"batch\": %zu, \"ns_per_report\": %.3f}%s\n",
+               r.benchmark.c_str(), r.distribution.c_str(), r.curve.c_str(),
+               r.deadzone, r.batch, r.nsPerReport, (i + 1 < results.size()) ? "," : "");
+    }
+    printf("  ]\n");
+    printf("}\n");
+}
+
+static void printSummary()
+{
+    fprintf(stderr, "%-18s %-12s %-8s %4s %5s %10s\n",
+            "benchmark", "distribution", "curve", "dz", "batch", "ns/report");
+    for (const Result& r : results) {
+        fprintf(stderr, "%-18s %-12s %-8s %4d %5zu %10.3f\n",
+                r.benchmark.c_str(), r.distribution.c_str(), r.curve.c_str(),
+                r.deadzone, r.batch, r.nsPerReport);
+    }
+}
+
+// =============================================================================
+// MARK: - Main
+// =============================================================================
+
+int main(int argc, char* argv[])
+{
+    std::vector<const char*> captures;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--reports") == 0 && i + 1 < argc) {
+            reportsPerDistribution = (size_t)std::max(64L, atol(argv[++i]));
+        } else if (strcmp(argv[i], "--repeats") == 0 && i + 1 < argc) {
+            timedRepeats = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            captures.push_back(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--reports N] [--repeats N] [--input capture.bin]...\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Distribution> distributions;
+    distributions.push_back(makeIdle(reportsPerDistribution));
+    distributions.push_back(makeGameplay(reportsPerDistribution));
+    distributions.push_back(makeUniform(reportsPerDistribution));
+
+    for (const char* path : captures) {
+        Distribution capture;
+        if (!loadCapture(path, &capture)) {
+            return 1;
+        }
+        distributions.push_back(capture);
+    }
+
+    for (const Distribution& d : distributions) {
+        runDistribution(d);
+    }
+
+    printSummary();
+    printJSON();
+    return 0;
+}
@@ -16,6 +16,9 @@
 
 // Include the classes under test
 #include "../../BigbenControllerDriver/Sources/InputTranslator.h"
+#include "../../Shared/StickShaping.h"
+#include "../../Shared/TraceRing.h"
+#include "../../Shared/ReportSnapshot.h"
 
 // =============================================================================
 // MARK: - Test Framework Macros
@@ -599,6 +602,492 @@ TEST_CASE(Translate_AllAxesMinimum)
     ASSERT_EQ(0, output.rightStickY);
 }
 
+// =============================================================================
+// MARK: - Batch Translation Tests
+// =============================================================================
+
+// Reports that sweep every axis value
+static const size_t kBatchSweepCount = 259;
+
+static void fillBatchSweep(BigbenInputReport* inputs, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        inputs[i] = createNeutralInput();
+        inputs[i].leftStickX = (uint8_t)i;
+        inputs[i].leftStickY = (uint8_t)(255 - i);
+        inputs[i].rightStickX = (uint8_t)(i * 7);
+        inputs[i].rightStickY = (uint8_t)(i * 13 + 5);
+        inputs[i].leftTrigger = (uint8_t)i;
+        inputs[i].rightTrigger = (uint8_t)(255 - i);
+        inputs[i].buttons = (uint16_t)(i * 257);
+        inputs[i].dpad = (uint8_t)(i % 10);
+    }
+}
+
+static bool batchMatchesScalar(const InputTranslator& translator)
+{
+    BigbenInputReport inputs[kBatchSweepCount];
+    BigbenHIDReport expected[kBatchSweepCount];
+    BigbenHIDReport actual[kBatchSweepCount];
+
+    fillBatchSweep(inputs, kBatchSweepCount);
+    memset(actual, 0xAA, sizeof(actual));
+
+    for (size_t i = 0; i < kBatchSweepCount; i++) {
+        translator.translate(&inputs[i], &expected[i]);
+    }
+    if (!translator.translateBatch(inputs, actual, kBatchSweepCount)) {
+        return false;
+    }
+
+    return memcmp(expected, actual, sizeof(expected)) == 0;
+}
+
+TEST_CASE(TranslateBatch_NullPointers_ReturnFalse)
+{
+    InputTranslator translator;
+    BigbenInputReport input = createNeutralInput();
+    BigbenHIDReport output;
+
+    ASSERT_FALSE(translator.translateBatch(nullptr, &output, 1));
+    ASSERT_FALSE(translator.translateBatch(&input, nullptr, 1));
+    ASSERT_TRUE(translator.translateBatch(nullptr, nullptr, 0));
+}
+
+TEST_CASE(TranslateBatch_DefaultDeadzones_MatchScalar)
+{
+    InputTranslator translator;
+    ASSERT_TRUE(batchMatchesScalar(translator));
+}
+
+TEST_CASE(TranslateBatch_AllStickDeadzones_MatchScalar)
+{
+    InputTranslator translator;
+    for (int deadzone = 0; deadzone <= 127; deadzone++) {
+        translator.setDeadzone((uint8_t)deadzone);
+        ASSERT_TRUE(batchMatchesScalar(translator));
+    }
+}
+
+TEST_CASE(TranslateBatch_AllTriggerDeadzones_MatchScalar)
+{
+    InputTranslator translator;
+    for (int deadzone = 0; deadzone <= 255; deadzone++) {
+        translator.setTriggerDeadzone((uint8_t)deadzone);
+        ASSERT_TRUE(batchMatchesScalar(translator));
+    }
+}
+
+TEST_CASE(TranslateBatch_ShortBatches_MatchScalar)
+{
+    InputTranslator translator(20);
+    translator.setTriggerDeadzone(30);
+
+    BigbenInputReport inputs[7];
+    fillBatchSweep(inputs, 7);
+    for (size_t i = 0; i < 7; i++) {
+        inputs[i].leftStickX = (uint8_t)(i * 40);
+        inputs[i].rightTrigger = (uint8_t)(i * 40);
+    }
+
+    for (size_t count = 1; count <= 7; count++) {
+        BigbenHIDReport expected[7];
+        BigbenHIDReport actual[7];
+        for (size_t i = 0; i < count; i++) {
+            translator.translate(&inputs[i], &expected[i]);
+        }
+        ASSERT_TRUE(translator.translateBatch(inputs, actual, count));
+        ASSERT_EQ(0, memcmp(expected, actual, count * sizeof(BigbenHIDReport)));
+    }
+}
+
+// =============================================================================
+// MARK: - Response Curve Tests
+// =============================================================================
+
+TEST_CASE(LookupTables_LinearMatchesStaticDeadzone)
+{
+    InputTranslator translator(20);
+    translator.setTriggerDeadzone(40);
+
+    for (int value = 0; value < 256; value++) {
+        ASSERT_EQ(InputTranslator::applyDeadzone((uint8_t)value, 20),
+                  translator.axisLookup(INPUT_AXIS_LEFT_X, (uint8_t)value));
+        ASSERT_EQ(InputTranslator::applyDeadzone((uint8_t)value, 20),
+                  translator.axisLookup(INPUT_AXIS_RIGHT_Y, (uint8_t)value));
+        ASSERT_EQ(InputTranslator::applyTriggerDeadzone((uint8_t)value, 40),
+                  translator.axisLookup(INPUT_AXIS_RIGHT_TRIGGER, (uint8_t)value));
+    }
+}
+
+TEST_CASE(ResponseCurve_DefaultIsLinear)
+{
+    InputTranslator translator;
+    for (int axis = 0; axis < INPUT_AXIS_COUNT; axis++) {
+        ASSERT_EQ(INPUT_CURVE_LINEAR, translator.getResponseCurve((InputAxis)axis).type);
+    }
+}
+
+TEST_CASE(ResponseCurve_ExponentialSoftensMidRange)
+{
+    InputTranslator translator(0);
+    ASSERT_TRUE(translator.setStickResponseCurve(InputTranslator::makeCurve(INPUT_CURVE_EXPONENTIAL, 100)));
+
+    // Half deflection comes out well below half, extremes and center are kept
+    ASSERT_TRUE(translator.axisLookup(INPUT_AXIS_LEFT_X, 192) < 150);
+    ASSERT_TRUE(translator.axisLookup(INPUT_AXIS_LEFT_X, 64) > 106);
+    ASSERT_EQ(128, translator.axisLookup(INPUT_AXIS_LEFT_X, 128));
+    ASSERT_EQ(255, translator.axisLookup(INPUT_AXIS_LEFT_X, 255));
+    ASSERT_EQ(0, translator.axisLookup(INPUT_AXIS_LEFT_X, 0));
+
+    // Triggers are untouched by a stick curve
+    ASSERT_EQ(128, translator.axisLookup(INPUT_AXIS_LEFT_TRIGGER, 128));
+}
+
+TEST_CASE(ResponseCurve_SCurveIsMonotonic)
+{
+    InputTranslator translator(10);
+    ASSERT_TRUE(translator.setStickResponseCurve(InputTranslator::makeCurve(INPUT_CURVE_S_CURVE, 80)));
+    ASSERT_TRUE(translator.setTriggerResponseCurve(InputTranslator::makeCurve(INPUT_CURVE_S_CURVE, 80)));
+
+    for (int value = 1; value < 256; value++) {
+        ASSERT_TRUE(translator.axisLookup(INPUT_AXIS_RIGHT_X, (uint8_t)value) >=
+                    translator.axisLookup(INPUT_AXIS_RIGHT_X, (uint8_t)(value - 1)));
+        ASSERT_TRUE(translator.axisLookup(INPUT_AXIS_LEFT_TRIGGER, (uint8_t)value) >=
+                    translator.axisLookup(INPUT_AXIS_LEFT_TRIGGER, (uint8_t)(value - 1)));
+    }
+    ASSERT_EQ(255, translator.axisLookup(INPUT_AXIS_LEFT_TRIGGER, 255));
+}
+
+TEST_CASE(ResponseCurve_PiecewisePassesThroughPoints)
+{
+    InputTranslator translator;
+    translator.setTriggerDeadzone(0);
+
+    const InputCurvePoint points[] = { { 64, 16 }, { 192, 240 } };
+    ASSERT_TRUE(translator.setResponseCurve(INPUT_AXIS_LEFT_TRIGGER,
+                                            InputTranslator::makePiecewiseCurve(points, 2)));
+
+    ASSERT_EQ(16, translator.axisLookup(INPUT_AXIS_LEFT_TRIGGER, 64));
+    ASSERT_EQ(240, translator.axisLookup(INPUT_AXIS_LEFT_TRIGGER, 192));
+    ASSERT_EQ(128, translator.axisLookup(INPUT_AXIS_LEFT_TRIGGER, 128));
+    ASSERT_EQ(8, translator.axisLookup(INPUT_AXIS_LEFT_TRIGGER, 32));
+    ASSERT_EQ(0, translator.axisLookup(INPUT_AXIS_LEFT_TRIGGER, 0));
+    ASSERT_EQ(255, translator.axisLookup(INPUT_AXIS_LEFT_TRIGGER, 255));
+
+    // Only the configured axis changes
+    ASSERT_EQ(64, translator.axisLookup(INPUT_AXIS_RIGHT_TRIGGER, 64));
+}
+
+TEST_CASE(ResponseCurve_InvalidCurvesAreRejected)
+{
+    InputTranslator translator;
+
+    const InputCurvePoint unordered[] = { { 100, 50 }, { 100, 60 } };
+    ASSERT_FALSE(translator.setResponseCurve(INPUT_AXIS_LEFT_X,
+                                             InputTranslator::makePiecewiseCurve(unordered, 2)));
+
+    InputResponseCurve tooStrong = InputTranslator::makeCurve(INPUT_CURVE_EXPONENTIAL, 0);
+    tooStrong.strength = 101;
+    ASSERT_FALSE(translator.setStickResponseCurve(tooStrong));
+
+    ASSERT_FALSE(translator.setResponseCurve(INPUT_AXIS_COUNT,
+                                             InputTranslator::makeCurve(INPUT_CURVE_LINEAR, 0)));
+    ASSERT_EQ(INPUT_CURVE_LINEAR, translator.getResponseCurve(INPUT_AXIS_LEFT_X).type);
+}
+
+TEST_CASE(ResponseCurve_SurvivesDeadzoneChange)
+{
+    InputTranslator translator(0);
+    ASSERT_TRUE(translator.setStickResponseCurve(InputTranslator::makeCurve(INPUT_CURVE_EXPONENTIAL, 100)));
+    uint8_t before = translator.axisLookup(INPUT_AXIS_LEFT_Y, 200);
+
+    translator.setDeadzone(30);
+    ASSERT_TRUE(translator.axisLookup(INPUT_AXIS_LEFT_Y, 200) < before);
+    ASSERT_EQ(128, translator.axisLookup(INPUT_AXIS_LEFT_Y, 150));
+}
+
+TEST_CASE(TranslateBatch_WithCurves_MatchScalar)
+{
+    InputTranslator translator(15);
+    translator.setTriggerDeadzone(20);
+    ASSERT_TRUE(translator.setStickResponseCurve(InputTranslator::makeCurve(INPUT_CURVE_S_CURVE, 60)));
+    ASSERT_TRUE(batchMatchesScalar(translator));
+}
+
+// =============================================================================
+// MARK: - Stick Shaping Tests
+// =============================================================================
+
+TEST_CASE(StickShape_InsideRadialDeadzone_IsCentered)
+{
+    BigbenStickShape shape;
+    BigbenStickShapeInit(&shape, 4915, BIGBEN_STICK_ONE,
+                         BIGBEN_DEADZONE_SCALED_RADIAL, BIGBEN_STICK_CURVE_LINEAR);
+
+    int32_t x = 1, y = 1;
+    BigbenStickApply(&shape, 3000, 3000, &x, &y);   // Radius ~4243
+    ASSERT_EQ(0, x);
+    ASSERT_EQ(0, y);
+
+    // The same axis values per axis would pass a cross-shaped deadzone
+    BigbenStickApply(&shape, 4000, 4000, &x, &y);   // Radius ~5657
+    ASSERT_TRUE(x > 0 && y > 0);
+}
+
+TEST_CASE(StickShape_ScaledRadial_ReachesFullScaleAndKeepsDirection)
+{
+    BigbenStickShape shape;
+    BigbenStickShapeInit(&shape, 4915, 31129,
+                         BIGBEN_DEADZONE_SCALED_RADIAL, BIGBEN_STICK_CURVE_LINEAR);
+
+    int32_t x = 0, y = 0;
+    BigbenStickApply(&shape, BIGBEN_STICK_ONE, 0, &x, &y);
+    ASSERT_EQ(BIGBEN_STICK_ONE, x);
+    ASSERT_EQ(0, y);
+
+    // Diagonals are clamped to the unit circle, not the square
+    BigbenStickApply(&shape, -BIGBEN_STICK_ONE - 1, -BIGBEN_STICK_ONE - 1, &x, &y);
+    ASSERT_EQ(x, y);
+    ASSERT_NEAR(-23170, x, 2);
+}
+
+TEST_CASE(StickShape_ScaledRadial_NoJumpAtInnerEdge)
+{
+    BigbenStickShape scaled, unscaled;
+    BigbenStickShapeInit(&scaled, 4915, BIGBEN_STICK_ONE,
+                         BIGBEN_DEADZONE_SCALED_RADIAL, BIGBEN_STICK_CURVE_LINEAR);
+    BigbenStickShapeInit(&unscaled, 4915, BIGBEN_STICK_ONE,
+                         BIGBEN_DEADZONE_RADIAL, BIGBEN_STICK_CURVE_LINEAR);
+
+    int32_t x = 0, y = 0;
+    BigbenStickApply(&scaled, 4920, 0, &x, &y);
+    ASSERT_TRUE(x > 0 && x < 16);
+
+    BigbenStickApply(&unscaled, 4920, 0, &x, &y);
+    ASSERT_NEAR(4920, x, 2);
+}
+
+TEST_CASE(StickShape_Multistage_IsMonotonicAtFullResolution)
+{
+    BigbenStickShape shape;
+    BigbenStickShapeInit(&shape, 4915, 31129,
+                         BIGBEN_DEADZONE_SCALED_RADIAL, BIGBEN_STICK_CURVE_MULTISTAGE);
+
+    int32_t previous = 0;
+    int32_t distinct = 0;
+    for (int32_t value = 0; value <= BIGBEN_STICK_ONE; value++) {
+        int32_t x = 0, y = 0;
+        BigbenStickApply(&shape, value, 0, &x, &y);
+        ASSERT_TRUE(x >= previous);
+        if (x != previous) {
+            distinct++;
+        }
+        previous = x;
+    }
+
+    // Far finer than the 128 steps an 8-bit axis would give
+    ASSERT_TRUE(distinct > 10000);
+    ASSERT_EQ(BIGBEN_STICK_ONE, previous);
+}
+
+TEST_CASE(StickShape_Apply8_MatchesAxisEndpoints)
+{
+    BigbenStickShape shape;
+    BigbenStickShapeInit8(&shape, INPUT_TRANSLATOR_DEFAULT_DEADZONE,
+                          BIGBEN_DEADZONE_SCALED_RADIAL, BIGBEN_STICK_CURVE_LINEAR);
+
+    uint8_t x = 128, y = 128;
+    BigbenStickApply8(&shape, &x, &y);
+    ASSERT_EQ(128, x);
+    ASSERT_EQ(128, y);
+
+    x = 255; y = 128;
+    BigbenStickApply8(&shape, &x, &y);
+    ASSERT_EQ(255, x);
+    ASSERT_EQ(128, y);
+
+    x = 128; y = 0;
+    BigbenStickApply8(&shape, &x, &y);
+    ASSERT_EQ(128, x);
+    ASSERT_EQ(0, y);
+
+    // Small diagonal drift inside the circle is removed on both axes
+    x = 128 + 8; y = 128 - 8;
+    BigbenStickApply8(&shape, &x, &y);
+    ASSERT_EQ(128, x);
+    ASSERT_EQ(128, y);
+}
+
+// =============================================================================
+// MARK: - Trace Ring Tests
+// =============================================================================
+
+TEST_CASE(TraceRing_DrainsInOrderAndAdvancesCursor)
+{
+    static BigbenTraceRing ring;
+    memset(&ring, 0, sizeof(ring));
+
+    BigbenTraceRecordEvent(&ring, BIGBEN_TRACE_INPUT_CHANGED, 100, 0x0102,
+                           0, BigbenTracePackAxes(1, 2, 3, 4, 5, 6, 8));
+    BigbenTraceRecordEvent(&ring, BIGBEN_TRACE_SHORT_READ, 200, 0, 7, 0);
+
+    BigbenTraceRecord out[4];
+    uint64_t cursor = 0, lost = 1;
+    ASSERT_EQ(2u, BigbenTraceDrain(&ring, &cursor, out, 4, &lost));
+    ASSERT_EQ(0u, lost);
+    ASSERT_EQ(2u, cursor);
+    ASSERT_EQ(BIGBEN_TRACE_INPUT_CHANGED, out[0].event);
+    ASSERT_EQ(0x0102, out[0].arg16);
+    ASSERT_EQ(4, BigbenTraceAxis(out[0].arg64, 3));
+    ASSERT_EQ(8, BigbenTraceAxis(out[0].arg64, 6));
+    ASSERT_EQ(BIGBEN_TRACE_SHORT_READ, out[1].event);
+    ASSERT_EQ(7u, out[1].arg32);
+
+    // Nothing new since the last drain
+    ASSERT_EQ(0u, BigbenTraceDrain(&ring, &cursor, out, 4, &lost));
+}
+
+TEST_CASE(TraceRing_OverwritesOldestAndCountsLost)
+{
+    static BigbenTraceRing ring;
+    memset(&ring, 0, sizeof(ring));
+
+    const uint32_t written = BIGBEN_TRACE_CAPACITY + 10;
+    for (uint32_t i = 0; i < written; i++) {
+        BigbenTraceRecordEvent(&ring, BIGBEN_TRACE_READ_ERROR, i, 0, i, 0);
+    }
+
+    static BigbenTraceRecord out[BIGBEN_TRACE_CAPACITY];
+    uint64_t cursor = 0, lost = 0;
+    uint32_t count = BigbenTraceDrain(&ring, &cursor, out, BIGBEN_TRACE_CAPACITY, &lost);
+
+    ASSERT_EQ((uint32_t)BIGBEN_TRACE_CAPACITY, count);
+    ASSERT_EQ(10u, lost);
+    ASSERT_EQ(10u, out[0].arg32);
+    ASSERT_EQ(written - 1, out[count - 1].arg32);
+    ASSERT_EQ((uint64_t)written, cursor);
+}
+
+// =============================================================================
+// MARK: - Report Snapshot Tests
+// =============================================================================
+
+TEST_CASE(ReportSnapshot_EmptyUntilPublished)
+{
+    BigbenReportSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+
+    BigbenHIDReport report;
+    ASSERT_EQ(0, BigbenSnapshotRead(&snapshot, &report, nullptr));
+}
+
+TEST_CASE(ReportSnapshot_ReadsLatestPublish)
+{
+    BigbenReportSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+
+    BigbenHIDReport first;
+    InputTranslator::initializeNeutralReport(&first);
+    BigbenHIDReport second = first;
+    second.buttons = 0x8001;
+    second.rightTrigger = 200;
+
+    BigbenSnapshotPublish(&snapshot, &first, 10);
+    BigbenSnapshotPublish(&snapshot, &second, 20);
+
+    BigbenHIDReport report;
+    uint64_t timestamp = 0;
+    ASSERT_EQ(1, BigbenSnapshotRead(&snapshot, &report, &timestamp));
+    ASSERT_EQ(0, memcmp(&second, &report, sizeof(BigbenHIDReport)));
+    ASSERT_EQ(20u, timestamp);
+    ASSERT_EQ(0u, snapshot.sequence & 1);
+}
+
+// =============================================================================
+// MARK: - Model Backend Tests
+// =============================================================================
+
+TEST_CASE(ModelBackend_UnknownProduct_HasNoBackend)
+{
+    ASSERT_TRUE(InputModelBackendForProduct(BIGBEN_PRODUCT_PC_COMPACT) != nullptr);
+    ASSERT_TRUE(InputModelBackendForProduct(BIGBEN_PRODUCT_PS4_COMPACT) != nullptr);
+    ASSERT_TRUE(InputModelBackendForProduct(BIGBEN_PRODUCT_PS3_MINIPAD) != nullptr);
+    ASSERT_TRUE(InputModelBackendForProduct(0x1234) == nullptr);
+}
+
+TEST_CASE(ModelBackend_VendorReport_IsReadInPlace)
+{
+    const InputModelBackend* backend = InputModelBackendForProduct(BIGBEN_PRODUCT_PS3_MINIPAD);
+    BigbenInputReport raw = createNeutralInput();
+    raw.buttons = BIGBEN_BTN_A | BIGBEN_BTN_HOME;
+
+    BigbenInputReport scratch;
+    const BigbenInputReport* parsed = backend->parse((const uint8_t*)&raw, sizeof(raw), &scratch);
+    ASSERT_TRUE(parsed == &raw);
+
+    raw.reportId = 0x02;
+    ASSERT_TRUE(backend->parse((const uint8_t*)&raw, sizeof(raw), &scratch) == nullptr);
+    ASSERT_TRUE(backend->parse((const uint8_t*)&raw, 20, &scratch) == nullptr);
+}
+
+TEST_CASE(ModelBackend_XInputReport_ConvertsToVendorLayout)
+{
+    const InputModelBackend* backend = InputModelBackendForProduct(BIGBEN_PRODUCT_PC_COMPACT);
+    ASSERT_EQ(14u, backend->minReportSize);
+
+    // A + LB + D-pad up/right, LT past the threshold, left stick full
+    // right and full up, right stick full down
+    uint8_t raw[20] = { 0x00, 0x14, 0x09, 0x11, 200, 10,
+                        0xFF, 0x7F, 0xFF, 0x7F, 0x00, 0x00, 0x00, 0x80 };
+    BigbenInputReport scratch;
+    const BigbenInputReport* parsed = backend->parse(raw, sizeof(raw), &scratch);
+    ASSERT_TRUE(parsed == &scratch);
+
+    ASSERT_EQ(BIGBEN_REPORT_ID_INPUT, parsed->reportId);
+    ASSERT_EQ(BIGBEN_BTN_A | BIGBEN_BTN_LB | BIGBEN_BTN_LT, parsed->buttons);
+    ASSERT_EQ(BIGBEN_DPAD_UP_RIGHT, parsed->dpad);
+    ASSERT_EQ(200, parsed->leftTrigger);
+    ASSERT_EQ(10, parsed->rightTrigger);
+    ASSERT_EQ(255, parsed->leftStickX);
+    ASSERT_EQ(0, parsed->leftStickY);
+    ASSERT_EQ(128, parsed->rightStickX);
+    ASSERT_EQ(255, parsed->rightStickY);
+
+    raw[0] = 0x01;      // LED status packet
+    ASSERT_TRUE(backend->parse(raw, sizeof(raw), &scratch) == nullptr);
+}
+
+TEST_CASE(ModelBackend_DualShockReport_ConvertsToVendorLayout)
+{
+    const InputModelBackend* backend = InputModelBackendForProduct(BIGBEN_PRODUCT_PS4_COMPACT);
+
+    // Hat down-left with triangle, L1 + Options, PS, sticks passed through
+    uint8_t raw[64] = { 0x01, 10, 20, 30, 40, 0x85, 0x21, 0x01, 50, 60 };
+    BigbenInputReport scratch;
+    const BigbenInputReport* parsed = backend->parse(raw, sizeof(raw), &scratch);
+    ASSERT_TRUE(parsed != nullptr);
+
+    ASSERT_EQ(BIGBEN_BTN_Y | BIGBEN_BTN_LB | BIGBEN_BTN_START | BIGBEN_BTN_HOME, parsed->buttons);
+    ASSERT_EQ(BIGBEN_DPAD_DOWN_LEFT, parsed->dpad);
+    ASSERT_EQ(10, parsed->leftStickX);
+    ASSERT_EQ(20, parsed->leftStickY);
+    ASSERT_EQ(30, parsed->rightStickX);
+    ASSERT_EQ(40, parsed->rightStickY);
+    ASSERT_EQ(50, parsed->leftTrigger);
+    ASSERT_EQ(60, parsed->rightTrigger);
+}
+
+TEST_CASE(ProtocolTraits_AxisWidening_NarrowsBackExactly)
+{
+    for (int value = 0; value < 256; value++) {
+        ASSERT_EQ(value, ProtocolNarrowAxis(ProtocolWidenAxis((uint8_t)value)));
+    }
+    for (uint8_t hat = 0; hat <= PROTOCOL_HAT_NEUTRAL; hat++) {
+        ASSERT_EQ(hat, kProtocolDPadBitsToHat[ProtocolHatToDPadBits(hat)]);
+    }
+}
+
 // =============================================================================
 // MARK: - Static Utility Tests
 // =============================================================================